@@ -45,9 +45,14 @@
  * @param   HslColor &B         The HSL color value
  */
 void RGBConverter::rgbToHsl(RgbColor const &A, HslColor &B) {
-    double rd = (double) A.r/255;
-    double gd = (double) A.g/255;
-    double bd = (double) A.b/255;
+    // x/255 == (x*257)/65535 so this is exact.
+    rgbToHsl(RgbColor16(A),B);
+}
+
+void RGBConverter::rgbToHsl(RgbColor16 const &A, HslColor &B) {
+    double rd = (double) A.r/65535;
+    double gd = (double) A.g/65535;
+    double bd = (double) A.b/65535;
     double max = threeway_max(rd, gd, bd);
     double min = threeway_min(rd, gd, bd);
     double h=0, s=0, l = (max + min) / 2;
@@ -100,6 +105,12 @@ double RGBConverter::hue2rgb(double p, double q, double t) {
  * @param   RgbColor &A   The RGB color return value
  */
 void RGBConverter::hslToRgb(HslColor const &A, RgbColor &B) {
+    RgbColor16 C;
+    hslToRgb(A,C);
+    C.get(B);
+}
+
+void RGBConverter::hslToRgb(HslColor const &A, RgbColor16 &B) {
     double r, g, b;
     double H = A.h;
 
@@ -113,9 +124,9 @@ void RGBConverter::hslToRgb(HslColor const &A, RgbColor &B) {
     b = hue2rgb(p, q, (H - 1.0 / 3.0));
   }
 
-  B.r = r * 255;
-  B.g = g * 255;
-  B.b = b * 255;
+  B.r = r * 65535;
+  B.g = g * 65535;
+  B.b = b * 65535;
 }
 #endif
 
@@ -90,6 +90,70 @@ public:
     uint8_t b;
 };
 
+// 16 bit per channel RGB color.  Used to carry the full precision of
+//  the HSL color conversion down to the PWM layer.
+class RgbColor16
+{
+public:
+    RgbColor16()
+    {
+        clear();
+    }
+
+    RgbColor16(uint16_t const &R, uint16_t const &G, uint16_t const &B)
+    : r(R)
+    , g(G)
+    , b(B)
+    { }
+
+    // Expand an 8 bit color to 16 bits (0xFF becomes 0xFFFF)
+    RgbColor16(RgbColor const &A)
+    : r(A.r * 257U)
+    , g(A.g * 257U)
+    , b(A.b * 257U)
+    { }
+
+    virtual ~RgbColor16() {}
+
+    void clear()
+    {
+        r=0;
+        g=0;
+        b=0;
+    }
+
+    void set(uint16_t const &R, uint16_t const &G, uint16_t const &B)
+    {
+        r=R;
+        g=G;
+        b=B;
+    }
+
+    // Truncate to an 8 bit color
+    void get(RgbColor &A) const
+    {
+        A.r = r >> 8;
+        A.g = g >> 8;
+        A.b = b >> 8;
+    }
+
+    RgbColor16& operator=(const RgbColor16 &rhs) {
+        // Check for self-assignment!
+        if (this == &rhs)      // Same object?
+            return *this;        // Yes, so skip assignment, and just return *this.
+
+        this->r = rhs.r;
+        this->g = rhs.g;
+        this->b = rhs.b;
+
+        return *this;
+    }
+
+    uint16_t r;
+    uint16_t g;
+    uint16_t b;
+};
+
 #if SUPPORT_HSV_COLOR
 class HsvColor
 {
@@ -216,6 +280,16 @@ public:
      * @param   RgbColor &B         The RGB color value
      */
     static void hslToRgb(HslColor const &A, RgbColor &B);
+
+    /**
+     * 16 bit versions of the above.  RgbColor16 (r, g, and b) are
+     * contained in the set [0, 65535].
+     *
+     * @param   RgbColor16 const &A The constant RGB color value
+     * @param   HslColor &B         The HSL color value
+     */
+    static void rgbToHsl(RgbColor16 const &A, HslColor &B);
+    static void hslToRgb(HslColor const &A, RgbColor16 &B);
 #endif
 
 #if SUPPORT_HSV_COLOR
@@ -30,9 +30,36 @@
      When         Who                Description of change
     -----------  ----------         ------------------------
     2014 Oct 05  James Stokebrand   Initial Creation
+    2026 Oct 18  James Stokebrand   Frames may be de-framed by the UART
+                                      RX ISR (UART_RX_DEFRAMER).
+    2026 Oct 18  James Stokebrand   Otherwise frames are decoded in place
+                                      in the UART RX ring.
+    2026 Oct 18  James Stokebrand   Optional CRC trailer (COMM_CLASS_CRC)
+                                      and rejected frame counters.
+    2026 Oct 18  James Stokebrand   Batch msgs carrying several events.
+    2026 Oct 18  James Stokebrand   Universe msgs carrying a color per node.
+    2026 Oct 18  James Stokebrand   XBee API mode transport (XBEE_API_MODE).
+    2026 Oct 18  James Stokebrand   Delta/run length coded stream msgs.
+    2026 Oct 18  James Stokebrand   Realtime msgs with a sequence number.
+    2026 Oct 18  James Stokebrand   Reliable transfers with NACK repair.
+    2026 Oct 18  James Stokebrand   COBS framing (COMM_CLASS_COBS).
+    2026 Oct 18  James Stokebrand   Radio baud rate set at boot (XBEE_BOOT_BAUD).
+    2026 Oct 18  James Stokebrand   Sync msgs for OSCCAL calibration.
+    2026 Oct 18  James Stokebrand   Frames are decoded in the main loop.
+    2026 Oct 18  James Stokebrand   STATS pages (realtime and TX counts).
+    2026 Oct 18  James Stokebrand   ATMY frame no longer cut short by an
+                                      earlier rejected frame.
+    2026 Oct 18  James Stokebrand   Events for one node go to its address.
+    2026 Oct 18  James Stokebrand   Identity (EEPROM) and STATUS/STATS
+                                      reports moved to their own classes.
+    2026 Oct 18  James Stokebrand   Frame end time passed on ahead of the
+                                      frame's events.
 
 *****************************************************/
 
+#include <util/atomic.h>
+#include <util/delay.h>
+
 #ifndef _COMM_CLASS_H_
 #include "comm_class.h"
 #endif
@@ -45,23 +72,184 @@
 //   Total: 3
 static const uint8_t MSG_LENGTH = 3;
 
+// A msg may be followed by a payload of up to one event pool block
+//  and then the CRC trailer.
+// BATCH_HEADER_LENGTH is the type and count bytes of a batch msg.
+static const uint8_t BATCH_HEADER_LENGTH = 2;
+
+static const uint8_t MIN_MSG_LENGTH = MSG_LENGTH + crc_class::LENGTH;
+static const uint8_t MAX_MSG_LENGTH = MSG_LENGTH + event_pool_class::BLOCK_SIZE + crc_class::LENGTH;
+
+// UNIVERSE_HEADER_LENGTH is the type, first address and count bytes
+//  of a universe msg.  Each slot is 3 bytes.
+static const uint8_t UNIVERSE_HEADER_LENGTH = 3;
+static const uint8_t UNIVERSE_SLOT_LENGTH = 3;
+static const uint8_t MAX_UNIVERSE_LENGTH = UNIVERSE_HEADER_LENGTH
+    + (UNIVERSE_SLOT_LENGTH * COMM_CLASS_UNIVERSE_SLOTS) + crc_class::LENGTH;
+
+// STREAM_HEADER_LENGTH is the type, first address and count bytes
+//  of a stream msg.  Stream msgs are never sent longer than the
+//  universe msg they replace.
+static const uint8_t STREAM_HEADER_LENGTH = 3;
+
+// REALTIME_HEADER_LENGTH is the type, sequence, first address and
+//  count bytes of a realtime msg.  Slots are the same as a universe msg.
+static const uint8_t REALTIME_HEADER_LENGTH = 4;
+static const uint8_t MAX_REALTIME_LENGTH = MAX_UNIVERSE_LENGTH + 1;
+
+// TRANSFER_HEADER_LENGTH is the type, ID, index and total bytes of a
+//  transfer msg.  NACK_LENGTH is the whole NACK msg.
+static const uint8_t TRANSFER_HEADER_LENGTH = 4;
+static const uint8_t NACK_LENGTH = comm_class::NACK_MSG_LENGTH;
+
+// DISCOVER_LENGTH, ANNOUNCE_LENGTH and ASSIGN_LENGTH are whole msgs.
+static const uint8_t UID_LENGTH = node_identity_class::UID_LENGTH;
+static const uint8_t DISCOVER_LENGTH = 3;
+static const uint8_t ANNOUNCE_LENGTH = 2 + UID_LENGTH;
+static const uint8_t ASSIGN_LENGTH = 2 + UID_LENGTH;
+
+// RELAY_HEADER_LENGTH is the type, source, sequence (2) and hops bytes
+//  in front of every msg (COMM_CLASS_RELAY).
+static const uint8_t RELAY_HEADER_LENGTH = COMM_CLASS_RELAY_HEADER;
+
+// Longest frame of any msg type
+static const uint8_t MAX_FRAME_LENGTH = RELAY_HEADER_LENGTH +
+    ((MAX_REALTIME_LENGTH > MAX_MSG_LENGTH) ? MAX_REALTIME_LENGTH : MAX_MSG_LENGTH);
+
+// Passed by reference, so they need a definition.
+const uint16_t comm_class::BROADCAST_ADDRESS;
+const uint16_t comm_class::CONTROLLER_ADDRESS;
+const uint8_t comm_class::FEEDBACK_MSG_LENGTH;
+const uint8_t comm_class::STATUS_MSG_LENGTH;
+const uint8_t comm_class::STATS_MSG_LENGTH;
+const uint8_t comm_class::NACK_MSG_LENGTH;
+#if COMM_CLASS_RELAY
+const uint8_t comm_class::RELAY_HOPS;
+#endif
+
+#if XBEE_API_MODE
+const uint8_t comm_class::XBEE_TX_REQUEST_16;
+const uint8_t comm_class::XBEE_AT_COMMAND;
+
+// API frame header lengths (frame type through options)
+static const uint8_t XBEE_TX16_HEADER_LENGTH = 5;
+static const uint8_t XBEE_RX16_HEADER_LENGTH = 5;
+static const uint8_t XBEE_RX64_HEADER_LENGTH = 11;
+
+#if (UART_RX_FRAME_SIZE < (11 + 4 + 3*COMM_CLASS_UNIVERSE_SLOTS + COMM_CLASS_CRC/8 + COMM_CLASS_RELAY_HEADER))
+    #error "UART_RX_FRAME_SIZE is too small for a comm class realtime msg in an RX packet"
+#endif
+#endif
+
+// The controller passes a status (or stats) on in one pool block
+#if (EVENT_POOL_BLOCK_SIZE < 16)
+    #error "EVENT_POOL_BLOCK_SIZE is too small for a comm class status or stats msg"
+#endif
+
+#if UART_RX_DEFRAMER && (UART_RX_FRAME_SIZE < (3 + EVENT_POOL_BLOCK_SIZE + COMM_CLASS_CRC/8 + COMM_CLASS_RELAY_HEADER))
+    #error "UART_RX_FRAME_SIZE is too small for the largest comm class msg"
+#endif
+
+#if UART_RX_DEFRAMER && (UART_RX_FRAME_SIZE < (4 + 3*COMM_CLASS_UNIVERSE_SLOTS + COMM_CLASS_CRC/8 + COMM_CLASS_RELAY_HEADER))
+    #error "UART_RX_FRAME_SIZE is too small for a comm class realtime msg"
+#endif
+
+// The in place decoder only sees a frame once its closing flag byte is
+//  in the RX ring, so the ring must hold a worst case (every byte
+//  stuffed) frame and its flag bytes.
+#if !UART_RX_DEFRAMER && ((UART_RX0_BUFFER_SIZE - 1) < (2 + 2*(4 + 3*COMM_CLASS_UNIVERSE_SLOTS + COMM_CLASS_CRC/8 + COMM_CLASS_RELAY_HEADER)))
+    #error "UART_RX0_BUFFER_SIZE is too small for a comm class realtime msg (UART_RX_DEFRAMER=0)"
+#endif
+
+#if !UART_RX_DEFRAMER && ((UART_RX0_BUFFER_SIZE - 1) < (2 + 2*(3 + EVENT_POOL_BLOCK_SIZE + COMM_CLASS_CRC/8 + COMM_CLASS_RELAY_HEADER)))
+    #error "UART_RX0_BUFFER_SIZE is too small for the largest comm class msg (UART_RX_DEFRAMER=0)"
+#endif
+
+// Worst case (every byte stuffed) realtime msg must fit in the TX ring,
+//  or begin_frame() would reject it every time.
+#if ((UART_TX0_BUFFER_SIZE - 1) < (2 + 2*(4 + 3*COMM_CLASS_UNIVERSE_SLOTS + COMM_CLASS_CRC/8 + COMM_CLASS_RELAY_HEADER) + 15*XBEE_API_MODE))
+    #error "UART_TX0_BUFFER_SIZE is too small for a comm class realtime msg"
+#endif
+
 void comm_class::Update(event_element_class const &A)
 {
-    // The point of this code is to have the UART Class "update" the
-    //  Comm Class of the tx/rx events:
+    // This is called from the UART RX/TX ISRs.  Only pass the
+    //  notifications into the event queue, the main loop decodes
+    //  with receive().
+#if UART_RX_DEFRAMER
+    // The UART Class de-frames and byte thins the msg in the RX ISR and
+    //  "updates" the Comm Class once per complete frame:
+    //      E_UART_RX_FRAME_EVENT
+    // The frame is held in the UART Class until receive() is done.
+    if (A.get_current_event() == E_UART_RX_FRAME_EVENT)
+    {
+        Notify(A);
+    }
+#else
+    // The UART Class "updates" the Comm Class when a flag byte is RXed:
     //      E_UART_FLAG_BYTE_FOUND_EVENT
-    //      E_UART_RX_EVENT
-    //      E_UART_TX_EVENT
-    // then decode() the msg and pass it into the event queue.
-    if ((A.get_current_event() == E_UART_FLAG_BYTE_FOUND_EVENT) ||
-        (A.get_current_event() == E_UART_RX_EVENT))
+    if (A.get_current_event() == E_UART_FLAG_BYTE_FOUND_EVENT)
+    {
+        Notify(A);
+    }
+#endif
+
+    // Asked for with notifyWhenTxDrained()
+    if (A.get_current_event() == E_UART_TX_COMPLETE)
+    {
+        Notify(A);
+    }
+}
+
+void comm_class::receive()
+{
+#if UART_RX_DEFRAMER
+    // Nothing held?  (A frame dropped by the RX ISR is notified too.)
+    if (_UartClass.getFrameLength() == 0) return;
+
+    notify_frame_end();
+
+#if XBEE_API_MODE
+    api_frame_to_msg(_UartClass.getFrame(), _UartClass.getFrameLength());
+#else
+    comm_class_span_struct msg;
+    msg._Base = _UartClass.getFrame();
+    msg._Start = 0;
+    msg._Mask = 0xFF;
+    msg._Length = _UartClass.getFrameLength();
+    frame_to_msg(msg, _UartClass.getFrameCrc());
+#endif
+
+    // Done with the frame ... the RX ISR may hand over the next one.
+    _UartClass.releaseFrame();
+
+    event_element_class temp;
+    if (decode(temp))
+    {
+        Notify(temp);
+    }
+#else
+    // decode() every complete msg in the RX ring and pass them
+    //  into the event queue.  They are timed from the newest frame.
+    notify_frame_end();
+
+    bool found = true;
+    while (found)
     {
         event_element_class temp;
-        if (decode(temp))
+        found = decode(temp);
+        if (found)
         {
             Notify(temp);
         }
     }
+#endif
+}
+
+void comm_class::notify_frame_end()
+{
+    event_element_class temp(E_UART_00, E_UART_RX_FRAME_END, _UartClass.getFrameEndMs() & 0xFF);
+    Notify(temp);
 }
 
 /*
@@ -70,190 +258,1686 @@ void comm_class::Update(event_element_class const &A)
         <MSG struct> (variable size)
         0x7E (END Byte)
 
+    MSG struct:
+        Hardware ID (1 byte)
+        Event ID    (1 byte)
+        Data        (1 byte)
+        Payload     (0 to event_pool_class::BLOCK_SIZE bytes)
+        CRC         (0, 1 or 2 bytes MSB first, see COMM_CLASS_CRC)
+
+    BATCH MSG struct:
+        E_COMM_CLASS_BATCH_MSG (1 byte)
+        Count       (1 byte, 1 to MAX_BATCH_EVENTS)
+        Count * (Hardware ID, Event ID, Data)
+        CRC         (0, 1 or 2 bytes MSB first, see COMM_CLASS_CRC)
+
+    UNIVERSE MSG struct:
+        E_COMM_CLASS_UNIVERSE_MSG (1 byte)
+        First address (1 byte)
+        Count       (1 byte, 1 to MAX_UNIVERSE_SLOTS)
+        Count * (Red, Green, Blue)
+        CRC         (0, 1 or 2 bytes MSB first, see COMM_CLASS_CRC)
+
     All bytes between START/STOP bytes will be byte stuffed.
         0x7D in the msg body will be stuffed with 0x7D 0x5D
         0x7E in the msg body will be stuffed with 0x7D 0x5E
 */
 
-void comm_class::encode(event_element_class const &A)
-{
-    // This "encode" method is used to send comm_class_event_msg_struct msgs.
-    _UartClass.putc(UartBaseClass::COMM_CLASS_FLAG_BYTE);
-    byte_stuff(A.get_current_hardware());
-    byte_stuff(A.get_current_event());
-    byte_stuff(A.get_current_data());
-    _UartClass.putc(UartBaseClass::COMM_CLASS_FLAG_BYTE);
-}
+#if XBEE_BOOT_BAUD
+// ATBD parameter for BAUD.  Standard rates have a code, anything else
+//  is sent as the rate itself.
+#if   (BAUD == 1200)
+    #define XBEE_BD_VALUE 0UL
+#elif (BAUD == 2400)
+    #define XBEE_BD_VALUE 1UL
+#elif (BAUD == 4800)
+    #define XBEE_BD_VALUE 2UL
+#elif (BAUD == 9600)
+    #define XBEE_BD_VALUE 3UL
+#elif (BAUD == 19200)
+    #define XBEE_BD_VALUE 4UL
+#elif (BAUD == 38400)
+    #define XBEE_BD_VALUE 5UL
+#elif (BAUD == 57600)
+    #define XBEE_BD_VALUE 6UL
+#elif (BAUD == 115200)
+    #define XBEE_BD_VALUE 7UL
+#else
+    #define XBEE_BD_VALUE BAUD
+#endif
 
-bool comm_class::decode(event_element_class &A)
+// Command mode guard time (ATGT, 1 second from the factory) plus a bit
+static const uint16_t XBEE_GUARD_TIME_MS = 1100;
+
+// Time for the radio to answer the AT commands
+static const uint16_t XBEE_COMMAND_TIME_MS = 100;
+
+void comm_class::radio_baud()
 {
-    static uint8_t position;
-    static uint8_t msg[MAX_SEARCH_BUFFER_SIZE];
+    _UartClass.setBaudRate(UART_BAUD_SELECT(XBEE_BOOT_BAUD,F_CPU));
 
-    // Are there char's to process?
-    while (!_UartClass.isEmpty())
-    { 
-        process(msg, position);
-    }
+    // Enter command mode
+    _delay_ms(XBEE_GUARD_TIME_MS);
+    _UartClass.putc_blocking('+');
+    _UartClass.putc_blocking('+');
+    _UartClass.putc_blocking('+');
+    _delay_ms(XBEE_GUARD_TIME_MS);
 
-    // Is this msg valid?
-    if (current_receive_msg._MsgValid)
+    // ATBD<hex>,WR,CN  The new rate is saved, so a radio that is already
+    //  at BAUD (MCU reset on its own) ignores all of this.
+    _UartClass.putc_blocking('A');
+    _UartClass.putc_blocking('T');
+    _UartClass.putc_blocking('B');
+    _UartClass.putc_blocking('D');
+    bool leading = true;
+    for (int8_t shift=28; shift>=0; shift-=4)
     {
-        // Pass the event back to the caller.
-        A.set(current_receive_msg._EventMsg._HardwareID
-             ,current_receive_msg._EventMsg._EventID
-             ,current_receive_msg._EventMsg._Uint8_Data);
-        current_receive_msg._MsgValid = false;
-        return true;
+        uint8_t nibble = (XBEE_BD_VALUE >> shift) & 0x0F;
+        if ((nibble != 0) || (shift == 0)) leading = false;
+        if (!leading) _UartClass.putc_blocking((nibble < 10) ? ('0' + nibble) : ('A' + nibble - 10));
     }
-    // Nothing yet ... 
-    return false;
+    _UartClass.putc_blocking(',');
+    _UartClass.putc_blocking('W');
+    _UartClass.putc_blocking('R');
+    _UartClass.putc_blocking(',');
+    _UartClass.putc_blocking('C');
+    _UartClass.putc_blocking('N');
+    _UartClass.putc_blocking('\r');
+    _delay_ms(XBEE_COMMAND_TIME_MS);
+
+    _UartClass.setBaudRate(UART_BAUD_VALUE);
 }
+#endif
 
-bool comm_class::confirm_length(uint8_t *, uint8_t const &len)
+void comm_class::setNodeAddress(uint8_t const &A)
 {
-    if (len == MSG_LENGTH) return true;
-    return false;
+    _NodeAddress = A;
+
+#if UART_MPCM
+    // Wake up for frames addressed to this node
+    _UartClass.setMpcmAddress(A);
+#endif
+
+#if XBEE_API_MODE
+    // Set the radio's 16 bit source address (ATMY) so the radio only
+    //  passes on msgs for this node (and broadcasts).
+    uint16_t my = radio_address(A);
+
+    // byte_stuff() checks _TxRejected, a frame rejected before this
+    //  one must not leave it set.
+    _TxRejected = !reserve_frame(1 + 2*(2 + 6 + 1));
+    if (_TxRejected) return;
+
+    _UartClass.putc(UartBaseClass::COMM_CLASS_FLAG_BYTE);
+    byte_stuff(0);
+    byte_stuff(6);
+    _TxChecksum = 0;
+    byte_stuff(XBEE_AT_COMMAND);
+    byte_stuff(next_frame_id());
+    byte_stuff('M');
+    byte_stuff('Y');
+    byte_stuff(my >> 8);
+    byte_stuff(my & 0xFF);
+    byte_stuff(0xFF - _TxChecksum);
+#endif
 }
 
+uint16_t comm_class::frame_chars(uint8_t const &length)
+{
+#if COMM_CLASS_COBS
+    // One overhead byte per 254 and the delimiters
+    uint16_t body = RELAY_HEADER_LENGTH + length + crc_class::LENGTH;
+    uint16_t worst = 2 + body + (body / 254) + 1;
+#elif XBEE_API_MODE
+    // Worst case every byte after the start delimiter is escaped.
+    uint16_t worst = 1 + 2*(2 + XBEE_TX16_HEADER_LENGTH + RELAY_HEADER_LENGTH + length + crc_class::LENGTH + 1);
+#else
+    // Worst case every byte between the flags is stuffed.
+    uint16_t worst = 1 + 2*(RELAY_HEADER_LENGTH + length + crc_class::LENGTH) + 1;
+#endif
+#if UART_MPCM
+    worst += 1;
+#endif
+    return worst;
+}
 
-void comm_class::byte_stuff(uint8_t const &A)
+uint32_t comm_class::frame_airtime_us(uint8_t const &length)
 {
-    if ((A == UartBaseClass::COMM_CLASS_FLAG_BYTE) ||
-        (A == UartBaseClass::COMM_CLASS_ESCAPE_CHAR_START))
+    // Start, 8 data (plus the 9th bit with UART_MPCM) and stop bits
+    return ((uint32_t)frame_chars(length) * (10 + UART_MPCM) * 1000000UL + BAUD - 1) / BAUD;
+}
+
+uint16_t comm_class::reply_slot_ms(uint8_t const &address, uint8_t const &length)
+{
+    // Node n-1 starts somewhere in start*(1 +/- error) and sends for
+    //  up to width.  Node n, on a clock that may be error fast, must
+    //  not start before that.  Nodes time whole ms, so every start is
+    //  rounded up before the next is worked out from it.
+    static const uint16_t E = COMM_CLASS_CLOCK_ERROR;
+    uint32_t width = frame_airtime_us(length) + COMM_CLASS_SLOT_GUARD_US;
+    uint32_t start = 0;
+
+    for (uint8_t nn=0; nn<address; nn++)
     {
-        // This value needs to be byte stuffed
-        _UartClass.putc(UartBaseClass::COMM_CLASS_ESCAPE_CHAR_START);
-        _UartClass.putc(A ^ UartBaseClass::COMM_CLASS_BYTE_STUFF_XOR_VALUE);
-    } else {
-        // No byte stuffing needed ... 
-        _UartClass.putc(A);
+        start += (start * 2 * E + width * 1000 + (1000 - E - 1)) / (1000 - E);
+        start = (start + 999) / 1000 * 1000;
+        if (start >= 0xFFFFUL * 1000) return 0xFFFF;
     }
+    return start / 1000;
 }
 
+bool comm_class::reserve_frame(uint16_t const &count)
+{
+    if ((count <= 0xFF) && _UartClass.reserve(count)) return true;
+
+    count_error(_TxRejectCount);
+    return false;
+}
 
-void comm_class::STATE_decode__search_for_flag_byte(uint8_t *, uint8_t &pos)
+void comm_class::begin_frame(uint8_t const &length, uint16_t const &dest)
 {
-    // Set position to Zero ... ignore previous collected data.
-    pos = 0;
+#if COMM_CLASS_COBS
+    (void)length;
+    _TxRejected = false;
+    _TxFrameLen = 0;
+#if UART_MPCM
+    _TxMpcmAddress = mpcm_address(dest);
+#endif
+#else
+    _TxRejected = !reserve_frame(frame_chars(length));
+    if (_TxRejected) return;
+
+#if UART_MPCM
+    _UartClass.putc_address(mpcm_address(dest));
+#endif
+    _UartClass.putc(UartBaseClass::COMM_CLASS_FLAG_BYTE);
+#endif
+
+#if XBEE_API_MODE
+    // TX Request (16 bit address) header.  The checksum covers the
+    //  frame data only, the CRC covers the msg only.
+    byte_stuff(0);
+    byte_stuff(XBEE_TX16_HEADER_LENGTH + RELAY_HEADER_LENGTH + length + crc_class::LENGTH);
+    _TxChecksum = 0;
+    byte_stuff(XBEE_TX_REQUEST_16);
+    byte_stuff(next_frame_id());
+    byte_stuff(dest >> 8);
+    byte_stuff(dest & 0xFF);
+    byte_stuff(0);  // Options ... radio ACKs unicast msgs
+#else
+    (void)dest;
+#endif
 
-    uint8_t error;
-    uint8_t data;
-    if (_UartClass.getc(error, data))
+    _TxCrc = crc_class::INIT;
+
+#if COMM_CLASS_RELAY
+    byte_stuff(E_COMM_CLASS_RELAY_MSG);
+    if (_TxRelayForward)
+    {
+        // Repeating the held msg
+        byte_stuff(_RelaySource);
+        byte_stuff(_RelaySeq >> 8);
+        byte_stuff(_RelaySeq & 0xFF);
+        byte_stuff(_RelayHops);
+    }
+    else
     {
-        if (data == UartBaseClass::COMM_CLASS_FLAG_BYTE)
+        // This node's own msg.  Remember it so relayed copies coming
+        //  back are dropped.
+        if (!_TxRelaySeqStarted)
         {
-            TRAN((STATE)&comm_class::STATE_decode__flag_byte_found);
-            return;
+            _TxRelaySeq = _Identity.random16();
+            _TxRelaySeqStarted = true;
         }
+        uint16_t seq = _TxRelaySeq++;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            relay_seen(_NodeAddress, seq);
+        }
+        byte_stuff(_NodeAddress);
+        byte_stuff(seq >> 8);
+        byte_stuff(seq & 0xFF);
+        byte_stuff(RELAY_HOPS);
     }
-    // No data available.
+#endif
 }
 
-void comm_class::STATE_decode__flag_byte_found(uint8_t *msg, uint8_t &pos)
+void comm_class::encode(event_element_class const &A, uint16_t const &dest)
 {
-    uint8_t error;
-    uint8_t data;
-    if (_UartClass.getc(error, data))
+    // This "encode" method is used to send comm_class_event_msg_struct msgs.
+    begin_frame(MSG_LENGTH + A.get_payload_length(),
+                (dest == BROADCAST_ADDRESS) ? event_address(A) : dest);
+    byte_stuff(A.get_current_hardware());
+    byte_stuff(A.get_current_event());
+    byte_stuff(A.get_current_data());
+
+    // Followed by the payload (if any)
+    uint8_t const *payload = A.get_payload();
+    for (uint8_t jj=0; jj<A.get_payload_length(); jj++)
     {
-        if (data == UartBaseClass::COMM_CLASS_FLAG_BYTE) 
-        { 
-            //  Consume all extra COMM_CLASS_FLAG_BYTE
-            return;
+        byte_stuff(payload[jj]);
+    }
+
+    end_frame();
+}
+
+void comm_class::encode(event_element_class const *A, uint8_t const &count)
+{
+    uint8_t jj = 0;
+    while (jj < count)
+    {
+        // How many events (without a payload) go in this batch?
+        uint8_t batch = 0;
+        while ((jj + batch < count) &&
+               (batch < MAX_BATCH_EVENTS) &&
+               (!A[jj + batch].has_payload()))
+        {
+            batch++;
         }
-        else if (data == UartBaseClass::COMM_CLASS_ESCAPE_CHAR_START)
+
+        if (batch <= 1)
         {
-            // Escape char found ... next byte should be byte thinned.
-            TRAN((STATE)&comm_class::STATE_decode__byte_thin);
-            return;
+            // Payload or a lone event ... a plain event msg will do.
+            encode(A[jj]);
+            jj++;
         }
-#if 1
-        else if (pos >= MAX_SEARCH_BUFFER_SIZE-1)
+        else
         {
-            // msg buffer is out of space ... still haven't found 
-            // the next FLAG Byte
-            // Transition back to searching for a flag byte
-            TRAN((STATE)&comm_class::STATE_decode__search_for_flag_byte);
+            // Every event for the same node?  Then only it is woken.
+            uint16_t dest = event_address(A[jj]);
+            for (uint8_t kk=1; kk<batch; kk++)
+            {
+                if (event_address(A[jj + kk]) != dest) dest = BROADCAST_ADDRESS;
+            }
+
+            begin_frame(BATCH_HEADER_LENGTH + (batch * MSG_LENGTH), dest);
+            byte_stuff(E_COMM_CLASS_BATCH_MSG);
+            byte_stuff(batch);
+            for (uint8_t kk=0; kk<batch; kk++)
+            {
+                byte_stuff(A[jj].get_current_hardware());
+                byte_stuff(A[jj].get_current_event());
+                byte_stuff(A[jj].get_current_data());
+                jj++;
+            }
+            end_frame();
         }
-#endif
+    }
+}
 
-        // This is the start of the msg ... store it.
-        msg[pos++] = data;
+void comm_class::encode_universe(uint8_t const &first_address, uint8_t const *rgb, uint8_t const &count)
+{
+    if ((count == 0) || (count > MAX_UNIVERSE_SLOTS)) return;
 
-        // No more flag bytes expected, transition to collect the rest of the msg
-        TRAN((STATE)&comm_class::STATE_decode__collect_msg);
+    begin_frame(UNIVERSE_HEADER_LENGTH + (count * UNIVERSE_SLOT_LENGTH), BROADCAST_ADDRESS);
+    byte_stuff(E_COMM_CLASS_UNIVERSE_MSG);
+    byte_stuff(first_address);
+    byte_stuff(count);
+    for (uint8_t jj=0; jj<(count * UNIVERSE_SLOT_LENGTH); jj++)
+    {
+        byte_stuff(rgb[jj]);
     }
-    // No bytes available.
+    end_frame();
 }
 
-void comm_class::STATE_decode__collect_msg(uint8_t *msg, uint8_t &pos)
+void comm_class::encode_realtime(uint8_t const &first_address, uint8_t const *rgb, uint8_t const &count)
 {
-    uint8_t error;
-    uint8_t data;
-    if (_UartClass.getc(error, data))
+    if ((count == 0) || (count > MAX_UNIVERSE_SLOTS)) return;
+
+    _TxRealtimeSeq++;
+
+    begin_frame(REALTIME_HEADER_LENGTH + (count * UNIVERSE_SLOT_LENGTH), BROADCAST_ADDRESS);
+    byte_stuff(E_COMM_CLASS_REALTIME_MSG);
+    byte_stuff(_TxRealtimeSeq);
+    byte_stuff(first_address);
+    byte_stuff(count);
+    for (uint8_t jj=0; jj<(count * UNIVERSE_SLOT_LENGTH); jj++)
     {
-        if (data == UartBaseClass::COMM_CLASS_FLAG_BYTE)
-        {
-            // Found FLAG byte ... End of message.
-            // Check length
-            if (confirm_length(msg,pos))
-            {
-                current_receive_msg._EventMsg._HardwareID = (E_InputHardware) msg[0*sizeof(uint8_t)];
-                current_receive_msg._EventMsg._EventID    = (E_InputEvent) msg[1*sizeof(uint8_t)];
-                current_receive_msg._EventMsg._Uint8_Data = msg[2*sizeof(uint8_t)];
-                current_receive_msg._MsgValid = true;
-            }
-#if 0
-            // Is this a valid msg?
-            if ((current_receive_msg._EventMsg._HardwareID >= E_InputHardware::E_LAST_HARDWARE_EVENT) ||
-                (current_receive_msg._EventMsg._EventID >= E_InputEvent::E_LAST_INPUT_EVENT))
-            {
-                // Hardware and Input event is out of bounds.  This is bad.  This msg is not valid.
-                current_receive_msg._MsgValid = false;
-            }
-#endif
+        byte_stuff(rgb[jj]);
+    }
+    end_frame();
+}
 
-            // Transition back to searching for a flag byte
-            TRAN((STATE)&comm_class::STATE_decode__search_for_flag_byte);
-            return;
-        }
-        else if (data == UartBaseClass::COMM_CLASS_ESCAPE_CHAR_START)
-        {
-            // Escape char found ... next byte should be byte thinned.
-            TRAN((STATE)&comm_class::STATE_decode__byte_thin);            
-            return;
-        }
-#if 1
-        else if (pos >= MAX_SEARCH_BUFFER_SIZE-1)
-        {
-            // msg buffer is out of space ... still haven't found 
-            // the complete msg
+void comm_class::encode_segment(uint8_t const &id, uint8_t const &index, uint8_t const &total,
+                                uint8_t const *data, uint8_t const &length)
+{
+    if ((length == 0) || (length > event_pool_class::BLOCK_SIZE)) return;
 
-            // Transition back to searching for a flag byte
-            TRAN((STATE)&comm_class::STATE_decode__search_for_flag_byte);
-        }
+    begin_frame(TRANSFER_HEADER_LENGTH + length, BROADCAST_ADDRESS);
+    byte_stuff(E_COMM_CLASS_TRANSFER_MSG);
+    byte_stuff(id);
+    byte_stuff(index);
+    byte_stuff(total);
+    for (uint8_t jj=0; jj<length; jj++)
+    {
+        byte_stuff(data[jj]);
+    }
+    end_frame();
+}
+
+void comm_class::encode_sync(uint8_t const &length)
+{
+    if ((length == 0) || (length > event_pool_class::BLOCK_SIZE)) return;
+
+    // 0x55 needs no byte stuffing and has an edge every bit.
+    begin_frame(1 + length, BROADCAST_ADDRESS);
+    byte_stuff(E_COMM_CLASS_SYNC_MSG);
+    for (uint8_t jj=0; jj<length; jj++)
+    {
+        byte_stuff(0x55);
+    }
+    end_frame();
+}
+
+void comm_class::encode_nack_poll(uint8_t const &id)
+{
+    begin_frame(NACK_LENGTH, BROADCAST_ADDRESS);
+    byte_stuff(E_COMM_CLASS_NACK_MSG);
+    byte_stuff(id);
+    byte_stuff(0);
+    byte_stuff(0);
+    byte_stuff(0);
+    end_frame();
+}
+
+void comm_class::encode_discover(uint8_t const &slots, bool const &all)
+{
+    begin_frame(DISCOVER_LENGTH, BROADCAST_ADDRESS);
+    byte_stuff(E_COMM_CLASS_DISCOVER_MSG);
+    byte_stuff(slots);
+    byte_stuff(all ? DISCOVER_ALL : 0);
+    end_frame();
+}
+
+void comm_class::encode_announce()
+{
+    _Identity.makeUid();
+
+    begin_frame(ANNOUNCE_LENGTH, CONTROLLER_ADDRESS);
+    byte_stuff(E_COMM_CLASS_ANNOUNCE_MSG);
+    for (uint8_t jj=0; jj<UID_LENGTH; jj++)
+    {
+        byte_stuff(_Identity.getUid()[jj]);
+    }
+    byte_stuff(_NodeAddress);
+    end_frame();
+}
+
+void comm_class::encode_assign(uint8_t const *uid, uint8_t const &address)
+{
+    begin_frame(ASSIGN_LENGTH, BROADCAST_ADDRESS);
+    byte_stuff(E_COMM_CLASS_ASSIGN_MSG);
+    for (uint8_t jj=0; jj<UID_LENGTH; jj++)
+    {
+        byte_stuff(uid[jj]);
+    }
+    byte_stuff(address);
+    end_frame();
+}
+
+void comm_class::encode_status(uint8_t const *report)
+{
+    encode_report(E_COMM_CLASS_STATUS_MSG, report, node_report_class::STATUS_PAYLOAD_LENGTH);
+}
+
+void comm_class::encode_stats(uint8_t const *report)
+{
+    encode_report(E_COMM_CLASS_STATS_MSG, report, node_report_class::STATS_PAYLOAD_LENGTH);
+}
+
+void comm_class::encode_report(uint8_t const &type, uint8_t const *report, uint8_t const &length)
+{
+    begin_frame(2 + length, CONTROLLER_ADDRESS);
+    byte_stuff(type);
+    byte_stuff(_NodeAddress);
+    for (uint8_t jj=0; jj<length; jj++)
+    {
+        byte_stuff(report[jj]);
+    }
+    end_frame();
+}
+
+uint16_t comm_class::getEscapeErrorCount()
+{
+#if UART_RX_DEFRAMER
+    return _UartClass.getRxEscapeErrorCount();
+#else
+    return _RxEscapeErrorCount;
+#endif
+}
+
+uint16_t comm_class::getResyncCount()
+{
+#if UART_RX_DEFRAMER
+    return _UartClass.getRxResyncCount();
+#else
+    return _RxResyncCount;
 #endif
+}
 
-        // No flag byte found, slurp up more of the msg.
-        msg[pos++] = data;
+uint8_t comm_class::getErrorRate()
+{
+    uint8_t rate;
+
+    // Fold in the frames rejected since the last good one.  With
+    //  UART_RX_DEFRAMER frames are sampled in the RX ISR.
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        error_rate_sample(false);
+        rate = _RxErrorRate >> 8;
     }
-    // No bytes available.
+    return rate;
+}
+
+uint16_t comm_class::rx_error_total()
+{
+    // Resyncs are left out, they are bytes (not frames) and follow
+    //  one of the other errors.
+    return getFramingErrorCount() + getOverrunCount() + getOverflowCount()
+         + getEscapeErrorCount() + _RxLengthErrorCount + _RxCrcErrorCount
+         + _RxInvalidCount;
 }
 
-void comm_class::STATE_decode__byte_thin(uint8_t *msg, uint8_t &pos)
+void comm_class::error_rate_sample(bool const &good)
 {
-    uint8_t error;
-    uint8_t data;
-    if (_UartClass.getc(error, data))
+    // Each rejected frame moves the rate 1/16 of the way to 0xFFFF.
+    //  16 in a row is close enough to all bad.
+    uint16_t total = rx_error_total();
+    uint16_t bad = total - _RxErrorTotal;
+    _RxErrorTotal = total;
+    if (bad > 16) bad = 16;
+
+    while (bad--)
     {
-        // byte thin this byte by XOR and store it in the raw msg buffer
-        msg[pos++] = data ^ UartBaseClass::COMM_CLASS_BYTE_STUFF_XOR_VALUE;
+        _RxErrorRate += (0xFFFF - _RxErrorRate) >> 4;
+    }
 
-        // Transition back to collecting msg
-        TRAN((STATE)&comm_class::STATE_decode__collect_msg);
-        return;
+    // and each good frame 1/16 of the way to ZERO.
+    if (good) _RxErrorRate -= _RxErrorRate >> 4;
+}
+
+void comm_class::encode_nack()
+{
+    // Missing segments of the current transfer.  Nothing received yet
+    //  means the whole transfer is missing, the controller knows how
+    //  many segments it has.
+    uint16_t missing = 0xFFFF;
+    if (_TransferTotal != 0)
+    {
+        missing = (uint16_t)((1UL << _TransferTotal) - 1) & ~_TransferMap;
+    }
+
+    begin_frame(NACK_LENGTH, CONTROLLER_ADDRESS);
+    byte_stuff(E_COMM_CLASS_NACK_MSG);
+    byte_stuff(_TransferId);
+    byte_stuff(_NodeAddress);
+    byte_stuff(missing >> 8);
+    byte_stuff(missing & 0xFF);
+    end_frame();
+}
+
+// Slot jj of a is the same color as slot kk of b
+static bool same_slot(uint8_t const *a, uint8_t const &jj, uint8_t const *b, uint8_t const &kk)
+{
+    for (uint8_t ii=0; ii<UNIVERSE_SLOT_LENGTH; ii++)
+    {
+        if (a[(jj * UNIVERSE_SLOT_LENGTH) + ii] != b[(kk * UNIVERSE_SLOT_LENGTH) + ii]) return false;
+    }
+    return true;
+}
+
+// Slot jj changed (from last to rgb) by the same amount as slot kk
+static bool same_delta(uint8_t const *rgb, uint8_t const *last, uint8_t const &jj, uint8_t const &kk)
+{
+    for (uint8_t ii=0; ii<UNIVERSE_SLOT_LENGTH; ii++)
+    {
+        uint8_t a = rgb[(jj * UNIVERSE_SLOT_LENGTH) + ii] - last[(jj * UNIVERSE_SLOT_LENGTH) + ii];
+        uint8_t b = rgb[(kk * UNIVERSE_SLOT_LENGTH) + ii] - last[(kk * UNIVERSE_SLOT_LENGTH) + ii];
+        if (a != b) return false;
+    }
+    return true;
+}
+
+void comm_class::encode_stream(uint8_t const &first_address, uint8_t const *rgb, uint8_t *last, uint8_t const &count)
+{
+    if ((count == 0) || (count > MAX_UNIVERSE_SLOTS)) return;
+
+    // Size the ops first (needed up front in XBEE_API_MODE)
+    uint8_t length = stream_ops(rgb, last, count, false);
+
+    if ((_StreamFrameCount == 0) ||
+        (STREAM_HEADER_LENGTH + length >= UNIVERSE_HEADER_LENGTH + (count * UNIVERSE_SLOT_LENGTH)))
+    {
+        // Keyframe
+        encode_universe(first_address, rgb, count);
+    }
+    else
+    {
+        begin_frame(STREAM_HEADER_LENGTH + length, BROADCAST_ADDRESS);
+        byte_stuff(E_COMM_CLASS_STREAM_MSG);
+        byte_stuff(first_address);
+        byte_stuff(count);
+        stream_ops(rgb, last, count, true);
+        end_frame();
+    }
+
+    _StreamFrameCount++;
+    if (_StreamFrameCount >= COMM_CLASS_STREAM_KEYFRAME_PERIOD) _StreamFrameCount = 0;
+
+    for (uint8_t jj=0; jj<(count * UNIVERSE_SLOT_LENGTH); jj++)
+    {
+        last[jj] = rgb[jj];
     }
-    // No bytes available ... 
 }
 
+uint8_t comm_class::stream_ops(uint8_t const *rgb, uint8_t const *last, uint8_t const &count, bool const &send)
+{
+    uint8_t length = 0;
+    uint8_t jj = 0;
+    while (jj < count)
+    {
+        uint8_t max_run = count - jj;
+        if (max_run > STREAM_RUN_MASK + 1) max_run = STREAM_RUN_MASK + 1;
 
+        // Unchanged, same color and same change runs from this slot
+        uint8_t skip = 0;
+        while ((skip < max_run) && same_slot(rgb, jj + skip, last, jj + skip)) skip++;
+        uint8_t repeat = 1;
+        while ((repeat < max_run) && same_slot(rgb, jj, rgb, jj + repeat)) repeat++;
+        uint8_t delta = 1;
+        while ((delta < max_run) && same_delta(rgb, last, jj, jj + delta)) delta++;
+
+        uint8_t op = E_STREAM_OP_LITERAL;
+        uint8_t run = 1;
+        if (skip > 0)
+        {
+            op = E_STREAM_OP_SKIP;
+            run = skip;
+        }
+        else if ((repeat > 1) && (repeat >= delta))
+        {
+            op = E_STREAM_OP_REPEAT;
+            run = repeat;
+        }
+        else if (delta > 1)
+        {
+            op = E_STREAM_OP_DELTA;
+            run = delta;
+        }
+        else
+        {
+            // Literal slots up to the next slot that is unchanged or
+            //  starts a run.
+            bool done = false;
+            while ((run < max_run) && (!done))
+            {
+                uint8_t kk = jj + run;
+                if (same_slot(rgb, kk, last, kk) ||
+                    ((kk + 1 < count) &&
+                     (same_slot(rgb, kk, rgb, kk + 1) || same_delta(rgb, last, kk, kk + 1))))
+                {
+                    done = true;
+                }
+                else
+                {
+                    run++;
+                }
+            }
+        }
+
+        uint8_t const *data = &rgb[jj * UNIVERSE_SLOT_LENGTH];
+        uint8_t data_length = UNIVERSE_SLOT_LENGTH;
+        if (op == E_STREAM_OP_SKIP) data_length = 0;
+        if (op == E_STREAM_OP_LITERAL) data_length = run * UNIVERSE_SLOT_LENGTH;
+
+        if (send)
+        {
+            byte_stuff(op | (run - 1));
+            for (uint8_t ii=0; ii<data_length; ii++)
+            {
+                if (op == E_STREAM_OP_DELTA)
+                {
+                    byte_stuff(data[ii] - last[(jj * UNIVERSE_SLOT_LENGTH) + ii]);
+                }
+                else
+                {
+                    byte_stuff(data[ii]);
+                }
+            }
+        }
+
+        length += 1 + data_length;
+        jj += run;
+    }
+    return length;
+}
+
+void comm_class::end_frame()
+{
+    if (_TxRejected) return;
+
+    // The CRC trailer (if any)
+    crc_class::crc_t crc = _TxCrc;
+#if (COMM_CLASS_CRC == 16)
+    byte_stuff(crc >> 8);
+#endif
+#if (COMM_CLASS_CRC != 0)
+    byte_stuff(crc & 0xFF);
+#else
+    (void)crc;
+#endif
+
+#if XBEE_API_MODE
+    // Frame data plus checksum adds up to 0xFF
+    byte_stuff(0xFF - _TxChecksum);
+#elif COMM_CLASS_COBS
+    // Delimiters, one code byte per 254 bytes plus the empty last
+    //  block of a msg ending in 0x00.
+    if (!reserve_frame(2 + _TxFrameLen + (_TxFrameLen / 254) + 1 + UART_MPCM)) return;
+#if UART_MPCM
+    _UartClass.putc_address(_TxMpcmAddress);
+#endif
+    _UartClass.putc(UartBaseClass::COMM_CLASS_COBS_DELIMITER);
+
+    // Send the msg as COBS blocks.  Each block runs up to the next 0x00
+    //  (or the end of the msg), the 0x00 itself is not sent.
+    uint8_t jj = 0;
+    bool done = false;
+    while (!done)
+    {
+        uint8_t run = 0;
+        while ((jj + run < _TxFrameLen) &&
+               (_TxFrame[jj + run] != 0) &&
+               (run < UartBaseClass::COMM_CLASS_COBS_MAX_CODE - 1))
+        {
+            run++;
+        }
+
+        _UartClass.putc(run + 1);
+        for (uint8_t kk=0; kk<run; kk++)
+        {
+            _UartClass.putc(_TxFrame[jj + kk]);
+        }
+        jj += run;
+
+        if (jj >= _TxFrameLen)
+        {
+            done = true;
+        }
+        else if (run < UartBaseClass::COMM_CLASS_COBS_MAX_CODE - 1)
+        {
+            // Skip the 0x00 ending this block
+            jj++;
+
+            // A msg ending in 0x00 needs an empty last block.
+            if (jj == _TxFrameLen) _UartClass.putc(1);
+            done = (jj == _TxFrameLen);
+        }
+    }
+    _UartClass.putc(UartBaseClass::COMM_CLASS_COBS_DELIMITER);
+#else
+    _UartClass.putc(UartBaseClass::COMM_CLASS_FLAG_BYTE);
+#endif
+}
+
+#if XBEE_API_MODE
+uint8_t comm_class::next_frame_id()
+{
+    _TxFrameId++;
+    if (_TxFrameId == 0) _TxFrameId = 1;
+    return _TxFrameId;
+}
+
+void comm_class::api_frame_to_msg(uint8_t const *frame, uint8_t const &length)
+{
+    uint8_t header = 0;
+
+    switch (frame[0])
+    {
+    case XBEE_RX_PACKET_16:
+        header = XBEE_RX16_HEADER_LENGTH;
+    break;
+    case XBEE_RX_PACKET_64:
+        header = XBEE_RX64_HEADER_LENGTH;
+    break;
+    case XBEE_TX_STATUS:
+        // Frame type, Frame ID, Status (ZERO is success)
+        if ((length >= 3) && (frame[2] != 0)) count_error(_TxStatusErrorCount);
+        return;
+    default:
+        // AT command responses, modem status etc ... nothing to do.
+        return;
+    }
+
+    if (length <= header)
+    {
+        count_error(_RxLengthErrorCount);
+        return;
+    }
+
+    // The radio checked the API frame checksum.  Run the msg CRC over
+    //  the RF data.
+    comm_class_span_struct msg;
+    msg._Base = frame;
+    msg._Start = header;
+    msg._Mask = 0xFF;
+    msg._Length = length - header;
+
+    crc_class::crc_t crc = crc_class::INIT;
+    for (uint8_t jj=0; jj<msg._Length; jj++)
+    {
+        crc = crc_class::update(crc, msg[jj]);
+    }
+
+    frame_to_msg(msg, crc);
+}
+#endif
+
+bool comm_class::decode(event_element_class &A)
+{
+#if !UART_RX_DEFRAMER
+    // Scan the RX ring until a complete msg is found.  Frame bytes are
+    //  byte thinned in place, nothing is copied until the payload (if
+    //  any) is moved into an event pool block.
+    uint8_t avail = _UartClass.available();
+    while ((_RxScanPos < avail) && (!current_receive_msg._MsgValid))
+    {
+        uint8_t data = _UartClass.rxPeek(_RxScanPos++);
+
+        if (!_RxInFrame)
+        {
+            // Hunting for a flag byte ... drop everything else.
+            if (data == UartBaseClass::COMM_CLASS_FLAG_BYTE)
+            {
+                _RxInFrame = true;
+                _RxEscape = false;
+                _RxFrameLen = 0;
+                _RxCrc = crc_class::INIT;
+            }
+            else
+            {
+                count_error(_RxResyncCount);
+            }
+            _UartClass.rxConsume(_RxScanPos);
+            avail -= _RxScanPos;
+            _RxScanPos = 0;
+        }
+        else if (data == UartBaseClass::COMM_CLASS_FLAG_BYTE)
+        {
+            // Found FLAG byte ... End of message.
+            //  (Extra flag bytes are empty msgs and are ignored.
+            //   A flag byte after an escape char aborts the msg.)
+            if (_RxEscape)
+            {
+                count_error(_RxEscapeErrorCount);
+            }
+            else if (_RxFrameLen > 0)
+            {
+                comm_class_span_struct msg;
+                msg._Base = _UartClass.getRxRing();
+                msg._Start = _UartClass.rxIndex(0);
+                msg._Mask = UartBaseClass::RX_RING_MASK;
+                msg._Length = _RxFrameLen;
+                frame_to_msg(msg, _RxCrc);
+            }
+
+            // This flag byte also starts the next msg.
+            _UartClass.rxConsume(_RxScanPos);
+            avail -= _RxScanPos;
+            _RxScanPos = 0;
+            _RxFrameLen = 0;
+            _RxEscape = false;
+            _RxCrc = crc_class::INIT;
+        }
+        else if ((data == UartBaseClass::COMM_CLASS_ESCAPE_CHAR_START) && (!_RxEscape))
+        {
+            // Escape char found ... next byte should be byte thinned.
+            _RxEscape = true;
+        }
+        else if ((data == UartBaseClass::COMM_CLASS_ESCAPE_CHAR_START) ||
+                 (_RxFrameLen >= MAX_FRAME_LENGTH))
+        {
+            // Two escape chars in a row or the msg is too long ...
+            //  drop it and hunt for the next FLAG byte.
+            if (data == UartBaseClass::COMM_CLASS_ESCAPE_CHAR_START)
+            {
+                count_error(_RxEscapeErrorCount);
+            }
+            else
+            {
+                count_error(_RxLengthErrorCount);
+            }
+            _UartClass.rxConsume(_RxScanPos);
+            avail -= _RxScanPos;
+            _RxScanPos = 0;
+            _RxInFrame = false;
+        }
+        else
+        {
+            // Byte thin (if needed) and write the byte back in place.
+            if (_RxEscape) data ^= UartBaseClass::COMM_CLASS_BYTE_STUFF_XOR_VALUE;
+            _RxEscape = false;
+            _UartClass.rxPoke(_RxFrameLen++, data);
+            _RxCrc = crc_class::update(_RxCrc, data);
+        }
+    }
+#endif
+
+    // Is this msg valid?
+    if (current_receive_msg._MsgValid)
+    {
+        // Pass the event back to the caller.
+        A.set(current_receive_msg._EventMsg._HardwareID
+             ,current_receive_msg._EventMsg._EventID
+             ,current_receive_msg._EventMsg._Uint8_Data);
+
+        // Hand the payload reference over to the caller.
+        A.set_payload_handle(current_receive_msg._EventMsg._PayloadHandle);
+        current_receive_msg._EventMsg._PayloadHandle = event_pool_class::INVALID_HANDLE;
+        current_receive_msg._MsgValid = false;
+        return true;
+    }
+    // Nothing yet ... 
+    return false;
+}
+
+bool comm_class::confirm_length(comm_class_span_struct const &msg)
+{
+    if ((msg._Length >= MIN_MSG_LENGTH) && (msg._Length <= MAX_FRAME_LENGTH)) return true;
+    return false;
+}
+
+void comm_class::frame_to_msg(comm_class_span_struct const &msg, crc_class::crc_t const &crc)
+{
+    // Check length
+    if (!confirm_length(msg))
+    {
+        count_error(_RxLengthErrorCount);
+        return;
+    }
+
+    // Check the CRC trailer.  The CRC over the whole frame
+    //  (trailer included) is zero for a good frame.
+    if (crc != 0)
+    {
+        count_error(_RxCrcErrorCount);
+        return;
+    }
+
+    // Good frame (as far as the link goes)
+    error_rate_sample(true);
+
+#if COMM_CLASS_RELAY
+    if (msg[0] == E_COMM_CLASS_RELAY_MSG)
+    {
+        relay_to_msg(msg);
+        return;
+    }
+#endif
+
+    msg_to_events(msg);
+}
+
+void comm_class::msg_to_events(comm_class_span_struct const &msg)
+{
+
+    if (msg[0] == E_COMM_CLASS_BATCH_MSG)
+    {
+        batch_to_events(msg);
+        return;
+    }
+
+    if (msg[0] == E_COMM_CLASS_UNIVERSE_MSG)
+    {
+        universe_to_event(msg);
+        return;
+    }
+
+    if (msg[0] == E_COMM_CLASS_STREAM_MSG)
+    {
+        stream_to_event(msg);
+        return;
+    }
+
+    if (msg[0] == E_COMM_CLASS_REALTIME_MSG)
+    {
+        realtime_to_event(msg);
+        return;
+    }
+
+    if (msg[0] == E_COMM_CLASS_SYNC_MSG)
+    {
+        sync_to_event(msg);
+        return;
+    }
+
+    if (msg[0] == E_COMM_CLASS_TRANSFER_MSG)
+    {
+        transfer_to_event(msg);
+        return;
+    }
+
+    if (msg[0] == E_COMM_CLASS_NACK_MSG)
+    {
+        nack_to_event(msg);
+        return;
+    }
+
+    if (msg[0] == E_COMM_CLASS_DISCOVER_MSG)
+    {
+        discover_to_event(msg);
+        return;
+    }
+
+    if (msg[0] == E_COMM_CLASS_ANNOUNCE_MSG)
+    {
+        announce_to_event(msg);
+        return;
+    }
+
+    if (msg[0] == E_COMM_CLASS_ASSIGN_MSG)
+    {
+        assign_to_event(msg);
+        return;
+    }
+
+    if (msg[0] == E_COMM_CLASS_STATUS_MSG)
+    {
+        status_to_event(msg);
+        return;
+    }
+
+    if (msg[0] == E_COMM_CLASS_STATS_MSG)
+    {
+        stats_to_event(msg);
+        return;
+    }
+
+    // Only universe and realtime msgs may be longer than MAX_MSG_LENGTH
+    if (msg._Length > MAX_MSG_LENGTH)
+    {
+        count_error(_RxLengthErrorCount);
+        return;
+    }
+
+    // Is this a valid msg?
+    if (!valid_event(msg[0*sizeof(uint8_t)], msg[1*sizeof(uint8_t)]))
+    {
+        count_error(_RxInvalidCount);
+        return;
+    }
+
+    // For another node?  Drop it before a pool block is allocated.
+    if (!for_this_node(msg[0], msg[2])) return;
+
+    // An unclaimed msg is being replaced ... drop its payload.
+    event_pool_class::Release(current_receive_msg._EventMsg._PayloadHandle);
+
+    current_receive_msg._EventMsg._HardwareID = (E_InputHardware) msg[0*sizeof(uint8_t)];
+    current_receive_msg._EventMsg._EventID    = (E_InputEvent) msg[1*sizeof(uint8_t)];
+    current_receive_msg._EventMsg._Uint8_Data = msg[2*sizeof(uint8_t)];
+    current_receive_msg._EventMsg._PayloadHandle = event_pool_class::INVALID_HANDLE;
+    current_receive_msg._MsgValid = true;
+
+    uint8_t payload_length = msg._Length - MIN_MSG_LENGTH;
+    if (payload_length > 0)
+    {
+        // Move the payload into a pool block.  This is the only
+        //  copy, the block travels with the event from here on.
+        uint8_t handle = event_pool_class::Alloc();
+        if (handle == event_pool_class::INVALID_HANDLE)
+        {
+            // Pool is exhausted (counted by the pool) ... drop this msg.
+            current_receive_msg._MsgValid = false;
+        }
+        else
+        {
+            uint8_t *payload = event_pool_class::Data(handle);
+            for (uint8_t jj=0; jj<payload_length; jj++)
+            {
+                payload[jj] = msg[MSG_LENGTH+jj];
+            }
+            event_pool_class::SetLength(handle, payload_length);
+            current_receive_msg._EventMsg._PayloadHandle = handle;
+        }
+    }
+}
+
+bool comm_class::valid_event(uint8_t const &hw, uint8_t const &event)
+{
+    if ((hw >= E_InputHardware::E_LAST_HARDWARE_EVENT) ||
+        (event >= E_InputEvent::E_LAST_INPUT_EVENT))
+    {
+        // Hardware and Input event is out of bounds.  This is bad.  This msg is not valid.
+        return false;
+    }
+    return true;
+}
+
+bool comm_class::for_this_node(uint8_t const &hw, uint8_t const &data)
+{
+    if (_NodeAddress == 0) return true;
+
+    if (((hw == E_RGB_CONTROLLER) && !isAddressed(data)) ||
+        (hw == E_RGB_NODE))
+    {
+        count_error(_RxFilteredCount);
+        return false;
+    }
+    return true;
+}
+
+void comm_class::batch_to_events(comm_class_span_struct const &msg)
+{
+    uint8_t count = msg[1];
+
+    // The count must match the length of the msg
+    if ((count == 0) ||
+        (count > MAX_BATCH_EVENTS) ||
+        (msg._Length != BATCH_HEADER_LENGTH + (count * MSG_LENGTH) + crc_class::LENGTH))
+    {
+        count_error(_RxLengthErrorCount);
+        return;
+    }
+
+    // Every event must be valid before any is passed on.
+    uint8_t pos = BATCH_HEADER_LENGTH;
+    for (uint8_t jj=0; jj<count; jj++)
+    {
+        if (!valid_event(msg[pos], msg[pos+1]))
+        {
+            count_error(_RxInvalidCount);
+            return;
+        }
+        pos += MSG_LENGTH;
+    }
+
+    // Pass the events (in order) into the event queue.
+    pos = BATCH_HEADER_LENGTH;
+    for (uint8_t jj=0; jj<count; jj++)
+    {
+        if (for_this_node(msg[pos], msg[pos+2]))
+        {
+            event_element_class temp((E_InputHardware)msg[pos]
+                                    ,(E_InputEvent)msg[pos+1]
+                                    ,msg[pos+2]);
+            Notify(temp);
+        }
+        pos += MSG_LENGTH;
+    }
+}
+
+void comm_class::universe_to_event(comm_class_span_struct const &msg)
+{
+    uint8_t first_address = msg[1];
+    uint8_t count = msg[2];
+
+    // The count must match the length of the msg
+    if ((count == 0) ||
+        (count > MAX_UNIVERSE_SLOTS) ||
+        (msg._Length != UNIVERSE_HEADER_LENGTH + (count * UNIVERSE_SLOT_LENGTH) + crc_class::LENGTH))
+    {
+        count_error(_RxLengthErrorCount);
+        return;
+    }
+
+    // Is there a slot for this node?  (A node without an address
+    //  has no slot.)
+    if ((_NodeAddress == 0) ||
+        (_NodeAddress < first_address) ||
+        (_NodeAddress - first_address >= count))
+    {
+        return;
+    }
+
+    // Copy only this node's slot.  This is the keyframe for stream msgs.
+    uint8_t pos = UNIVERSE_HEADER_LENGTH + ((_NodeAddress - first_address) * UNIVERSE_SLOT_LENGTH);
+    for (uint8_t jj=0; jj<UNIVERSE_SLOT_LENGTH; jj++)
+    {
+        _StreamColor[jj] = msg[pos+jj];
+    }
+    _StreamValid = true;
+
+    stream_color_to_event();
+}
+
+void comm_class::stream_to_event(comm_class_span_struct const &msg)
+{
+    uint8_t first_address = msg[1];
+    uint8_t count = msg[2];
+    uint8_t end = msg._Length - crc_class::LENGTH;
+
+    if ((count == 0) || (count > MAX_UNIVERSE_SLOTS))
+    {
+        count_error(_RxLengthErrorCount);
+        return;
+    }
+
+    // Is there a slot for this node?
+    if ((_NodeAddress == 0) ||
+        (_NodeAddress < first_address) ||
+        (_NodeAddress - first_address >= count))
+    {
+        return;
+    }
+
+    // Missed the keyframe ... wait for the next universe msg.
+    if (!_StreamValid) return;
+
+    uint8_t slot = _NodeAddress - first_address;
+    uint8_t first_slot = 0;     // First slot of this op
+    uint8_t pos = STREAM_HEADER_LENGTH;
+    while (pos < end)
+    {
+        uint8_t op = msg[pos++];
+        uint8_t run = (op & STREAM_RUN_MASK) + 1;
+        uint8_t data_length = UNIVERSE_SLOT_LENGTH;
+
+        if ((op & STREAM_OP_MASK) == E_STREAM_OP_SKIP) data_length = 0;
+        if ((op & STREAM_OP_MASK) == E_STREAM_OP_LITERAL) data_length = run * UNIVERSE_SLOT_LENGTH;
+
+        // The ops must fit the msg and the slot count
+        if ((data_length > end - pos) || (run > count - first_slot))
+        {
+            count_error(_RxLengthErrorCount);
+            return;
+        }
+
+        if (slot < first_slot + run)
+        {
+            // This op covers this node's slot
+            switch (op & STREAM_OP_MASK)
+            {
+            case E_STREAM_OP_SKIP:
+                // No change ... nothing to pass on.
+                return;
+            case E_STREAM_OP_LITERAL:
+                pos += (slot - first_slot) * UNIVERSE_SLOT_LENGTH;
+                // fall through
+            case E_STREAM_OP_REPEAT:
+                for (uint8_t jj=0; jj<UNIVERSE_SLOT_LENGTH; jj++)
+                {
+                    _StreamColor[jj] = msg[pos+jj];
+                }
+            break;
+            case E_STREAM_OP_DELTA:
+                for (uint8_t jj=0; jj<UNIVERSE_SLOT_LENGTH; jj++)
+                {
+                    _StreamColor[jj] += msg[pos+jj];
+                }
+            break;
+            }
+
+            stream_color_to_event();
+            return;
+        }
+
+        first_slot += run;
+        pos += data_length;
+    }
+
+    // Ran out of ops before this node's slot
+    count_error(_RxLengthErrorCount);
+}
+
+void comm_class::realtime_to_event(comm_class_span_struct const &msg)
+{
+    uint8_t seq = msg[1];
+    uint8_t first_address = msg[2];
+    uint8_t count = msg[3];
+
+    // The count must match the length of the msg
+    if ((count == 0) ||
+        (count > MAX_UNIVERSE_SLOTS) ||
+        (msg._Length != REALTIME_HEADER_LENGTH + (count * UNIVERSE_SLOT_LENGTH) + crc_class::LENGTH))
+    {
+        count_error(_RxLengthErrorCount);
+        return;
+    }
+
+    // Newest msg wins.  Msgs at or behind the last sequence number
+    //  are late.
+    int8_t ahead = (int8_t)(seq - _RealtimeSeq);
+    if (_RealtimeSeqValid && (ahead <= 0))
+    {
+        count_error(_RealtimeLateCount);
+        _RealtimeLateRun++;
+        if (_RealtimeLateRun < REALTIME_RESYNC_LATE) return;
+
+        // Too many late msgs in a row ... the controller restarted
+        //  the sequence, follow it.
+    }
+    else if (_RealtimeSeqValid && (ahead > 1))
+    {
+        uint16_t lost = _RealtimeLostCount + (ahead - 1);
+        _RealtimeLostCount = (lost < _RealtimeLostCount) ? 0xFFFF : lost;
+    }
+    _RealtimeLateRun = 0;
+    _RealtimeSeq = seq;
+    _RealtimeSeqValid = true;
+
+    // Is there a slot for this node?
+    if ((_NodeAddress == 0) ||
+        (_NodeAddress < first_address) ||
+        (_NodeAddress - first_address >= count))
+    {
+        return;
+    }
+
+    uint8_t pos = REALTIME_HEADER_LENGTH + ((_NodeAddress - first_address) * UNIVERSE_SLOT_LENGTH);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t jj=0; jj<UNIVERSE_SLOT_LENGTH; jj++)
+        {
+            _RealtimeColor[jj] = msg[pos+jj];
+        }
+    }
+
+    if (_RealtimePending)
+    {
+        // The last color was not taken yet.  The queued event will
+        //  pick up this one instead.
+        count_error(_RealtimeSupersededCount);
+        _RealtimeSupersededRun++;
+        if (_RealtimeSupersededRun < REALTIME_RENOTIFY) return;
+    }
+    _RealtimeSupersededRun = 0;
+    _RealtimePending = true;
+
+    event_element_class temp(E_RGB_CONTROLLER, E_SET_RGB_REALTIME, _NodeAddress);
+    Notify(temp);
+}
+
+void comm_class::sync_to_event(comm_class_span_struct const &msg)
+{
+#if OSCCAL_CALIBRATION
+    // The RX ISR kept the burst this frame ended.
+    (void)msg;
+
+    uint8_t handle = event_pool_class::Alloc();
+    if (handle == event_pool_class::INVALID_HANDLE) return;
+
+    uint16_t ticks = _UartClass.getFrameBurstTicks();
+    uint8_t *payload = event_pool_class::Data(handle);
+    payload[0] = ticks >> 8;
+    payload[1] = ticks & 0xFF;
+    payload[2] = _UartClass.getFrameBurstBytes();
+    event_pool_class::SetLength(handle, 3);
+
+    event_element_class temp(E_RGB_CONTROLLER, E_OSC_SYNC, 0);
+    temp.set_payload_handle(handle);
+    Notify(temp);
+#else
+    // Not calibrating ... nothing to do.
+    (void)msg;
+#endif
+}
+
+void comm_class::transfer_to_event(comm_class_span_struct const &msg)
+{
+    uint8_t id = msg[1];
+    uint8_t index = msg[2];
+    uint8_t total = msg[3];
+
+    if ((msg._Length <= TRANSFER_HEADER_LENGTH + crc_class::LENGTH) ||
+        (msg._Length > MAX_MSG_LENGTH + 1))
+    {
+        count_error(_RxLengthErrorCount);
+        return;
+    }
+
+    if ((id == 0) ||
+        (total == 0) ||
+        (total > MAX_TRANSFER_SEGMENTS) ||
+        (index >= total))
+    {
+        count_error(_RxInvalidCount);
+        return;
+    }
+
+    if ((id != _TransferId) || (total != _TransferTotal))
+    {
+        // New transfer ... start over.
+        _TransferId = id;
+        _TransferTotal = total;
+        _TransferMap = 0;
+    }
+
+    uint16_t bit = (1U << index);
+
+    // Already have this one ... a repair for some other node.
+    if (_TransferMap & bit) return;
+
+    uint8_t handle = event_pool_class::Alloc();
+    if (handle == event_pool_class::INVALID_HANDLE)
+    {
+        // Pool is exhausted (counted by the pool) ... it stays missing
+        //  and will be NACKed.
+        return;
+    }
+
+    uint8_t length = msg._Length - TRANSFER_HEADER_LENGTH - crc_class::LENGTH;
+    uint8_t *payload = event_pool_class::Data(handle);
+    for (uint8_t jj=0; jj<length; jj++)
+    {
+        payload[jj] = msg[TRANSFER_HEADER_LENGTH+jj];
+    }
+    event_pool_class::SetLength(handle, length);
+
+    _TransferMap |= bit;
+
+    event_element_class temp(E_RGB_CONTROLLER, E_TRANSFER_SEGMENT, index);
+    temp.set_payload_handle(handle);
+    Notify(temp);
+
+    if (_TransferMap == (uint16_t)((1UL << total) - 1))
+    {
+        event_element_class done(E_RGB_CONTROLLER, E_TRANSFER_COMPLETE, id);
+        Notify(done);
+    }
+}
+
+void comm_class::nack_to_event(comm_class_span_struct const &msg)
+{
+    if (msg._Length != NACK_LENGTH + crc_class::LENGTH)
+    {
+        count_error(_RxLengthErrorCount);
+        return;
+    }
+
+    uint8_t id = msg[1];
+    uint8_t address = msg[2];
+
+    if (address == 0)
+    {
+        // Poll from the controller.  Only nodes with an address (and
+        //  so a time slot) answer.
+        if (_NodeAddress == 0) return;
+
+        event_element_class temp(E_RGB_CONTROLLER, E_TRANSFER_POLL, id);
+        Notify(temp);
+    }
+    else
+    {
+        // Another node's NACK.  Only the controller (no node address)
+        //  cares.
+        if (_NodeAddress != 0) return;
+
+        uint8_t handle = event_pool_class::Alloc();
+        if (handle == event_pool_class::INVALID_HANDLE) return;
+
+        uint8_t *payload = event_pool_class::Data(handle);
+        payload[0] = id;
+        payload[1] = msg[3];
+        payload[2] = msg[4];
+        event_pool_class::SetLength(handle, 3);
+
+        event_element_class temp(E_RGB_NODE, E_TRANSFER_NACK, address);
+        temp.set_payload_handle(handle);
+        Notify(temp);
+    }
+}
+
+bool comm_class::takeRealtimeColor(uint8_t *rgb)
+{
+    bool taken = false;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (_RealtimePending)
+        {
+            for (uint8_t jj=0; jj<UNIVERSE_SLOT_LENGTH; jj++)
+            {
+                rgb[jj] = _RealtimeColor[jj];
+            }
+            _RealtimePending = false;
+            taken = true;
+        }
+    }
+
+    return taken;
+}
+
+void comm_class::stream_color_to_event()
+{
+    uint8_t handle = event_pool_class::Alloc();
+    if (handle == event_pool_class::INVALID_HANDLE)
+    {
+        // Pool is exhausted (counted by the pool) ... drop this msg.
+        return;
+    }
+
+    uint8_t *payload = event_pool_class::Data(handle);
+    for (uint8_t jj=0; jj<UNIVERSE_SLOT_LENGTH; jj++)
+    {
+        payload[jj] = _StreamColor[jj];
+    }
+    event_pool_class::SetLength(handle, UNIVERSE_SLOT_LENGTH);
+
+    // Pass it on as an absolute color for this node.
+    event_element_class temp(E_RGB_CONTROLLER, E_SET_RGB_VALUE, _NodeAddress);
+    temp.set_payload_handle(handle);
+    Notify(temp);
+}
+
+void comm_class::byte_stuff(uint8_t const &A)
+{
+    if (_TxRejected) return;
+
+    _TxCrc = crc_class::update(_TxCrc, A);
+
+#if COMM_CLASS_COBS
+    // Held until end_frame().  Senders never build a msg longer
+    //  than the frame (see MAX_FRAME_LENGTH).
+    if (_TxFrameLen < sizeof(_TxFrame)) _TxFrame[_TxFrameLen++] = A;
+#else
+#if XBEE_API_MODE
+    _TxChecksum += A;
+
+    if ((A == UartBaseClass::COMM_CLASS_FLAG_BYTE) ||
+        (A == UartBaseClass::COMM_CLASS_ESCAPE_CHAR_START) ||
+        (A == UartBaseClass::XBEE_XON_CHAR) ||
+        (A == UartBaseClass::XBEE_XOFF_CHAR))
+#else
+    if ((A == UartBaseClass::COMM_CLASS_FLAG_BYTE) ||
+        (A == UartBaseClass::COMM_CLASS_ESCAPE_CHAR_START))
+#endif
+    {
+        // This value needs to be byte stuffed
+        _UartClass.putc(UartBaseClass::COMM_CLASS_ESCAPE_CHAR_START);
+        _UartClass.putc(A ^ UartBaseClass::COMM_CLASS_BYTE_STUFF_XOR_VALUE);
+    } else {
+        // No byte stuffing needed ... 
+        _UartClass.putc(A);
+    }
+#endif
+}
+
+void comm_class::discover_to_event(comm_class_span_struct const &msg)
+{
+    if (msg._Length != DISCOVER_LENGTH + crc_class::LENGTH)
+    {
+        count_error(_RxLengthErrorCount);
+        return;
+    }
+
+    // Only nodes without an address answer (unless asked for all).
+    if (msg[1] == 0) return;
+    if ((_NodeAddress != 0) && !(msg[2] & DISCOVER_ALL)) return;
+
+    event_element_class temp(E_RGB_CONTROLLER, E_DISCOVER, msg[1]);
+    Notify(temp);
+}
+
+void comm_class::announce_to_event(comm_class_span_struct const &msg)
+{
+    if (msg._Length != ANNOUNCE_LENGTH + crc_class::LENGTH)
+    {
+        count_error(_RxLengthErrorCount);
+        return;
+    }
+
+    // Another node's unique ID.  Only the controller (no node address)
+    //  cares.
+    if (_NodeAddress != 0) return;
+
+    uint8_t handle = event_pool_class::Alloc();
+    if (handle == event_pool_class::INVALID_HANDLE) return;
+
+    uint8_t *payload = event_pool_class::Data(handle);
+    for (uint8_t jj=0; jj<UID_LENGTH; jj++)
+    {
+        payload[jj] = msg[1 + jj];
+    }
+    event_pool_class::SetLength(handle, UID_LENGTH);
+
+    event_element_class temp(E_RGB_NODE, E_NODE_ANNOUNCE, msg[1 + UID_LENGTH]);
+    temp.set_payload_handle(handle);
+    Notify(temp);
+}
+
+void comm_class::assign_to_event(comm_class_span_struct const &msg)
+{
+    if (msg._Length != ASSIGN_LENGTH + crc_class::LENGTH)
+    {
+        count_error(_RxLengthErrorCount);
+        return;
+    }
+
+    uint8_t address = msg[1 + UID_LENGTH];
+    if (address & GROUP_ADDRESS_FLAG)
+    {
+        count_error(_RxInvalidCount);
+        return;
+    }
+
+    // Only for the node with this unique ID
+    if (!_Identity.isUidValid()) return;
+    for (uint8_t jj=0; jj<UID_LENGTH; jj++)
+    {
+        if (msg[1 + jj] != _Identity.getUid()[jj]) return;
+    }
+
+    event_element_class temp(E_RGB_CONTROLLER, E_ASSIGN_ADDRESS, address);
+    Notify(temp);
+}
+
+void comm_class::status_to_event(comm_class_span_struct const &msg)
+{
+    node_report_to_event(msg, E_NODE_STATUS, node_report_class::STATUS_PAYLOAD_LENGTH);
+}
+
+void comm_class::stats_to_event(comm_class_span_struct const &msg)
+{
+    node_report_to_event(msg, E_NODE_STATS, node_report_class::STATS_PAYLOAD_LENGTH);
+}
+
+void comm_class::node_report_to_event(comm_class_span_struct const &msg, E_InputEvent const &event,
+                                      uint8_t const &length)
+{
+    if (msg._Length != 2 + length + crc_class::LENGTH)
+    {
+        count_error(_RxLengthErrorCount);
+        return;
+    }
+
+    // Another node's report.  Only the controller (no node address)
+    //  cares.
+    if (_NodeAddress != 0) return;
+
+    uint8_t handle = event_pool_class::Alloc();
+    if (handle == event_pool_class::INVALID_HANDLE) return;
+
+    uint8_t *payload = event_pool_class::Data(handle);
+    for (uint8_t jj=0; jj<length; jj++)
+    {
+        payload[jj] = msg[2 + jj];
+    }
+    event_pool_class::SetLength(handle, length);
+
+    event_element_class temp(E_RGB_NODE, event, msg[1]);
+    temp.set_payload_handle(handle);
+    Notify(temp);
+}
+
+#if COMM_CLASS_RELAY
+bool comm_class::relay_seen(uint8_t const &source, uint16_t const &seq)
+{
+    for (uint8_t jj=0; jj<_RelaySeenCount; jj++)
+    {
+        if ((_RelaySeenSeq[jj] == seq) && (_RelaySeenSource[jj] == source)) return true;
+    }
+
+    _RelaySeenSource[_RelaySeenNext] = source;
+    _RelaySeenSeq[_RelaySeenNext] = seq;
+    _RelaySeenNext = (_RelaySeenNext + 1) % RELAY_SEEN_SIZE;
+    if (_RelaySeenCount < RELAY_SEEN_SIZE) _RelaySeenCount++;
+    return false;
+}
+
+void comm_class::relay_to_msg(comm_class_span_struct const &msg)
+{
+    if (msg._Length < RELAY_HEADER_LENGTH + MIN_MSG_LENGTH)
+    {
+        count_error(_RxLengthErrorCount);
+        return;
+    }
+
+    // Heard this one already (directly or from another relay)?
+    uint16_t seq = ((uint16_t)msg[2] << 8) | msg[3];
+    if (relay_seen(msg[1], seq))
+    {
+        count_error(_RelayDuplicateCount);
+        return;
+    }
+
+    comm_class_span_struct inner = msg;
+    inner._Start += RELAY_HEADER_LENGTH;
+    inner._Length -= RELAY_HEADER_LENGTH;
+
+#if (COMM_CLASS_RELAY == 2)
+    // Hold it for the main loop to repeat (see relayFrame()).  Only
+    //  one msg is held, the main loop may be sending the last one.
+    uint8_t length = inner._Length - crc_class::LENGTH;
+    if ((msg[4] != 0) && (length <= RELAY_FRAME_SIZE))
+    {
+        if (_RelayPending)
+        {
+            count_error(_RelayBusyCount);
+        }
+        else
+        {
+            for (uint8_t jj=0; jj<length; jj++)
+            {
+                _RelayFrame[jj] = inner[jj];
+            }
+            _RelayLength = length;
+            _RelaySource = msg[1];
+            _RelaySeq = seq;
+            _RelayHops = msg[4] - 1;
+            _RelayPending = true;
+
+            event_element_class temp(E_UART_00, E_UART_RELAY_PENDING);
+            Notify(temp);
+        }
+    }
+#endif
+
+    msg_to_events(inner);
+}
+
+void comm_class::relayFrame()
+{
+    if (!_RelayPending) return;
+
+    // Every relayed msg is a broadcast, the nodes it is for may be
+    //  out of this node's (and the sender's) reach.
+    _TxRelayForward = true;
+    begin_frame(_RelayLength, BROADCAST_ADDRESS);
+    for (uint8_t jj=0; jj<_RelayLength; jj++)
+    {
+        byte_stuff(_RelayFrame[jj]);
+    }
+    end_frame();
+    _TxRelayForward = false;
+
+    if (!_TxRejected) count_error(_RelayedCount);
+    _RelayPending = false;
+}
+#endif
@@ -33,6 +33,50 @@
      When         Who                Description of change
     -----------  ----------         ------------------------
     2014 Oct 05  James Stokebrand   Initial Creation
+    2026 Oct 18  James Stokebrand   Frames may be de-framed by the UART
+                                      RX ISR (UART_RX_DEFRAMER).
+    2026 Oct 18  James Stokebrand   Otherwise frames are decoded in place
+                                      in the UART RX ring.
+    2026 Oct 18  James Stokebrand   Optional CRC trailer (COMM_CLASS_CRC)
+                                      and rejected frame counters.
+    2026 Oct 18  James Stokebrand   Batch msgs carrying several events.
+    2026 Oct 18  James Stokebrand   Universe msgs carrying a color per node.
+    2026 Oct 18  James Stokebrand   XBee API mode transport (XBEE_API_MODE).
+    2026 Oct 18  James Stokebrand   Delta/run length coded stream msgs.
+    2026 Oct 18  James Stokebrand   Realtime msgs with a sequence number.
+    2026 Oct 18  James Stokebrand   Reliable transfers with NACK repair.
+    2026 Oct 18  James Stokebrand   COBS framing (COMM_CLASS_COBS).
+    2026 Oct 18  James Stokebrand   Radio baud rate set at boot (XBEE_BOOT_BAUD).
+    2026 Oct 18  James Stokebrand   Sync msgs for OSCCAL calibration.
+    2026 Oct 18  James Stokebrand   Frames are sent whole or not at all,
+                                      TX drained notifications.
+    2026 Oct 18  James Stokebrand   Address characters for UART_MPCM.
+    2026 Oct 18  James Stokebrand   Msgs for other nodes are dropped before
+                                      they reach the event queue.
+    2026 Oct 18  James Stokebrand   Group addresses, saved in EEPROM.
+    2026 Oct 18  James Stokebrand   Address discovery and assignment.
+    2026 Oct 18  James Stokebrand   Status msgs (color, state and counters).
+    2026 Oct 18  James Stokebrand   Link statistics and STATS msgs.
+    2026 Oct 18  James Stokebrand   Relay header and relay nodes
+                                      (COMM_CLASS_RELAY).
+    2026 Oct 18  James Stokebrand   Frames are decoded in the main loop
+                                      (receive()), not in the RX ISR.
+    2026 Oct 18  James Stokebrand   STATS pages, page 1 carries the realtime
+                                      and TX counts.
+    2026 Oct 18  James Stokebrand   Events for one node are sent to that
+                                      node's address (MPCM, XBee).
+    2026 Oct 18  James Stokebrand   Unique ID, assigned address and groups
+                                      moved to node_identity_class, STATUS
+                                      and STATS reports to node_report_class.
+    2026 Oct 18  James Stokebrand   E_UART_RX_FRAME_END ahead of the events
+                                      of each frame.
+    2026 Oct 18  James Stokebrand   Reply time slots sized from the worst
+                                      case airtime and clock error.
+    2026 Oct 18  James Stokebrand   STATUS_MSG_LENGTH and STATS_MSG_LENGTH
+                                      for their reply slots.
+    2026 Oct 18  James Stokebrand   16 bit relay sequence from a random
+                                      start each boot.
+    2026 Oct 18  James Stokebrand   NACK_MSG_LENGTH for the NACK reply slots.
 
 *****************************************************/
 
@@ -42,6 +86,58 @@
 #include "uart_class.h"
 #endif
 
+#ifndef _NODE_IDENTITY_H_
+#include "node_identity.h"
+#endif
+
+#ifndef _NODE_REPORT_H_
+#include "node_report.h"
+#endif
+
+// Number of color slots in a universe msg (one per node address)
+#ifndef COMM_CLASS_UNIVERSE_SLOTS
+    #define COMM_CLASS_UNIVERSE_SLOTS 15
+#endif
+
+/*
+** Set XBEE_BOOT_BAUD to the radio's power up baud rate (9600 from the
+** factory) to have the comm class switch the radio to BAUD at boot
+** (ATBD, ATWR, ATCN in command mode).  0 means the radio is already
+** at BAUD.
+*/
+#ifndef XBEE_BOOT_BAUD
+    #define XBEE_BOOT_BAUD 0
+#endif
+
+/*
+    Reply time slots (see comm_class::reply_slot_ms()).  Every node
+    times its slot from the poll's frame end on its own RC oscillator,
+    COMM_CLASS_CLOCK_ERROR is the most (permille) a node's clock is off
+    from the controller's.  Trimming the oscillator (OSCCAL_CALIBRATION)
+    brings it down.  COMM_CLASS_SLOT_GUARD_US covers the 1 ms timer
+    tick and the time to get the reply queued.
+*/
+#ifndef COMM_CLASS_CLOCK_ERROR
+    #if OSCCAL_CALIBRATION
+        #define COMM_CLASS_CLOCK_ERROR 5
+    #else
+        #define COMM_CLASS_CLOCK_ERROR 20
+    #endif
+#endif
+#ifndef COMM_CLASS_SLOT_GUARD_US
+    #define COMM_CLASS_SLOT_GUARD_US 2000
+#endif
+
+#if (COMM_CLASS_CLOCK_ERROR >= 500)
+    #error "COMM_CLASS_CLOCK_ERROR is permille, must be less than 500"
+#endif
+
+// A stream of colors (see encode_stream()) sends a universe msg as a
+//  keyframe at least this often (in frames).
+#ifndef COMM_CLASS_STREAM_KEYFRAME_PERIOD
+    #define COMM_CLASS_STREAM_KEYFRAME_PERIOD 32
+#endif
+
 class comm_class
 : public EventObserver
 , public EventSubject
@@ -52,9 +148,70 @@ public:
     {
         _UartClass.Attach(this);
 
-        TRAN((STATE)&comm_class::STATE_decode__search_for_flag_byte);
+#if XBEE_BOOT_BAUD
+        radio_baud();
+#endif
+
+#if !UART_RX_DEFRAMER
+        _RxScanPos = 0;
+        _RxFrameLen = 0;
+        _RxInFrame = false;
+        _RxEscape = false;
+        _RxCrc = crc_class::INIT;
+        _RxEscapeErrorCount = 0;
+        _RxResyncCount = 0;
+#endif
         current_receive_msg._MsgValid = false;
+        current_receive_msg._EventMsg._PayloadHandle = event_pool_class::INVALID_HANDLE;
         current_transmit_msg._MsgValid = false;
+
+        _NodeAddress = 0;
+        _StreamValid = false;
+        _StreamFrameCount = 0;
+        _RealtimeSeq = 0;
+        _RealtimeSeqValid = false;
+        _RealtimeLateRun = 0;
+        _RealtimePending = false;
+        _RealtimeSupersededRun = 0;
+        _RealtimeLostCount = 0;
+        _RealtimeLateCount = 0;
+        _RealtimeSupersededCount = 0;
+        _TxRealtimeSeq = 0;
+        _TransferId = 0;
+        _TransferTotal = 0;
+        _TransferMap = 0;
+
+        _TxCrc = crc_class::INIT;
+        _TxRejected = false;
+        _TxRejectCount = 0;
+#if COMM_CLASS_COBS
+        _TxFrameLen = 0;
+#endif
+#if UART_MPCM && COMM_CLASS_COBS
+        _TxMpcmAddress = UartBaseClass::MPCM_BROADCAST;
+#endif
+#if XBEE_API_MODE
+        _TxChecksum = 0;
+        _TxFrameId = 0;
+        _TxStatusErrorCount = 0;
+#endif
+        _RxCrcErrorCount = 0;
+        _RxLengthErrorCount = 0;
+        _RxInvalidCount = 0;
+        _RxFilteredCount = 0;
+        _RxErrorRate = 0;
+        _RxErrorTotal = 0;
+#if COMM_CLASS_RELAY
+        _TxRelaySeq = 0;
+        _TxRelaySeqStarted = false;
+        _TxRelayForward = false;
+        _RelaySeenCount = 0;
+        _RelaySeenNext = 0;
+        _RelayPending = false;
+        _RelayedCount = 0;
+        _RelayDuplicateCount = 0;
+        _RelayBusyCount = 0;
+#endif
     }
 
     virtual ~comm_class() {
@@ -67,24 +224,462 @@ public:
             <MSG struct> (variable size)
             0x7E (END Byte)
 
+        MSG struct:
+            Hardware ID (1 byte)
+            Event ID    (1 byte)
+            Data        (1 byte)
+            Payload     (0 to event_pool_class::BLOCK_SIZE bytes)
+            CRC         (0, 1 or 2 bytes, see COMM_CLASS_CRC)
+
+        BATCH MSG struct:
+            E_COMM_CLASS_BATCH_MSG (1 byte)
+            Count       (1 byte, 1 to MAX_BATCH_EVENTS)
+            Count * (Hardware ID, Event ID, Data)
+            CRC         (0, 1 or 2 bytes, see COMM_CLASS_CRC)
+
+        UNIVERSE MSG struct:
+            E_COMM_CLASS_UNIVERSE_MSG (1 byte)
+            First address (1 byte)
+            Count       (1 byte, 1 to MAX_UNIVERSE_SLOTS)
+            Count * (Red, Green, Blue)
+            CRC         (0, 1 or 2 bytes, see COMM_CLASS_CRC)
+        The node at First address + n takes slot n and passes it on
+        as an E_SET_RGB_VALUE event.  All other slots are skipped.
+
+        STREAM MSG struct:
+            E_COMM_CLASS_STREAM_MSG (1 byte)
+            First address (1 byte)
+            Count       (1 byte, 1 to MAX_UNIVERSE_SLOTS)
+            Ops covering Count slots, each op is
+                Op | (Run - 1)  (1 byte, Run 1 to 64 slots)
+                E_STREAM_OP_SKIP:    no data, slots are unchanged
+                E_STREAM_OP_REPEAT:  (Red, Green, Blue) for every slot
+                E_STREAM_OP_DELTA:   (Red, Green, Blue) added (mod 256)
+                                      to every slot
+                E_STREAM_OP_LITERAL: Run * (Red, Green, Blue)
+            CRC         (0, 1 or 2 bytes, see COMM_CLASS_CRC)
+        Changes are against the last color the node applied from a
+        universe or stream msg.  A universe msg is the keyframe, a node
+        ignores stream msgs until it has seen one.
+
+        REALTIME MSG struct:
+            E_COMM_CLASS_REALTIME_MSG (1 byte)
+            Sequence    (1 byte, one more than the last realtime msg)
+            First address (1 byte)
+            Count       (1 byte, 1 to MAX_UNIVERSE_SLOTS)
+            Count * (Red, Green, Blue)
+            CRC         (0, 1 or 2 bytes, see COMM_CLASS_CRC)
+        Msgs at or behind the last sequence number are late and dropped.
+        Only the newest color is kept (see takeRealtimeColor()), so a
+        slow node skips frames instead of queueing them up.
+
+        SYNC MSG struct:
+            E_COMM_CLASS_SYNC_MSG (1 byte)
+            Pattern     (1 to event_pool_class::BLOCK_SIZE bytes, 0x55)
+            CRC         (0, 1 or 2 bytes, see COMM_CLASS_CRC)
+        Sent back to back, so the UART can time it (OSCCAL_CALIBRATION).
+        Passed on as E_OSC_SYNC with the burst timing.
+
+        TRANSFER MSG struct:
+            E_COMM_CLASS_TRANSFER_MSG (1 byte)
+            Transfer ID (1 byte, ZERO is not used)
+            Index       (1 byte, 0 to Total - 1)
+            Total       (1 byte, 1 to MAX_TRANSFER_SEGMENTS)
+            Segment     (1 to event_pool_class::BLOCK_SIZE bytes)
+            CRC         (0, 1 or 2 bytes, see COMM_CLASS_CRC)
+        Each new segment is passed on once as an E_TRANSFER_SEGMENT
+        event, repeats are dropped.  E_TRANSFER_COMPLETE follows the
+        last missing segment.
+
+        NACK MSG struct:
+            E_COMM_CLASS_NACK_MSG (1 byte)
+            Transfer ID (1 byte)
+            Node address (1 byte, ZERO from the controller)
+            Missing map (2 bytes MSB first, bit n is segment n)
+            CRC         (0, 1 or 2 bytes, see COMM_CLASS_CRC)
+        From the controller (node address ZERO) it is a poll.  Each
+        node answers with its missing map in its own time slot (see
+        encode_nack()), the controller resends only the missing
+        segments.  A map of ZERO means the node has them all.
+
+        DISCOVER MSG struct:
+            E_COMM_CLASS_DISCOVER_MSG (1 byte)
+            Slots       (1 byte, 1 to 255)
+            Flags       (1 byte, DISCOVER_ALL)
+            CRC         (0, 1 or 2 bytes, see COMM_CLASS_CRC)
+        Nodes without an address (every node with DISCOVER_ALL) answer
+        with an ANNOUNCE msg in a random one of Slots time slots (see
+        node_identity_class::random()).  Answers that collide are lost, the controller sends
+        DISCOVER msgs until no node answers.
+
+        ANNOUNCE MSG struct:
+            E_COMM_CLASS_ANNOUNCE_MSG (1 byte)
+            Unique ID   (node_identity_class::UID_LENGTH bytes)
+            Node address (1 byte, ZERO if not assigned)
+            CRC         (0, 1 or 2 bytes, see COMM_CLASS_CRC)
+
+        ASSIGN MSG struct:
+            E_COMM_CLASS_ASSIGN_MSG (1 byte)
+            Unique ID   (node_identity_class::UID_LENGTH bytes)
+            Node address (1 byte, 1 to 0x7F, ZERO to forget it)
+            CRC         (0, 1 or 2 bytes, see COMM_CLASS_CRC)
+        Only the node with this unique ID takes it (E_ASSIGN_ADDRESS),
+        it saves the address and answers with an ANNOUNCE msg.  A node
+        addressed by its DIP switches keeps the switch address and
+        announces that instead (the assignment is refused).
+
+        STATUS MSG struct:
+            E_COMM_CLASS_STATUS_MSG (1 byte)
+            Node address (1 byte)
+            State       (1 byte, feedback event of the state, E_LED_RED_PWM ...)
+            Red, Green, Blue (6 bytes, 16 bit MSB first)
+            Event queue high water (1 byte)
+            Event pool high water  (1 byte)
+            Rejected frames (2 bytes MSB first, CRC + length + invalid)
+            Uptime      (4 bytes MSB first, seconds)
+            CRC         (0, 1 or 2 bytes, see COMM_CLASS_CRC)
+        Sent to the controller on E_STATUS_REQUEST or when the color or
+        state changes (see rgb_node_state_machine::push_status()).  The
+        controller gets E_NODE_STATUS with everything after the node
+        address as the payload.
+
+        STATS MSG struct:
+            E_COMM_CLASS_STATS_MSG (1 byte)
+            Node address (1 byte)
+            Page        (1 byte, STATS_PAGE_LINK or STATS_PAGE_DELIVERY)
+            STATS_PAGE_LINK:
+                Framing errors  (2 bytes MSB first)
+                Overruns        (2 bytes MSB first)
+                Overflows       (2 bytes MSB first)
+                Escape errors   (2 bytes MSB first)
+                Resyncs         (2 bytes MSB first)
+                Length errors   (2 bytes MSB first)
+                CRC errors      (2 bytes MSB first)
+                Error rate      (1 byte, see getErrorRate())
+            STATS_PAGE_DELIVERY:
+                Realtime lost       (2 bytes MSB first)
+                Realtime late       (2 bytes MSB first)
+                Realtime superseded (2 bytes MSB first)
+                Filtered msgs   (2 bytes MSB first)
+                TX rejects      (2 bytes MSB first)
+                TX drops        (2 bytes MSB first)
+                Pool exhausted  (2 bytes MSB first)
+                Reserved        (1 byte, ZERO)
+            CRC         (0, 1 or 2 bytes, see COMM_CLASS_CRC)
+        Sent to the controller on E_STATS_REQUEST, the optional first
+        payload byte of the request picks the page.  The controller gets
+        E_NODE_STATS with everything after the node address as the
+        payload.
+
+        COMM_CLASS_RELAY:
+            Every msg above is sent inside a RELAY msg.
+            E_COMM_CLASS_RELAY_MSG (1 byte)
+            Source      (1 byte, node address of the sender, ZERO is the controller)
+            Sequence    (2 bytes MSB first, counts up per sender)
+            Hops        (1 byte, times the msg may still be repeated)
+            <MSG struct> (without its CRC)
+            CRC         (0, 1 or 2 bytes, see COMM_CLASS_CRC)
+        A (Source, Sequence) pair already seen is dropped.  Each boot
+        the sequence starts from a random number (see
+        node_identity_class), so neither a node that restarts nor
+        unaddressed nodes (all Source ZERO) repeat the pairs a
+        neighbour still remembers.  Relay nodes
+        (COMM_CLASS_RELAY == 2) repeat new msgs with Hops left, one hop
+        less, after a random delay (see relayFrame()).
+
         All bytes between START/STOP bytes will be byte stuffed.
             0x7D in the msg body will be stuffed with 0x7D 0x5D
             0x7E in the msg body will be stuffed with 0x7D 0x5E
+
+        COMM_CLASS_COBS:
+            0x00 (delimiter), <COBS encoded MSG struct>, 0x00 (delimiter)
+            The msg is split at each 0x00.  Each block is sent as a code
+            byte (block length + 1) then the block, so the msg carries
+            no 0x00 and grows by one byte.
+
+        XBEE_API_MODE:
+            The msg struct is carried in the RF data of XBee API frames
+            instead of between START/END bytes.
+            0x7E, Length (2 bytes), Frame data, Checksum
+            TX: TX Request 16 bit address (0x01) to the destination
+            RX: RX Packet 16 bit (0x81) or 64 bit (0x80) address
+            Everything after the 0x7E is escaped as above, plus
+            0x11 and 0x13 (XON/XOFF).
+    */
+
+    // Radio (16 bit) addresses.  Only used in XBEE_API_MODE.  Node n
+    //  has radio address NODE_ADDRESS_BASE + n (see radio_address()).
+    static const uint16_t BROADCAST_ADDRESS = 0xFFFF;
+    static const uint16_t CONTROLLER_ADDRESS = 0x0000;
+    static const uint16_t NODE_ADDRESS_BASE = 0x1000;
+
+    // Radio address of this node address.  Node address ZERO is the
+    //  broadcast address.
+    static uint16_t radio_address(uint8_t const &node)
+    {
+        return (node == 0) ? BROADCAST_ADDRESS : (NODE_ADDRESS_BASE + node);
+    }
+
+#if UART_MPCM
+    // Address character of a radio address.  The controller is
+    //  address character ZERO, node n is n.
+    static uint8_t mpcm_address(uint16_t const &dest)
+    {
+        return (dest == BROADCAST_ADDRESS) ? UartBaseClass::MPCM_BROADCAST : (uint8_t)(dest & 0xFF);
+    }
+#endif
+
+    // Most events a batch msg can carry.  A batch msg is never longer
+    //  than a msg with a full payload.
+    static const uint8_t MAX_BATCH_EVENTS = (event_pool_class::BLOCK_SIZE + 1) / 3;
+
+    // Most color slots a universe msg can carry.
+    static const uint8_t MAX_UNIVERSE_SLOTS = COMM_CLASS_UNIVERSE_SLOTS;
+
+    // This node's address.  Used to pick this node's slot out of
+    //  universe msgs and to drop event msgs for other nodes (see
+    //  for_this_node()).  In XBEE_API_MODE the radio's MY address is set
+    //  to radio_address(A), so the radio drops msgs for other nodes.
+    void setNodeAddress(uint8_t const &A);
+
+    /*
+        Addresses in the data byte of controller events:
+            0x00        every node
+            0x01..0x7F  one node (the DIP switch address)
+            0x80..0xFF  groups, bit 7 set plus a bit per group
+        A node is in a group msg if any of its group bits are set in
+        the address.  Up to 7 groups, a node may be in any of them.
+    */
+    static const uint8_t GROUP_ADDRESS_FLAG = 0x80;
+
+    bool isAddressed(uint8_t const &address)
+    {
+        if (address & GROUP_ADDRESS_FLAG) return (address & _Identity.getGroupMask());
+        return ((address == 0) || (address == _NodeAddress));
+    }
+
+    // This node's unique ID, assigned address, groups and random
+    //  numbers (saved in EEPROM, see node_identity.h).
+    node_identity_class &getIdentity() { return _Identity; }
+
+    // Encode and send an Event Msg.  dest is only used in XBEE_API_MODE
+    //  and UART_MPCM.  Left at BROADCAST_ADDRESS, a controller event for
+    //  one node (see event_address()) is sent to that node only, so
+    //  the other nodes' radios drop it (XBee) or they sleep through it
+    //  (MPCM).
+    void encode(event_element_class const &A, uint16_t const &dest = BROADCAST_ADDRESS);
+
+    // Encode and send count events.  Runs of events without a payload
+    //  are sent as batch msgs (MAX_BATCH_EVENTS per msg), events with a
+    //  payload are sent on their own.  A batch of events all for the
+    //  same node is sent to that node only.
+    void encode(event_element_class const *A, uint8_t const &count);
+
+    // Radio address of the node an event is for.  E_RGB_CONTROLLER
+    //  events carry the node address as the data (see for_this_node()),
+    //  group addresses and ZERO go to every node.
+    static uint16_t event_address(event_element_class const &A)
+    {
+        if ((A.get_current_hardware() != E_RGB_CONTROLLER) ||
+            (A.get_current_data() & GROUP_ADDRESS_FLAG))
+        {
+            return BROADCAST_ADDRESS;
+        }
+        return radio_address(A.get_current_data());
+    }
+
+    // Encode and send a universe msg.  rgb holds count (Red, Green, Blue)
+    //  slots for the nodes from first_address up.
+    void encode_universe(uint8_t const &first_address, uint8_t const *rgb, uint8_t const &count);
+
+    // Encode and send the next frame of a stream of colors.  rgb holds
+    //  count (Red, Green, Blue) slots for the nodes from first_address
+    //  up, last holds the previous frame sent and is updated.  Sends a
+    //  universe msg (keyframe) every COMM_CLASS_STREAM_KEYFRAME_PERIOD
+    //  frames or when the stream msg would not be any shorter.
+    void encode_stream(uint8_t const &first_address, uint8_t const *rgb, uint8_t *last, uint8_t const &count);
+
+    // Encode and send a realtime msg.  Same as encode_universe() plus
+    //  the next sequence number.
+    void encode_realtime(uint8_t const &first_address, uint8_t const *rgb, uint8_t const &count);
+
+    // Copy the newest realtime color (Red, Green, Blue) to rgb.  Called
+    //  on E_SET_RGB_REALTIME.  Returns false if it was already taken.
+    bool takeRealtimeColor(uint8_t *rgb);
+
+    // Realtime msg counters (saturate at 0xFFFF)
+    //  Lost       - Sequence numbers skipped over
+    //  Late       - Msgs at or behind the last sequence number
+    //  Superseded - Colors replaced before they were taken
+    uint16_t getRealtimeLostCount() { return _RealtimeLostCount; }
+    uint16_t getRealtimeLateCount() { return _RealtimeLateCount; }
+    uint16_t getRealtimeSupersededCount() { return _RealtimeSupersededCount; }
+
+    // Encode and send a sync msg of length pattern bytes.
+    void encode_sync(uint8_t const &length);
+
+    // Most segments in a transfer (one bit each in the missing map)
+    static const uint8_t MAX_TRANSFER_SEGMENTS = 16;
+
+    // Encode and send segment index (of total) of a transfer.
+    void encode_segment(uint8_t const &id, uint8_t const &index, uint8_t const &total,
+                        uint8_t const *data, uint8_t const &length);
+
+    // Encode and send a NACK poll for a transfer (controller).
+    void encode_nack_poll(uint8_t const &id);
+
+    // Encode and send this node's missing map for the current transfer
+    //  to the controller.  The caller picks the time slot.
+    void encode_nack();
+
+    /*
+        Address discovery.  Nodes get their address from the DIP
+        switches, or (DIP switches all off) from an ASSIGN msg saved in
+        EEPROM.  Each node has a random unique ID, made on the first
+        ANNOUNCE and saved in EEPROM (see getIdentity()).
     */
 
-    // Encode and send an Event Msg
-    void encode(event_element_class const &A);
+    // Encode and send a DISCOVER msg with this many time slots
+    //  (controller).  With all, nodes that have an address answer too.
+    static const uint8_t DISCOVER_ALL = 0x01;
+    void encode_discover(uint8_t const &slots, bool const &all = false);
+
+    // Encode and send this node's unique ID and address to the
+    //  controller.  The caller picks the time slot.
+    void encode_announce();
+
+    // Encode and send an ASSIGN msg (controller).
+    void encode_assign(uint8_t const *uid, uint8_t const &address);
+
+    // Worst case characters on the wire for a msg of length bytes (the
+    //  relay header, CRC, framing and MPCM address character added),
+    //  and the time they take at BAUD.
+    static uint16_t frame_chars(uint8_t const &length);
+    static uint32_t frame_airtime_us(uint8_t const &length);
+
+    // Length of a feedback msg (Hardware ID, Event ID and the 16 bit
+    //  value, see event_element_class::set_data16()).
+    static const uint8_t FEEDBACK_MSG_LENGTH = 4;
+
+    // Length of a STATUS and a STATS msg (type and node address bytes
+    //  plus the report).
+    static const uint8_t STATUS_MSG_LENGTH = 2 + node_report_class::STATUS_PAYLOAD_LENGTH;
+    static const uint8_t STATS_MSG_LENGTH = 2 + node_report_class::STATS_PAYLOAD_LENGTH;
+
+    // Length of a NACK msg (type, transfer ID, node address and the
+    //  16 bit missing map, see encode_nack()).
+    static const uint8_t NACK_MSG_LENGTH = 5;
+
+    /*
+        Start of node address's reply slot, in ms after the end of a
+        broadcast (or group) poll, for replies of length bytes.  Node n
+        times its slot with its own clock, so it may start or end up to
+        COMM_CLASS_CLOCK_ERROR permille of its delay early or late.  Each
+        slot starts after the worst case end of the slot before (longest
+        reply plus COMM_CLASS_SLOT_GUARD_US), so later slots grow.  The
+        round is over at reply_slot_ms(highest address + 1, length).
+        0xFFFF if it is further away than that.  Takes a while for high
+        addresses (a loop per address), work it out once.
+    */
+    static uint16_t reply_slot_ms(uint8_t const &address, uint8_t const &length);
+
+    // Encode and send this node's STATUS msg to the controller.  report
+    //  is filled in by node_report_class::status().  The caller picks
+    //  the time slot.
+    void encode_status(uint8_t const *report);
+
+    // Encode and send a page of this node's STATS msg to the
+    //  controller.  report is filled in by node_report_class::stats().
+    //  The caller picks the time slot.
+    void encode_stats(uint8_t const *report);
 
     // Rx and Decode an Event Msg
     bool decode(event_element_class &A);
 
+    // Decode what the UART RX ISR has collected and pass the msgs into
+    //  the event queue.  Called from the main loop for the
+    //  E_UART_RX_FRAME_EVENT (or E_UART_FLAG_BYTE_FOUND_EVENT) that
+    //  Update() passed on, the RX ISR only collects the bytes.  The
+    //  msgs' events are led by E_UART_00/E_UART_RX_FRAME_END with the
+    //  time the frame ended, reply time slots are timed from it.
+    void receive();
+
+    // Frames are never split.  Room for the whole (worst case stuffed)
+    //  frame is reserved in the UART TX ring before the first byte is
+    //  queued.  If there is no room the frame is dropped and counted
+    //  here, the caller can ask to be told when the TX ring drains.
+    uint16_t getTxRejectCount() { return _TxRejectCount; }
+    // Bytes the UART class dropped (TX ring full)
+    uint16_t getTxDropCount() { return _UartClass.getTxDropCount(); }
+
+    // Pass E_UART_00/E_UART_TX_COMPLETE into the event queue once, the
+    //  next time the UART TX ring runs empty.
+    void notifyWhenTxDrained() { _UartClass.notifyWhenTxDrained(); }
+
     virtual void Update(event_element_class const &A);
 
+    // Rejected frame counters (saturate at 0xFFFF)
+    uint16_t getCrcErrorCount() { return _RxCrcErrorCount; }
+    uint16_t getLengthErrorCount() { return _RxLengthErrorCount; }
+    uint16_t getInvalidCount() { return _RxInvalidCount; }
+    // Events for other nodes dropped before the event queue
+    uint16_t getFilteredCount() { return _RxFilteredCount; }
+
+    // Link statistics (saturate at 0xFFFF).  Framing errors, overruns
+    //  and overflows are counted by the UART RX ISR.  Escape errors and
+    //  resyncs are counted where the frame is assembled (the UART RX
+    //  ISR with UART_RX_DEFRAMER, decode() otherwise).
+    uint16_t getFramingErrorCount() { return _UartClass.getRxFramingErrorCount(); }
+    uint16_t getOverrunCount() { return _UartClass.getRxOverrunCount(); }
+    uint16_t getOverflowCount() { return _UartClass.getRxOverflowCount(); }
+    uint16_t getEscapeErrorCount();
+    uint16_t getResyncCount();
+
+    // Rolling share of rejected frames, 0 (none) to 255 (all).  Each
+    //  frame moves it 1/16 of the way towards 0 (good) or 255 (bad).
+    uint8_t getErrorRate();
+
+#if COMM_CLASS_RELAY
+    // Hops given to the msgs this node sends
+    static const uint8_t RELAY_HOPS = 2;
+
+    // A relay node holds one msg to repeat.  E_UART_00/E_UART_RELAY_PENDING
+    //  is passed into the event queue when it is taken, the caller waits
+    //  a random time (so neighbouring relays don't collide) and calls
+    //  relayFrame() from the main loop.
+    void relayFrame();
+
+    uint16_t getRelayedCount() { return _RelayedCount; }
+    // Copies dropped because the (source, sequence) was already seen
+    uint16_t getRelayDuplicateCount() { return _RelayDuplicateCount; }
+    // Msgs not repeated because the last one was still waiting
+    uint16_t getRelayBusyCount() { return _RelayBusyCount; }
+#endif
+#if XBEE_API_MODE
+    // TX status frames reporting a failed (no ACK, CCA) transmit
+    uint16_t getTxStatusErrorCount() { return _TxStatusErrorCount; }
+#endif
+
 private:
     // Used internally
 
+    // Msg types other than a plain event msg start with a type byte
+    //  of 0xF0 or above (never a valid Hardware ID).
     typedef enum {
          E_COMM_CLASS_EVENT_MSG = 0x01 // Msg containing events
+        ,E_COMM_CLASS_BATCH_MSG = 0xF1 // Msg containing a batch of events
+        ,E_COMM_CLASS_UNIVERSE_MSG     // Msg containing a color per node
+        ,E_COMM_CLASS_STREAM_MSG       // Msg containing color changes per node
+        ,E_COMM_CLASS_REALTIME_MSG     // Msg containing a sequenced color per node
+        ,E_COMM_CLASS_TRANSFER_MSG     // Msg containing a segment of a transfer
+        ,E_COMM_CLASS_NACK_MSG         // Msg containing missing segments
+        ,E_COMM_CLASS_SYNC_MSG         // Msg timed for OSCCAL calibration
+        ,E_COMM_CLASS_DISCOVER_MSG     // Msg asking unassigned nodes to announce
+        ,E_COMM_CLASS_ANNOUNCE_MSG     // Msg containing a node's unique ID
+        ,E_COMM_CLASS_ASSIGN_MSG       // Msg assigning an address to a unique ID
+        ,E_COMM_CLASS_STATUS_MSG       // Msg containing a node's status
+        ,E_COMM_CLASS_STATS_MSG        // Msg containing a node's link statistics
+        ,E_COMM_CLASS_RELAY_MSG        // Msg containing a msg to be relayed
         ,E_COMM_CLASS_LAST_EVENT
     } E_CommClass_MsgType;
 
@@ -92,6 +687,7 @@ private:
         E_InputHardware     _HardwareID;
         E_InputEvent        _EventID;
         uint8_t             _Uint8_Data;
+        uint8_t             _PayloadHandle;
     };
 
     struct comm_class_current_msg_struct {
@@ -103,38 +699,274 @@ private:
     comm_class_current_msg_struct current_receive_msg;
     comm_class_current_msg_struct current_transmit_msg;
 
+    // A (byte thinned) frame.  The bytes may wrap around the end of
+    //  the UART RX ring, so they are indexed through the mask.
+    struct comm_class_span_struct {
+        uint8_t const      *_Base;
+        uint8_t             _Start;
+        uint8_t             _Mask;
+        uint8_t             _Length;
+
+        uint8_t operator[](uint8_t const &jj) const {
+            return _Base[(_Start + jj) & _Mask];
+        }
+    };
+
     // Confirm the length of the RXed msg.
-    bool confirm_length(uint8_t *raw, uint8_t const &len);
+    bool confirm_length(comm_class_span_struct const &msg);
 
-    // Byte stuff and send this byte
+    // Move a complete (byte thinned) frame into current_receive_msg.
+    //  crc is the CRC of every byte in the frame.
+    void frame_to_msg(comm_class_span_struct const &msg, crc_class::crc_t const &crc);
+
+    // Move a msg that passed the length and CRC checks into
+    //  current_receive_msg (or the event queue).
+    void msg_to_events(comm_class_span_struct const &msg);
+
+    // Hardware and Input event are in bounds
+    bool valid_event(uint8_t const &hw, uint8_t const &event);
+
+    // Should this RXed event take an event queue slot?  Controller
+    //  events carry the node (or group) address in the data byte (see
+    //  isAddressed()), node events are feedback from other nodes.  Everything
+    //  passes until a node address is set.  Counts what is dropped.
+    bool for_this_node(uint8_t const &hw, uint8_t const &data);
+
+    // Pass the events of a batch msg into the event queue.
+    void batch_to_events(comm_class_span_struct const &msg);
+
+    // Pass this node's slot of a universe msg into the event queue.
+    void universe_to_event(comm_class_span_struct const &msg);
+
+    // Stream msg ops (top 2 bits of the op byte)
+    typedef enum {
+         E_STREAM_OP_SKIP    = 0x00
+        ,E_STREAM_OP_REPEAT  = 0x40
+        ,E_STREAM_OP_DELTA   = 0x80
+        ,E_STREAM_OP_LITERAL = 0xC0
+    } E_CommClass_StreamOp;
+
+    static const uint8_t STREAM_OP_MASK = 0xC0;
+    static const uint8_t STREAM_RUN_MASK = 0x3F;
+
+    // Pass this node's slot of a stream msg into the event queue.  The
+    //  ops are walked in the msg, nothing is buffered.
+    void stream_to_event(comm_class_span_struct const &msg);
+
+    // Pass _StreamColor on as an absolute color for this node.
+    void stream_color_to_event();
+
+    // Work out (and send, if send is true) the stream ops for rgb
+    //  against last.  Returns the length of the ops.
+    uint8_t stream_ops(uint8_t const *rgb, uint8_t const *last, uint8_t const &count, bool const &send);
+
+    uint8_t _NodeAddress;
+
+    node_identity_class _Identity;
+
+    // Keep the newest realtime color for this node.
+    void realtime_to_event(comm_class_span_struct const &msg);
+
+    // Late msgs in a row before the sequence number is taken anyway
+    //  (the controller restarted).
+    static const uint8_t REALTIME_RESYNC_LATE = 8;
+
+    // Superseded colors in a row before E_SET_RGB_REALTIME is sent
+    //  again (in case the event queue dropped it).
+    static const uint8_t REALTIME_RENOTIFY = 8;
+
+    uint8_t _RealtimeSeq;
+    bool    _RealtimeSeqValid;
+    uint8_t _RealtimeLateRun;
+    uint8_t _RealtimeColor[3];
+    volatile bool _RealtimePending;
+    uint8_t _RealtimeSupersededRun;
+    uint16_t _RealtimeLostCount;
+    uint16_t _RealtimeLateCount;
+    uint16_t _RealtimeSupersededCount;
+    uint8_t _TxRealtimeSeq;
+
+    // Pass the burst timing of a sync msg into the event queue.
+    void sync_to_event(comm_class_span_struct const &msg);
+
+    // Pass a new transfer segment into the event queue.
+    void transfer_to_event(comm_class_span_struct const &msg);
+
+    // Pass a NACK poll (node) or a NACK (controller) into the event queue.
+    void nack_to_event(comm_class_span_struct const &msg);
+
+    // Pass discovery msgs into the event queue.
+    void discover_to_event(comm_class_span_struct const &msg);
+    void announce_to_event(comm_class_span_struct const &msg);
+    void assign_to_event(comm_class_span_struct const &msg);
+
+    // Pass a node's STATUS msg into the event queue (controller).
+    void status_to_event(comm_class_span_struct const &msg);
+
+    // Pass a node's STATS msg into the event queue (controller).
+    void stats_to_event(comm_class_span_struct const &msg);
+
+    // Pass a node's STATUS or STATS msg (length bytes after the node
+    //  address) into the event queue as event (controller).
+    void node_report_to_event(comm_class_span_struct const &msg, E_InputEvent const &event,
+                              uint8_t const &length);
+
+    // Pass E_UART_RX_FRAME_END for the frame about to be decoded.
+    void notify_frame_end();
+
+    // Encode and send a STATUS or STATS msg (type), this node's
+    //  address then length bytes of report.
+    void encode_report(uint8_t const &type, uint8_t const *report, uint8_t const &length);
+
+    // Current transfer.  Bit n of _TransferMap is set once segment n
+    //  has been passed on.
+    uint8_t  _TransferId;
+    uint8_t  _TransferTotal;
+    uint16_t _TransferMap;
+
+    // Last color applied from a universe or stream msg
+    uint8_t _StreamColor[3];
+    bool    _StreamValid;
+
+    // Frames sent since the last keyframe
+    uint8_t _StreamFrameCount;
+
+#if XBEE_BOOT_BAUD
+    // Switch the radio from XBEE_BOOT_BAUD to BAUD.  Blocks for a couple
+    //  of seconds (command mode guard times), called before interrupts
+    //  are enabled.
+    void radio_baud();
+#endif
+
+    // Reserve the TX ring for the frame and send the START flag byte
+    //  (or the API frame header).  length is the number of msg bytes
+    //  that will follow (less the CRC trailer).  With COMM_CLASS_COBS
+    //  the exact size is known (and reserved) in end_frame().
+    void begin_frame(uint8_t const &length, uint16_t const &dest);
+
+    // Send the CRC trailer and the END flag byte (or the API frame
+    //  checksum).
+    void end_frame();
+
+    // Reserve count bytes of the UART TX ring, or count the frame as
+    //  rejected.
+    bool reserve_frame(uint16_t const &count);
+
+    // Byte stuff and send this byte (adds it to _TxCrc).  With
+    //  COMM_CLASS_COBS the byte is held in _TxFrame until end_frame().
+    //  Does nothing if begin_frame() could not reserve the frame.
     void byte_stuff(uint8_t const &A);
 
-    //##############################
-    // State machine for tx/rx
-    //##############################
-    typedef void (comm_class::*STATE)(uint8_t *msg, uint8_t &pos);
-    void TRAN(STATE target) {
-        state = static_cast<STATE>(target);
-    }
-    void process(uint8_t *A, uint8_t &B) { (this->*state)(A,B); }
-    STATE state;
+#if UART_MPCM && COMM_CLASS_COBS
+    // Address character of the frame held in _TxFrame
+    uint8_t _TxMpcmAddress;
+#endif
 
+    // The current frame did not fit in the UART TX ring
+    bool _TxRejected;
+    uint16_t _TxRejectCount;
 
-    // Search for a flag byte in the current msg
-    void STATE_decode__search_for_flag_byte(uint8_t *msg, uint8_t &pos);
+#if COMM_CLASS_COBS
+    // The msg being sent.  COBS needs to know where the next 0x00 is
+    //  before it can send a block.
+    uint8_t _TxFrame[UART_RX_FRAME_SIZE];
+    uint8_t _TxFrameLen;
+#endif
 
-    // Flag byte found, seek more flag bytes or additional bytes in the msg.
-    void STATE_decode__flag_byte_found(uint8_t *msg, uint8_t &pos);
+#if XBEE_API_MODE
+    // XBee API frame types
+    static const uint8_t XBEE_TX_REQUEST_16 = 0x01;
+    static const uint8_t XBEE_AT_COMMAND = 0x08;
+    static const uint8_t XBEE_RX_PACKET_64 = 0x80;
+    static const uint8_t XBEE_RX_PACKET_16 = 0x81;
+    static const uint8_t XBEE_TX_STATUS = 0x89;
 
-    // Collect the current msg until reaching a flag byte.
-    void STATE_decode__collect_msg(uint8_t *msg, uint8_t &pos);
+    // Handle a complete API frame from the UART class.
+    void api_frame_to_msg(uint8_t const *frame, uint8_t const &length);
 
-    // Stuffed byte found, byte thin the next byte.
-    void STATE_decode__byte_thin(uint8_t *msg, uint8_t &pos);
+    // Next frame ID (never ZERO, ZERO disables the TX status frame)
+    uint8_t next_frame_id();
 
-    UartBaseClass _UartClass;
+    uint8_t _TxChecksum;
+    uint8_t _TxFrameId;
+    uint16_t _TxStatusErrorCount;
+#endif
+
+    static void count_error(uint16_t &counter)
+    {
+        if (counter < 0xFFFF) counter++;
+    }
+
+    crc_class::crc_t _TxCrc;
+
+    uint16_t _RxCrcErrorCount;
+    uint16_t _RxLengthErrorCount;
+    uint16_t _RxInvalidCount;
+    uint16_t _RxFilteredCount;
+
+    // Sum of the rejected frame counters (wraps).  The counters that
+    //  moved since the last sample are folded into the error rate.
+    uint16_t rx_error_total();
+    void error_rate_sample(bool const &good);
+
+    // Error rate, 0 to 0xFFFF (see getErrorRate())
+    uint16_t _RxErrorRate;
+    // rx_error_total() at the last sample
+    uint16_t _RxErrorTotal;
+
+#if COMM_CLASS_RELAY
+    // Strip the relay header, drop copies already seen and (relay
+    //  nodes) hold the msg to be repeated.
+    void relay_to_msg(comm_class_span_struct const &msg);
+
+    // Has this (source, sequence) been seen?  Remembers it if not.
+    bool relay_seen(uint8_t const &source, uint16_t const &seq);
+
+    // Relay header of the next frame.  begin_frame() uses
+    //  the held msg's header when _TxRelayForward is set.  The
+    //  sequence is started on this node's first msg, by then the
+    //  random numbers have had the timers stirred in.
+    uint16_t _TxRelaySeq;
+    bool _TxRelaySeqStarted;
+    bool _TxRelayForward;
+
+    // Recently seen (source, sequence), oldest overwritten first
+    static const uint8_t RELAY_SEEN_SIZE = 16;
+    uint8_t _RelaySeenSource[RELAY_SEEN_SIZE];
+    uint16_t _RelaySeenSeq[RELAY_SEEN_SIZE];
+    uint8_t _RelaySeenCount;
+    uint8_t _RelaySeenNext;
+
+    // Msg waiting to be repeated (without its CRC).  Written by the RX
+    //  side only while _RelayPending is false.
+    static const uint8_t RELAY_FRAME_SIZE = UART_RX_FRAME_SIZE - COMM_CLASS_RELAY_HEADER;
+    uint8_t _RelayFrame[RELAY_FRAME_SIZE];
+    uint8_t _RelayLength;
+    uint8_t _RelaySource;
+    uint16_t _RelaySeq;
+    uint8_t _RelayHops;
+    volatile bool _RelayPending;
+
+    uint16_t _RelayedCount;
+    uint16_t _RelayDuplicateCount;
+    uint16_t _RelayBusyCount;
+#endif
 
-    static const uint8_t MAX_SEARCH_BUFFER_SIZE = 32;
+#if !UART_RX_DEFRAMER
+    // In place decode of the UART RX ring.
+    //  _RxScanPos  - Ring offset of the next byte to examine.
+    //  _RxFrameLen - Number of byte thinned bytes written back
+    //                 from ring offset 0.
+    uint8_t _RxScanPos;
+    uint8_t _RxFrameLen;
+    bool    _RxInFrame;
+    bool    _RxEscape;
+    crc_class::crc_t _RxCrc;
+    uint16_t _RxEscapeErrorCount;
+    uint16_t _RxResyncCount;
+#endif
+
+    UartBaseClass _UartClass;
 };
 
 
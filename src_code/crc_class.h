@@ -0,0 +1,93 @@
+#ifndef _CRC_CLASS_H_
+#define _CRC_CLASS_H_
+
+/****************************************************
+    CRC Class
+
+    File:   crc_class.h
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    crc_class.h file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file implements the table driven CRC used to protect comm
+     class frames.  The lookup tables live in flash.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+/*
+    COMM_CLASS_CRC selects the CRC trailer of comm class frames.
+        0  - No CRC
+        8  - CRC-8  (poly 0x07, init 0x00)
+        16 - CRC-16 (CCITT, poly 0x1021, init 0xFFFF)
+    The CRC is sent MSB first and has no final XOR, so the CRC of a
+    frame including its CRC trailer is zero.  The receiver can run
+    the CRC over every byte without knowing where the trailer starts.
+*/
+#ifndef COMM_CLASS_CRC
+    #define COMM_CLASS_CRC 0
+#endif
+
+#if (COMM_CLASS_CRC != 0) && (COMM_CLASS_CRC != 8) && (COMM_CLASS_CRC != 16)
+    #error "COMM_CLASS_CRC must be 0, 8 or 16"
+#endif
+
+class crc_class
+{
+public:
+#if (COMM_CLASS_CRC == 16)
+    typedef uint16_t crc_t;
+    static const crc_t INIT = 0xFFFF;
+    static const uint8_t LENGTH = 2;
+#else
+    typedef uint8_t crc_t;
+    static const crc_t INIT = 0x00;
+    static const uint8_t LENGTH = (COMM_CLASS_CRC == 8) ? 1 : 0;
+#endif
+
+    // Add a byte to the CRC
+    static inline crc_t update(crc_t const &crc, uint8_t const &data)
+    {
+#if (COMM_CLASS_CRC == 16)
+        return (crc << 8) ^ pgm_read_word(&CRC16_TABLE[(uint8_t)(crc >> 8) ^ data]);
+#elif (COMM_CLASS_CRC == 8)
+        return pgm_read_byte(&CRC8_TABLE[crc ^ data]);
+#else
+        (void)data;
+        return crc;
+#endif
+    }
+
+private:
+#if (COMM_CLASS_CRC == 16)
+    static const uint16_t CRC16_TABLE[256] PROGMEM;
+#elif (COMM_CLASS_CRC == 8)
+    static const uint8_t CRC8_TABLE[256] PROGMEM;
+#endif
+};
+
+#endif
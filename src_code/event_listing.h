@@ -35,9 +35,24 @@
     2014 Aug 05  James Stokebrand   Initial creation.
     2014 Aug 06  James Stokebrand   Updated to separate hardware with
                                       Possible events
+    2026 Oct 18  James Stokebrand   Events may carry a handle to a
+                                      variable length payload block
+                                      from the event pool.
+    2026 Oct 18  James Stokebrand   Added the absolute color events.
+    2026 Oct 18  James Stokebrand   Added E_SET_GROUPS.
+    2026 Oct 18  James Stokebrand   Added the address discovery events.
+    2026 Oct 18  James Stokebrand   Added the node status events.
+    2026 Oct 18  James Stokebrand   Added the link statistics events.
+    2026 Oct 18  James Stokebrand   Added E_UART_RELAY_PENDING.
+    2026 Oct 18  James Stokebrand   E_STATS_REQUEST takes the STATS page.
+    2026 Oct 18  James Stokebrand   Added E_UART_RX_FRAME_END.
 
 *****************************************************/
 
+#ifndef _EVENT_POOL_H_
+#include "event_pool.h"
+#endif
+
 typedef enum {
     // Buttons
      E_BUTTON_01        = 0x00
@@ -103,6 +118,12 @@ typedef enum {
     ,E_ENTER_STATE        // 0x0A
     ,E_EXIT_STATE         // 0x0B
 
+    // USART specific (continued)
+    ,E_UART_RX_FRAME_EVENT // 0x0C
+    ,E_UART_RELAY_PENDING  // 0x0D  comm class holds a msg to relay
+    ,E_UART_RX_FRAME_END   // 0x0E  data is the low byte of Millis() at the
+                           //        end of the frame whose events follow
+
     // RGB Controller specific
     //  RGB Color methods
     ,E_SET_RED             = 0x10
@@ -136,6 +157,22 @@ typedef enum {
     ,E_ENABLE_STATUS_LED  // 0x25
     ,E_DISABLE_STATUS_LED // 0x26
 
+    //  Absolute color (the payload carries the color, see
+    //   rgb_node_state_machine::set_absolute_color())
+    ,E_SET_RGB_VALUE      // 0x27
+    ,E_SET_HSL_VALUE      // 0x28
+    ,E_SET_RGB_FADE       // 0x29
+
+    //  Newest realtime stream color is waiting in the comm class
+    //   (see comm_class::takeRealtimeColor())
+    ,E_SET_RGB_REALTIME   // 0x2A
+
+    //  Reliable transfers (see comm_class TRANSFER/NACK msgs)
+    ,E_TRANSFER_SEGMENT   // 0x2B  data is the segment index, payload the segment
+    ,E_TRANSFER_COMPLETE  // 0x2C  data is the transfer ID
+    ,E_TRANSFER_POLL      // 0x2D  data is the transfer ID, send a NACK in this node's slot
+    ,E_TRANSFER_NACK      // 0x2E  data is the node address, payload the transfer ID and missing map
+
     // RGB Node specific
     //  RGB Color
     ,E_LED_RED_PWM         = 0x30
@@ -150,6 +187,18 @@ typedef enum {
     ,E_LED_DELAY_VALUE    // 0x37
     ,E_LED_FADE_VALUE     // 0x38
 
+    // RGB Node maintenance
+    //  RC oscillator calibration (see osccal_class)
+    ,E_OSC_CALIBRATE       = 0x39  // data is the node address, start calibrating
+    ,E_OSC_SYNC           // 0x3A  payload is the burst ticks (2 bytes) and bytes
+    ,E_OSC_SAVE           // 0x3B  data is the node address, save OSCCAL and stop
+    //  Group membership (see comm_class::isAddressed())
+    ,E_SET_GROUPS         // 0x3C  data is the node address, payload the group mask
+    //  Address discovery (see comm_class DISCOVER/ANNOUNCE/ASSIGN msgs)
+    ,E_DISCOVER           // 0x3D  data is the number of time slots
+    ,E_ASSIGN_ADDRESS     // 0x3E  data is the new node address
+    ,E_NODE_ANNOUNCE      // 0x3F  data is the node address, payload the unique ID
+
     // SPI Baseline
     ,E_SPI_BYTE_COMPLETE   = 0x40
     ,E_SPI_MSG_COMPLETE   // 0x41 Notified when the SPI queue is empty (IE msg complete)
@@ -194,6 +243,12 @@ typedef enum {
     ,E_BLINKM_GET_FIRMWARE_MINOR_VERSION_RESPONSE
     ,E_BLINKM_GET_FIRMWARE_VERSION_ERROR
 
+    // RGB Node status (see comm_class STATUS msg)
+    ,E_STATUS_REQUEST      = 0x90  // data is the node address, send a STATUS msg
+    ,E_NODE_STATUS        // 0x91  data is the node address, payload the status
+    ,E_STATS_REQUEST      // 0x92  data is the node address, payload the page (optional), send a STATS msg
+    ,E_NODE_STATS         // 0x93  data is the node address, payload the page and its statistics
+
     // Must remain the last item on the list
     ,E_LAST_INPUT_EVENT
 } E_InputEvent;
@@ -207,10 +262,26 @@ public:
     : aHardware(A)
     , anEvent(B)
     , theData(C)
+    , thePayload(event_pool_class::INVALID_HANDLE)
     {}
 
-    virtual ~event_element_class() {}
+    event_element_class(event_element_class const &A)
+    : aHardware(A.aHardware)
+    , anEvent(A.anEvent)
+    , theData(A.theData)
+    , thePayload(A.thePayload)
+    {
+        // Copies share the payload block
+        event_pool_class::AddRef(thePayload);
+    }
+
+    virtual ~event_element_class()
+    {
+        event_pool_class::Release(thePayload);
+    }
 
+    // *NOTE* this only sets the event header.  The payload (if any)
+    //  is left untouched.
     void set(E_InputHardware const A, E_InputEvent const B, uint8_t const C=0)
     {
         aHardware = A;
@@ -223,6 +294,7 @@ public:
         set(A.get_current_hardware()
            ,A.get_current_event()
            ,A.get_current_data());
+        set_payload_handle_shared(A.thePayload);
     }
 
     void get(E_InputHardware &A, E_InputEvent &B, uint8_t &C)
@@ -234,7 +306,7 @@ public:
 
     void get(event_element_class &A)
     {
-        A.set(aHardware, anEvent, theData);
+        A.set(*this);
     }
 
     E_InputHardware get_current_hardware() const
@@ -267,10 +339,62 @@ public:
         theData = A;
     }
 
+    // 16 bit values are sent with the high byte in the data byte
+    //  followed by the low byte as a one byte payload.  This costs one
+    //  extra byte and 8 bit receivers still see the high byte.  Returns
+    //  false if the pool is exhausted, only the high byte is sent.
+    bool set_data16(uint16_t const &A)
+    {
+        theData = A >> 8;
+
+        uint8_t handle = event_pool_class::Alloc();
+        set_payload_handle(handle);
+        if (handle == event_pool_class::INVALID_HANDLE) return false;
+
+        event_pool_class::Data(handle)[0] = A & 0xFF;
+        event_pool_class::SetLength(handle, 1);
+        return true;
+    }
+
+    // A msg without the low byte is an 8 bit value.  Scale it so
+    //  0xFF becomes 0xFFFF.
+    uint16_t get_data16() const
+    {
+        if (get_payload_length() < 1) return theData * 257U;
+        return ((uint16_t)theData << 8) | get_payload()[0];
+    }
+
+    // Payload block carried with this event.
+    bool has_payload() const
+    {
+        return (thePayload != event_pool_class::INVALID_HANDLE);
+    }
+
+    uint8_t get_payload_length() const
+    {
+        if (!has_payload()) return 0;
+        return event_pool_class::Length(thePayload);
+    }
+
+    uint8_t const *get_payload() const
+    {
+        if (!has_payload()) return nullptr;
+        return event_pool_class::Data(thePayload);
+    }
+
+    // Attach a freshly allocated payload block to this event.  The
+    //  event takes over the reference returned by event_pool_class::Alloc()
+    void set_payload_handle(uint8_t const &A)
+    {
+        event_pool_class::Release(thePayload);
+        thePayload = A;
+    }
+
     bool operator == (event_element_class const &A) const {
         if ((A.get_current_hardware() == get_current_hardware()) &&
             (A.get_current_event()    == get_current_event())    &&
-            (A.get_current_data()     == get_current_data()))
+            (A.get_current_data()     == get_current_data())     &&
+            (A.thePayload             == thePayload))
         {
             return true;
         }
@@ -278,19 +402,13 @@ public:
     }
 
     bool operator != (event_element_class const &A) const {
-        if ((A.get_current_hardware() != get_current_hardware()) ||
-            (A.get_current_event()    != get_current_event())    ||
-            (A.get_current_data()     != get_current_data()))
-        {
-            return true;
-        }
-        return false;
+        return !(*this == A);
     }
 
     event_element_class& operator = (event_element_class const &A) {
         if (this != &A)
         {
-            set(A.aHardware,A.anEvent,A.theData);
+            set(A);
         }
         return *this;
     }
@@ -298,12 +416,23 @@ public:
     void clear()
     {
         set(E_LAST_HARDWARE_EVENT,E_LAST_INPUT_EVENT,0);
+        set_payload_handle(event_pool_class::INVALID_HANDLE);
     }
 
 private:
+    // Share the payload block of another event.
+    void set_payload_handle_shared(uint8_t const &A)
+    {
+        if (A == thePayload) return;
+        event_pool_class::AddRef(A);
+        event_pool_class::Release(thePayload);
+        thePayload = A;
+    }
+
     E_InputHardware aHardware;
     E_InputEvent anEvent;
     uint8_t theData;
+    uint8_t thePayload;
 };
 
 
@@ -0,0 +1,114 @@
+
+/****************************************************
+    Event Pool Class
+
+    File:   event_pool.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    event_pool.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file implements a statically allocated pool of fixed size
+     payload blocks.  Events that need more than the single data byte
+     carry a handle to one of these blocks.  Blocks are reference
+     counted so an event can be copied through the event queue
+     without copying the payload.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <util/atomic.h>
+
+#ifndef _EVENT_POOL_H_
+#include "event_pool.h"
+#endif
+
+event_pool_class::event_pool_block_struct event_pool_class::_Blocks[event_pool_class::BLOCK_COUNT];
+
+volatile uint8_t event_pool_class::_InUse = 0;
+uint8_t event_pool_class::_HighWaterValue = 0;
+uint16_t event_pool_class::_ExhaustedCount = 0;
+
+uint8_t event_pool_class::Alloc()
+{
+    uint8_t handle = INVALID_HANDLE;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uint8_t jj = 0;
+        while (jj < BLOCK_COUNT)
+        {
+            if (_Blocks[jj]._RefCount == 0)
+            {
+                // Found a free block
+                _Blocks[jj]._RefCount = 1;
+                _Blocks[jj]._Length = 0;
+                handle = jj;
+
+                jj = BLOCK_COUNT; // break out of the while loop
+            }
+            else
+            {
+                // Keep movin'
+                jj++;
+            }
+        }
+
+        if (handle == INVALID_HANDLE)
+        {
+            // Pool is exhausted ... count it.
+            if (_ExhaustedCount < 0xFFFF) _ExhaustedCount++;
+        }
+        else
+        {
+            _InUse++;
+            if (_InUse > _HighWaterValue) _HighWaterValue = _InUse;
+        }
+    }
+
+    return handle;
+}
+
+void event_pool_class::AddRef(uint8_t const &handle)
+{
+    if (handle >= BLOCK_COUNT) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _Blocks[handle]._RefCount++;
+    }
+}
+
+void event_pool_class::Release(uint8_t const &handle)
+{
+    if (handle >= BLOCK_COUNT) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (_Blocks[handle]._RefCount)
+        {
+            _Blocks[handle]._RefCount--;
+
+            // Last reference ... block is back in the pool.
+            if (_Blocks[handle]._RefCount == 0) _InUse--;
+        }
+    }
+}
+
@@ -0,0 +1,118 @@
+#ifndef _EVENT_POOL_H_
+#define _EVENT_POOL_H_
+
+/****************************************************
+    Event Pool Class
+
+    File:   event_pool.h
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    event_pool.h file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file implements a statically allocated pool of fixed size
+     payload blocks.  Events that need more than the single data byte
+     carry a handle to one of these blocks.  Blocks are reference
+     counted so an event can be copied through the event queue
+     without copying the payload.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <avr/io.h>
+
+// Number of payload blocks in the pool
+#ifndef EVENT_POOL_BLOCK_COUNT
+    #define EVENT_POOL_BLOCK_COUNT 6
+#endif
+
+// Size (in bytes) of each payload block
+#ifndef EVENT_POOL_BLOCK_SIZE
+    #define EVENT_POOL_BLOCK_SIZE 16
+#endif
+
+#if (EVENT_POOL_BLOCK_COUNT >= 0xFF)
+    #error "Too many event pool blocks, 0xFF is reserved for the invalid handle"
+#endif
+
+/*
+    NOTE NOTE NOTE !!!
+    All methods are ISR safe.  Blocks are allocated by the comm class
+    from the UART ISR and released from the main loop.
+*/
+
+class event_pool_class
+{
+public:
+    // Handle value used when an event carries no payload
+    static const uint8_t INVALID_HANDLE = 0xFF;
+
+    static const uint8_t BLOCK_COUNT = EVENT_POOL_BLOCK_COUNT;
+    static const uint8_t BLOCK_SIZE = EVENT_POOL_BLOCK_SIZE;
+
+    // Allocate a block.  The block is returned with a reference count
+    //  of one.  Returns INVALID_HANDLE if the pool is exhausted.
+    static uint8_t Alloc();
+
+    // Add/Release a reference to the block.  The block returns to
+    //  the pool when the last reference is released.
+    static void AddRef(uint8_t const &handle);
+    static void Release(uint8_t const &handle);
+
+    // Access the payload of the block.
+    static inline uint8_t *Data(uint8_t const &handle)
+    {
+        return _Blocks[handle]._Data;
+    }
+
+    static inline uint8_t Length(uint8_t const &handle)
+    {
+        return _Blocks[handle]._Length;
+    }
+
+    static inline void SetLength(uint8_t const &handle, uint8_t const &len)
+    {
+        _Blocks[handle]._Length = len;
+    }
+
+    // Pool statistics
+    static inline uint8_t InUse() { return _InUse; }
+    static inline uint8_t HighWaterMark() { return _HighWaterValue; }
+    static inline uint16_t ExhaustedCount() { return _ExhaustedCount; }
+
+private:
+    struct event_pool_block_struct {
+        volatile uint8_t _RefCount;
+        uint8_t          _Length;
+        uint8_t          _Data[BLOCK_SIZE];
+    };
+
+    static event_pool_block_struct _Blocks[BLOCK_COUNT];
+
+    static volatile uint8_t _InUse;
+    static uint8_t _HighWaterValue;
+    static uint16_t _ExhaustedCount;
+};
+
+#endif
+
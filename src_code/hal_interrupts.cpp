@@ -29,6 +29,8 @@
      When         Who                Description of change
     -----------  ----------         ------------------------
     2014 Sep 24  James Stokebrand   Initial creation.
+    2026 Oct 18  James Stokebrand   Timer2 (PWM) ISR can be interrupted.
+    2026 Oct 18  James Stokebrand   Limits of the nested PWM ISR spelled out.
 
 *****************************************************/
 
@@ -158,10 +160,35 @@ TIMER2_interrupt_subject::TIMER2_interrupt_subject()
     pINTR_handler = this;
 };
 
+/*
+    The PWM observers run every PWM_OCR*8 cycles and take a good part
+    of that.  Run them with interrupts enabled so the UART RX ISR gets
+    in before the next byte overruns UDR0.  This interrupt is masked
+    while its observers run so it can never nest (a compare match in
+    the meantime is taken as soon as it is unmasked).
+
+    That only holds while each ISR that nests here (UART RX and TX,
+    timer0) is shorter than a PWM period, and the observers plus the
+    nested ISRs fit in one.  Otherwise a second compare match comes in
+    while one is still pending and a PWM step is lost.  The longest
+    is the UART RX ISR handing over a whole frame.  UDR0 holds two
+    bytes, so RX bytes are only lost (getOverrunCount()) when
+    interrupts stay off for about two character times.  See
+    host/sim_isr_load.cpp for both under PWM and UART load.
+
+    NOTE: ISRs that can now interrupt the observers must not write the
+    LED ports.
+*/
 ISR(TIMER2_COMPA_vect)
 {
+    TIMSK2 &= ~(1<<OCIE2A);
+    sei();
+
     TIMER2_interrupt_subject::pINTR_handler->Notify(
             TIMER2_interrupt_subject::pINTR_handler->pwmCount++);
+
+    cli();
+    TIMSK2 |= (1<<OCIE2A);
 }
 
 // SPI
@@ -0,0 +1,11 @@
+#ifndef _HOST_AVR_BOOT_H_
+#define _HOST_AVR_BOOT_H_
+
+// Host stand-in for <avr/boot.h>
+
+#include <stdint.h>
+
+#define SIGRD 5
+uint8_t boot_signature_byte_get(uint16_t address);
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef _HOST_AVR_EEPROM_H_
+#define _HOST_AVR_EEPROM_H_
+
+// Host stand-in for <avr/eeprom.h>.  EEMEM variables are only used
+//  for their address, the bytes live in the EEPROM of the node being
+//  run (see host_node.h).  Unwritten bytes read 0xFF.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define EEMEM
+
+uint8_t eeprom_read_byte(uint8_t const *address);
+void eeprom_update_byte(uint8_t *address, uint8_t value);
+uint16_t eeprom_read_word(uint16_t const *address);
+void eeprom_update_word(uint16_t *address, uint16_t value);
+void eeprom_read_block(void *dest, void const *source, size_t length);
+void eeprom_update_block(void const *source, void *dest, size_t length);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef _HOST_AVR_INTERRUPT_H_
+#define _HOST_AVR_INTERRUPT_H_
+
+// Host stand-in for <avr/interrupt.h>.  ISRs are plain functions, a
+//  host program calls them (or the class methods they call) itself.
+
+#include <avr/io.h>
+
+#define ISR(vector, ...) extern "C" void vector(void); extern "C" void vector(void)
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define cli() do {} while (0)
+#define sei() do {} while (0)
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef _HOST_AVR_IO_H_
+#define _HOST_AVR_IO_H_
+
+/****************************************************
+    Host stand-in for <avr/io.h>
+
+    The I/O registers the firmware uses are members of a register
+     file.  host_avr points at the register file of the node being
+     run, so a host program can run several nodes (see host_node.h).
+     Only the bits the firmware uses are defined.
+*****************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+struct host_avr_regs
+{
+    volatile uint8_t UCSR0A, UCSR0B, UCSR0C, UDR0, UBRR0H, UBRR0L;
+    volatile uint8_t PRR, TIMSK2, TIFR2, TCCR2A, TCCR2B, OCR2A, TCNT2;
+    volatile uint8_t PCMSK0, PCMSK1, PCMSK2, PCICR, EICRA, SPDR;
+    volatile uint8_t PINB, PORTB, DDRB, PINC, PORTC, DDRC, PIND, PORTD, DDRD;
+    volatile uint8_t OSCCAL, TCCR1A, TCCR1B, TIFR1, TIMSK1, SREG;
+    volatile uint8_t EEARL, EEARH, EEDR, EECR;
+    volatile uint8_t TCCR0A, TCCR0B, TCNT0, TIMSK0, TIFR0, OCR0A;
+    volatile uint16_t TCNT1, ICR1, OCR1A;
+};
+
+extern host_avr_regs *host_avr;
+
+#define UCSR0A (host_avr->UCSR0A)
+#define UCSR0B (host_avr->UCSR0B)
+#define UCSR0C (host_avr->UCSR0C)
+#define UDR0   (host_avr->UDR0)
+#define UBRR0H (host_avr->UBRR0H)
+#define UBRR0L (host_avr->UBRR0L)
+#define PRR    (host_avr->PRR)
+#define TIMSK2 (host_avr->TIMSK2)
+#define TIFR2  (host_avr->TIFR2)
+#define TCCR2A (host_avr->TCCR2A)
+#define TCCR2B (host_avr->TCCR2B)
+#define OCR2A  (host_avr->OCR2A)
+#define TCNT2  (host_avr->TCNT2)
+#define PCMSK0 (host_avr->PCMSK0)
+#define PCMSK1 (host_avr->PCMSK1)
+#define PCMSK2 (host_avr->PCMSK2)
+#define PCICR  (host_avr->PCICR)
+#define EICRA  (host_avr->EICRA)
+#define SPDR   (host_avr->SPDR)
+#define PINB   (host_avr->PINB)
+#define PORTB  (host_avr->PORTB)
+#define DDRB   (host_avr->DDRB)
+#define PINC   (host_avr->PINC)
+#define PORTC  (host_avr->PORTC)
+#define DDRC   (host_avr->DDRC)
+#define PIND   (host_avr->PIND)
+#define PORTD  (host_avr->PORTD)
+#define DDRD   (host_avr->DDRD)
+#define OSCCAL (host_avr->OSCCAL)
+#define TCCR1A (host_avr->TCCR1A)
+#define TCCR1B (host_avr->TCCR1B)
+#define TIFR1  (host_avr->TIFR1)
+#define TIMSK1 (host_avr->TIMSK1)
+#define SREG   (host_avr->SREG)
+#define EEARL  (host_avr->EEARL)
+#define EEARH  (host_avr->EEARH)
+#define EEDR   (host_avr->EEDR)
+#define EECR   (host_avr->EECR)
+#define TCCR0A (host_avr->TCCR0A)
+#define TCCR0B (host_avr->TCCR0B)
+#define TCNT0  (host_avr->TCNT0)
+#define TIMSK0 (host_avr->TIMSK0)
+#define TIFR0  (host_avr->TIFR0)
+#define OCR0A  (host_avr->OCR0A)
+#define TCNT1  (host_avr->TCNT1)
+#define ICR1   (host_avr->ICR1)
+#define OCR1A  (host_avr->OCR1A)
+
+#define RAMEND 0x8FF
+
+// UCSR0A
+#define RXC0   7
+#define TXC0   6
+#define UDRE0  5
+#define FE0    4
+#define DOR0   3
+#define UPE0   2
+#define U2X0   1
+#define MPCM0  0
+// UCSR0B
+#define RXCIE0 7
+#define TXCIE0 6
+#define UDRIE0 5
+#define RXEN0  4
+#define TXEN0  3
+#define UCSZ02 2
+#define RXB80  1
+#define TXB80  0
+// UCSR0C
+#define UCSZ01 2
+#define UCSZ00 1
+// PRR
+#define PRTWI    7
+#define PRTIM2   6
+#define PRTIM0   5
+#define PRTIM1   3
+#define PRSPI    2
+#define PRUSART0 1
+#define PRADC    0
+// Timer 2
+#define OCIE2A 1
+#define OCF2A  1
+#define TOV2   0
+#define WGM21  1
+#define CS22   2
+#define CS21   1
+#define CS20   0
+// Timer 1
+#define ICNC1  7
+#define ICES1  6
+#define ICF1   5
+#define TOV1   0
+#define CS12   2
+#define CS11   1
+#define CS10   0
+// Timer 0
+#define OCIE0A 1
+#define TOIE0  0
+#define OCF0A  1
+#define TOV0   0
+#define WGM01  1
+#define CS02   2
+#define CS01   1
+#define CS00   0
+// Pin change and external interrupts
+#define PCIE2  2
+#define PCIE1  1
+#define PCIE0  0
+#define ISC10  2
+// EEPROM
+#define EEMPE  2
+#define EEPE   1
+#define EERE   0
+// Port pins
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+#define _BV(b) (1 << (b))
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef _HOST_AVR_PGMSPACE_H_
+#define _HOST_AVR_PGMSPACE_H_
+
+// Host stand-in for <avr/pgmspace.h>.  Flash tables are ordinary data.
+
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(uint8_t const *)(address))
+#define pgm_read_word(address) (*(uint16_t const *)(address))
+
+#endif
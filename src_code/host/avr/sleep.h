@@ -0,0 +1,21 @@
+#ifndef _HOST_AVR_SLEEP_H_
+#define _HOST_AVR_SLEEP_H_
+
+// Host stand-in for <avr/sleep.h>.  The host never sleeps.
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE         0
+#define SLEEP_MODE_ADC          1
+#define SLEEP_MODE_PWR_DOWN     2
+#define SLEEP_MODE_PWR_SAVE     3
+#define SLEEP_MODE_STANDBY      6
+#define SLEEP_MODE_EXT_STANDBY  7
+
+#define set_sleep_mode(mode) ((void)(mode))
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu()
+#define sleep_bod_disable()
+
+#endif
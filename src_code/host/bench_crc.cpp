@@ -0,0 +1,134 @@
+/****************************************************
+    CRC Benchmark
+
+    File:   bench_crc.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    bench_crc.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file measures what the frame CRC (COMM_CLASS_CRC) costs per
+     byte on the PC:  crc_class::update() over a block of bytes, and
+     the whole receive path (RX ISR frame assembler, which runs the
+     CRC, plus decode) for universe frames.  Built once per CRC width
+     so the runs can be compared with each other and with no CRC.
+     Also prints the trailer's share of the airtime.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <stdio.h>
+#include <chrono>
+
+#include "host_node.h"
+
+#ifndef _COMM_CLASS_H_
+#include "comm_class.h"
+#endif
+
+static const uint32_t BLOCK_BYTES = 65536;
+static const uint16_t FRAMES = 2000;
+static const uint8_t RUNS = 20;
+
+// comm_class takes counts by reference, this needs storage.
+static uint8_t const UNIVERSE_SLOTS = comm_class::MAX_UNIVERSE_SLOTS;
+
+static uint8_t block[BLOCK_BYTES];
+
+// Keeps the compiler from dropping the CRC loop
+volatile crc_class::crc_t crc_sink;
+
+int main()
+{
+    printf("COMM_CLASS_CRC %d (%u byte trailer)\n", COMM_CLASS_CRC, (unsigned)crc_class::LENGTH);
+
+    // crc_class::update() alone
+    for (uint32_t jj=0; jj<BLOCK_BYTES; jj++) block[jj] = (uint8_t)(jj * 31 + (jj >> 8));
+
+    double best_ns = 1e30;
+    for (uint8_t run=0; run<RUNS; run++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        crc_class::crc_t crc = crc_class::INIT;
+        for (uint32_t jj=0; jj<BLOCK_BYTES; jj++) crc = crc_class::update(crc, block[jj]);
+        crc_sink = crc;
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        if (ns < best_ns) best_ns = ns;
+    }
+    printf("update():      %6.2f ns/byte\n", best_ns / BLOCK_BYTES);
+
+    // Whole receive path for universe frames
+    host_node controller_node;
+    controller_node.select();
+    comm_class controller;
+    controller_node.attach_uart();
+
+    host_node rx_node;
+    rx_node.select();
+    comm_class receiver;
+    rx_node.attach_uart();
+    host_sink sink;
+    receiver.Attach(&sink);
+    receiver.setNodeAddress(1);
+
+    host_wire wire;
+    uint8_t rgb[3 * UNIVERSE_SLOTS];
+    for (uint16_t ii=0; ii<FRAMES; ii++)
+    {
+        for (uint8_t jj=0; jj<sizeof(rgb); jj++) rgb[jj] = (uint8_t)(ii * 7 + jj * 13);
+        controller_node.select();
+        controller.encode_universe(1, rgb, UNIVERSE_SLOTS);
+        controller_node.drain(wire);
+    }
+
+    best_ns = 1e30;
+    uint32_t decoded = 0;
+    for (uint8_t run=0; run<RUNS; run++)
+    {
+        decoded = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t jj=0; jj<wire.size(); jj++)
+        {
+            rx_node.rx(wire[jj]);
+            if (sink.rx_pending)
+            {
+                sink.rx_pending = false;
+                receiver.receive();
+                decoded += sink.events.size();
+                sink.events.clear();
+            }
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        if (ns < best_ns) best_ns = ns;
+    }
+
+    double bytes_per_frame = (double)wire.size() / FRAMES;
+    printf("receive path:  %6.2f ns/byte, %6.0f ns/frame (%.1f bytes/frame, %u of %u decoded)\n",
+           best_ns / wire.size(), best_ns / FRAMES, bytes_per_frame,
+           (unsigned)decoded, (unsigned)FRAMES);
+    printf("trailer:       %6.1f%% of the universe frame airtime\n",
+           100.0 * crc_class::LENGTH / bytes_per_frame);
+    return 0;
+}
@@ -0,0 +1,159 @@
+/****************************************************
+    Decode Benchmark
+
+    File:   bench_decode.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    bench_decode.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file measures how fast the comm class decodes frames on the
+     PC.  A controller node encodes a run of frames, the bytes are fed
+     through the RX ISR of a second node one at a time and receive()
+     is called whenever the main loop would.  Built twice, for the in
+     place RX ring decoder (UART_RX_DEFRAMER=0) and for the RX ISR
+     frame assembler, so the two can be compared.  PC timings only
+     rank the decoders, they are not AVR cycle counts.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <stdio.h>
+#include <chrono>
+
+#include "host_node.h"
+
+#ifndef _COMM_CLASS_H_
+#include "comm_class.h"
+#endif
+
+static const uint16_t FRAMES = 2000;
+static const uint8_t RUNS = 20;
+
+// comm_class takes counts by reference, these need storage.
+static uint8_t const BATCH_EVENTS = comm_class::MAX_BATCH_EVENTS;
+static uint8_t const UNIVERSE_SLOTS = comm_class::MAX_UNIVERSE_SLOTS;
+
+enum E_Workload { E_SINGLE, E_BATCH, E_UNIVERSE, E_UNIVERSE_STUFFED };
+static const char *WORKLOAD_NAME[] = { "single event", "batch", "universe", "universe, all stuffed" };
+
+// Encode FRAMES frames of the workload on the controller node, all
+//  for node 1.
+static void make_frames(host_node &node, comm_class &comm, E_Workload const &workload, host_wire &wire)
+{
+    uint8_t rgb[3 * UNIVERSE_SLOTS];
+    event_element_class batch[BATCH_EVENTS];
+
+    for (uint16_t ii=0; ii<FRAMES; ii++)
+    {
+        node.select();
+        switch (workload)
+        {
+        case E_SINGLE:
+            comm.encode(event_element_class(E_RGB_CONTROLLER, E_SET_RED, 1));
+        break;
+        case E_BATCH:
+            for (uint8_t jj=0; jj<BATCH_EVENTS; jj++)
+            {
+                batch[jj].set(E_RGB_CONTROLLER, E_SET_GREEN, 1);
+            }
+            comm.encode(batch, BATCH_EVENTS);
+        break;
+        case E_UNIVERSE:
+        case E_UNIVERSE_STUFFED:
+            for (uint8_t jj=0; jj<sizeof(rgb); jj++)
+            {
+                rgb[jj] = (workload == E_UNIVERSE) ? (uint8_t)(ii * 7 + jj * 13) : UartBaseClass::COMM_CLASS_FLAG_BYTE;
+            }
+            comm.encode_universe(1, rgb, UNIVERSE_SLOTS);
+        break;
+        }
+        node.drain(wire);
+    }
+}
+
+int main()
+{
+    host_node controller_node;
+    controller_node.select();
+    comm_class controller;
+    controller_node.attach_uart();
+
+    host_node rx_node;
+    rx_node.select();
+    comm_class receiver;
+    rx_node.attach_uart();
+    host_sink sink;
+    receiver.Attach(&sink);
+    receiver.setNodeAddress(1);
+
+    printf("%s, BAUD %lu, RX ring %u\n",
+           UART_RX_DEFRAMER ? "RX ISR frame assembler" : "In place RX ring decoder",
+           (unsigned long)BAUD, (unsigned)UART_RX0_BUFFER_SIZE);
+    printf("%-22s %8s %8s %10s %12s %12s %8s\n",
+           "workload", "frames", "bytes", "ns/frame", "frames/s", "link fr/s", "lost");
+
+    for (uint8_t workload=E_SINGLE; workload<=E_UNIVERSE_STUFFED; workload++)
+    {
+        host_wire wire;
+        make_frames(controller_node, controller, (E_Workload)workload, wire);
+
+        uint32_t decoded = 0;
+        double best_ns = 1e30;
+        for (uint8_t run=0; run<RUNS; run++)
+        {
+            uint32_t events = 0;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (size_t jj=0; jj<wire.size(); jj++)
+            {
+                rx_node.rx(wire[jj]);
+                if (sink.rx_pending)
+                {
+                    // The main loop gets the notification.
+                    sink.rx_pending = false;
+                    receiver.receive();
+                    events += sink.events.size();
+                    sink.events.clear();
+                }
+            }
+            std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+            double ns = std::chrono::duration<double, std::nano>(end - start).count();
+            if (ns < best_ns) best_ns = ns;
+            decoded = events;
+        }
+
+        // One event per single/universe frame, a batch carries several.
+        uint32_t frames = (workload == E_BATCH) ? decoded / BATCH_EVENTS : decoded;
+        double ns_per_frame = best_ns / FRAMES;
+        printf("%-22s %8u %8u %10.0f %12.0f %12.0f %8u\n",
+               WORKLOAD_NAME[workload], (unsigned)FRAMES, (unsigned)(wire.size() / FRAMES),
+               ns_per_frame, 1e9 / ns_per_frame,
+               1e6 / ((double)host_airtime_us(wire.size()) / FRAMES),
+               (unsigned)(FRAMES - frames));
+    }
+
+    printf("rejected: crc %u, length %u, RX overflow %u\n",
+           receiver.getCrcErrorCount(), receiver.getLengthErrorCount(),
+           UartBaseClass::pUart->getRxOverflowCount());
+    return 0;
+}
@@ -0,0 +1,173 @@
+/****************************************************
+    Framing Benchmark
+
+    File:   bench_framing.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    bench_framing.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file measures the airtime and the decode time of COBS framed
+     msgs (COMM_CLASS_COBS) against byte stuffed (HDLC style) msgs, on
+     typical payloads and on payloads that are worst case for one or
+     the other.  Built twice, once for each framing, so the two can be
+     compared.  PC timings only rank the decoders, they are not AVR
+     cycle counts.
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <stdio.h>
+#include <chrono>
+
+#include "host_node.h"
+
+#ifndef _COMM_CLASS_H_
+#include "comm_class.h"
+#endif
+
+static const uint16_t FRAMES = 2000;
+static const uint8_t RUNS = 20;
+
+// comm_class takes counts by reference, these need storage.
+static uint8_t const UNIVERSE_SLOTS = comm_class::MAX_UNIVERSE_SLOTS;
+
+// Msg lengths before framing (type or event header plus the CRC)
+static const uint8_t EVENT_MSG_LENGTH = 3 + crc_class::LENGTH;
+static const uint8_t UNIVERSE_MSG_LENGTH = 3 + 3 * comm_class::MAX_UNIVERSE_SLOTS + crc_class::LENGTH;
+
+enum E_Workload { E_EVENT, E_COLORS, E_DARK, E_FLAGS, E_ZEROS, E_WHITE, E_NOISE, E_LAST_WORKLOAD };
+static const char *WORKLOAD_NAME[] = {
+    "single event", "universe, colors", "universe, dim", "universe, all 0x7E",
+    "universe, all 0x00", "universe, all 0xFF", "universe, random" };
+
+static uint32_t noise = 1;
+
+static uint8_t payload_byte(E_Workload const &workload, uint16_t const &frame, uint8_t const &jj)
+{
+    switch (workload)
+    {
+    case E_COLORS:
+        // Slowly changing colors, no byte values favored
+        return (uint8_t)(frame * 3 + jj * 29);
+    case E_DARK:
+        // Mostly off with a few dim slots (typical of a show)
+        return ((jj % 9) == 0) ? (uint8_t)(frame & 0x0F) : 0;
+    case E_FLAGS:
+        return UartBaseClass::COMM_CLASS_FLAG_BYTE;
+    case E_ZEROS:
+        return 0x00;
+    case E_WHITE:
+        return 0xFF;
+    default:
+        noise ^= noise << 13;
+        noise ^= noise >> 17;
+        noise ^= noise << 5;
+        return (uint8_t)noise;
+    }
+}
+
+// Encode FRAMES frames of the workload on the controller node, all
+//  for node 1.
+static void make_frames(host_node &node, comm_class &comm, E_Workload const &workload, host_wire &wire)
+{
+    uint8_t rgb[3 * UNIVERSE_SLOTS];
+
+    for (uint16_t ii=0; ii<FRAMES; ii++)
+    {
+        node.select();
+        if (workload == E_EVENT)
+        {
+            comm.encode(event_element_class(E_RGB_CONTROLLER, E_SET_RED, 1));
+        }
+        else
+        {
+            for (uint8_t jj=0; jj<sizeof(rgb); jj++) rgb[jj] = payload_byte(workload, ii, jj);
+            comm.encode_universe(1, rgb, UNIVERSE_SLOTS);
+        }
+        node.drain(wire);
+    }
+}
+
+int main()
+{
+    host_node controller_node;
+    controller_node.select();
+    comm_class controller;
+    controller_node.attach_uart();
+
+    host_node rx_node;
+    rx_node.select();
+    comm_class receiver;
+    rx_node.attach_uart();
+    host_sink sink;
+    receiver.Attach(&sink);
+    receiver.setNodeAddress(1);
+
+    printf("%s framing, BAUD %lu, CRC %u\n",
+           COMM_CLASS_COBS ? "COBS" : "Byte stuffed", (unsigned long)BAUD, (unsigned)COMM_CLASS_CRC);
+    printf("%-20s %6s %6s %9s %11s %10s %6s\n",
+           "workload", "msg B", "wire B", "overhead", "airtime us", "ns/frame", "lost");
+
+    for (uint8_t workload=E_EVENT; workload<E_LAST_WORKLOAD; workload++)
+    {
+        host_wire wire;
+        make_frames(controller_node, controller, (E_Workload)workload, wire);
+
+        uint32_t decoded = 0;
+        double best_ns = 1e30;
+        for (uint8_t run=0; run<RUNS; run++)
+        {
+            uint32_t events = 0;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (size_t jj=0; jj<wire.size(); jj++)
+            {
+                rx_node.rx(wire[jj]);
+                if (sink.rx_pending)
+                {
+                    // The main loop gets the notification.
+                    sink.rx_pending = false;
+                    receiver.receive();
+                    events += sink.events.size();
+                    sink.events.clear();
+                }
+            }
+            std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+            double ns = std::chrono::duration<double, std::nano>(end - start).count();
+            if (ns < best_ns) best_ns = ns;
+            decoded = events;
+        }
+
+        uint8_t msg_length = (workload == E_EVENT) ? EVENT_MSG_LENGTH : UNIVERSE_MSG_LENGTH;
+        double wire_length = (double)wire.size() / FRAMES;
+        printf("%-20s %6u %6.1f %8.1f%% %11.0f %10.0f %6u\n",
+               WORKLOAD_NAME[workload], (unsigned)msg_length, wire_length,
+               100.0 * (wire_length - msg_length) / msg_length,
+               (double)host_airtime_us(wire.size()) / FRAMES,
+               best_ns / FRAMES, (unsigned)(FRAMES - decoded));
+    }
+
+    printf("rejected: crc %u, length %u, RX overflow %u\n",
+           receiver.getCrcErrorCount(), receiver.getLengthErrorCount(),
+           UartBaseClass::pUart->getRxOverflowCount());
+    return 0;
+}
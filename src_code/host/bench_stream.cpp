@@ -0,0 +1,357 @@
+/****************************************************
+    Stream Compression Benchmark
+
+    File:   bench_stream.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    bench_stream.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file measures how well stream msgs (encode_stream()) compress
+     a stream of colors compared with sending a universe msg every
+     frame, and which ops (skip, repeat, delta, literal) were picked.
+     It runs a set of made up streams, or the recorded streams named
+     on the command line.  A recorded stream file holds the slot count
+     (1 byte, 1 to MAX_UNIVERSE_SLOTS) followed by the frames, each
+     slot count * (Red, Green, Blue) bytes.  A node per slot decodes
+     the stream and the colors it applies are checked.
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+#include "host_node.h"
+
+#ifndef _COMM_CLASS_H_
+#include "comm_class.h"
+#endif
+
+// Stream msg layout (see comm_class.h, STREAM MSG struct)
+static const uint8_t STREAM_MSG = 0xF3;
+static const uint8_t STREAM_HEADER_LENGTH = 3;
+static const uint8_t STREAM_OP_SHIFT = 6;
+static const uint8_t STREAM_RUN_MASK = 0x3F;
+static const uint8_t STREAM_OPS = 4;
+
+static const uint16_t FRAMES = 512;
+
+// comm_class takes counts by reference, these need storage.
+static uint8_t const UNIVERSE_SLOTS = comm_class::MAX_UNIVERSE_SLOTS;
+
+struct stream_struct
+{
+    const char *name;
+    uint8_t slots;
+    std::vector<uint8_t> frames;    // FRAMES * slots * (R, G, B)
+};
+
+struct result_struct
+{
+    result_struct() : universe_bytes(0), stream_bytes(0), keyframes(0), mismatches(0)
+    {
+        for (uint8_t ii=0; ii<STREAM_OPS; ii++) op_slots[ii] = 0;
+    }
+
+    uint32_t universe_bytes;
+    uint32_t stream_bytes;
+    uint32_t keyframes;
+    uint32_t op_slots[STREAM_OPS];
+    uint32_t mismatches;
+};
+
+static uint8_t wave(uint32_t const &A)
+{
+    return (uint8_t)(127.5 + 127.5 * sin(A * 2.0 * M_PI / 256.0));
+}
+
+// Made up streams, UNIVERSE_SLOTS slots each
+static void make_streams(std::vector<stream_struct> &streams)
+{
+    const char *names[] = { "static", "fade", "gradient fade", "rainbow chase", "single chase", "twinkle", "noise" };
+    srand(1);
+
+    for (uint8_t ss=0; ss<7; ss++)
+    {
+        stream_struct stream;
+        stream.name = names[ss];
+        stream.slots = UNIVERSE_SLOTS;
+        for (uint16_t ff=0; ff<FRAMES; ff++)
+        {
+            for (uint8_t jj=0; jj<UNIVERSE_SLOTS; jj++)
+            {
+                uint8_t rgb[3];
+                switch (ss)
+                {
+                case 0:
+                    rgb[0] = 200; rgb[1] = 40; rgb[2] = 10;
+                break;
+                case 1:
+                    // Every slot the same, slowly changing
+                    rgb[0] = ff / 2; rgb[1] = 255 - ff / 2; rgb[2] = 64;
+                break;
+                case 2:
+                    // A gradient along the slots, every slot brightening
+                    rgb[0] = jj * 8 + ff / 4; rgb[1] = jj * 4 + ff / 4; rgb[2] = 16;
+                break;
+                case 3:
+                    // Hue wheel moving along the slots
+                    rgb[0] = wave(ff * 2 + jj * 17);
+                    rgb[1] = wave(ff * 2 + jj * 17 + 85);
+                    rgb[2] = wave(ff * 2 + jj * 17 + 170);
+                break;
+                case 4:
+                    // One lit slot moving along dark slots
+                    rgb[0] = rgb[1] = rgb[2] = (jj == (ff / 4) % UNIVERSE_SLOTS) ? 255 : 0;
+                break;
+                case 5:
+                    // A slot or two changes now and then
+                    if ((ff == 0) || ((rand() % 16) == 0))
+                    {
+                        rgb[0] = rand(); rgb[1] = rand(); rgb[2] = rand();
+                    }
+                    else
+                    {
+                        uint8_t const *last = &stream.frames[stream.frames.size() - 3 * UNIVERSE_SLOTS];
+                        rgb[0] = last[0]; rgb[1] = last[1]; rgb[2] = last[2];
+                    }
+                break;
+                default:
+                    rgb[0] = rand(); rgb[1] = rand(); rgb[2] = rand();
+                break;
+                }
+                stream.frames.insert(stream.frames.end(), rgb, rgb + 3);
+            }
+        }
+        streams.push_back(stream);
+    }
+}
+
+static bool load_stream(const char *file, stream_struct &stream)
+{
+    FILE *fp = fopen(file, "rb");
+    if (!fp) return false;
+
+    stream.name = file;
+    int slots = fgetc(fp);
+    if ((slots < 1) || (slots > UNIVERSE_SLOTS))
+    {
+        fclose(fp);
+        return false;
+    }
+    stream.slots = slots;
+
+    int c;
+    while ((c = fgetc(fp)) != EOF) stream.frames.push_back(c);
+    fclose(fp);
+
+    // Whole frames only
+    stream.frames.resize(stream.frames.size() - (stream.frames.size() % (3 * slots)));
+    return !stream.frames.empty();
+}
+
+// Count the slots covered by each op of the stream msgs on the wire
+static void count_ops(host_wire const &wire, result_struct &result)
+{
+    std::vector<uint8_t> msg;
+    bool escape = false;
+    for (size_t ii=0; ii<wire.size(); ii++)
+    {
+        uint8_t data = (uint8_t)wire[ii];
+        if (data == UartBaseClass::COMM_CLASS_FLAG_BYTE)
+        {
+            if ((msg.size() > STREAM_HEADER_LENGTH) && (msg[0] == STREAM_MSG))
+            {
+                size_t pos = STREAM_HEADER_LENGTH;
+                while (pos < msg.size() - crc_class::LENGTH)
+                {
+                    uint8_t op = msg[pos] >> STREAM_OP_SHIFT;
+                    uint8_t run = (msg[pos] & STREAM_RUN_MASK) + 1;
+                    result.op_slots[op] += run;
+                    pos += 1 + ((op == 0) ? 0 : (op == 3) ? 3 * run : 3);
+                }
+            }
+            else if (!msg.empty())
+            {
+                result.keyframes++;
+            }
+            msg.clear();
+            escape = false;
+        }
+        else if (data == UartBaseClass::COMM_CLASS_ESCAPE_CHAR_START)
+        {
+            escape = true;
+        }
+        else
+        {
+            if (escape) data ^= UartBaseClass::COMM_CLASS_BYTE_STUFF_XOR_VALUE;
+            escape = false;
+            msg.push_back(data);
+        }
+    }
+}
+
+static result_struct run_stream(stream_struct const &stream)
+{
+    result_struct result;
+
+    host_node universe_node;
+    universe_node.select();
+    comm_class universe;
+    universe_node.attach_uart();
+
+    host_node stream_node;
+    stream_node.select();
+    comm_class streamer;
+    stream_node.attach_uart();
+
+    // A node per slot
+    std::vector<host_node> rx_node(stream.slots);
+    std::vector<comm_class *> receiver(stream.slots);
+    std::vector<host_sink> sink(stream.slots);
+    std::vector<uint8_t> applied(3 * stream.slots, 0);
+    for (uint8_t jj=0; jj<stream.slots; jj++)
+    {
+        rx_node[jj].select();
+        receiver[jj] = new comm_class;
+        rx_node[jj].attach_uart();
+        receiver[jj]->Attach(&sink[jj]);
+        receiver[jj]->setNodeAddress(jj + 1);
+    }
+
+    uint16_t frames = stream.frames.size() / (3 * stream.slots);
+    std::vector<uint8_t> last(3 * stream.slots, 0);
+    host_wire all;
+    for (uint16_t ff=0; ff<frames; ff++)
+    {
+        uint8_t const *rgb = &stream.frames[ff * 3 * stream.slots];
+
+        host_wire wire;
+        universe_node.select();
+        universe.encode_universe(1, rgb, stream.slots);
+        universe_node.drain(wire);
+        result.universe_bytes += wire.size();
+
+        wire.clear();
+        stream_node.select();
+        streamer.encode_stream(1, rgb, &last[0], stream.slots);
+        stream_node.drain(wire);
+        result.stream_bytes += wire.size();
+        all.insert(all.end(), wire.begin(), wire.end());
+
+        // Every node must end up with its slot's color
+        for (uint8_t jj=0; jj<stream.slots; jj++)
+        {
+            for (size_t kk=0; kk<wire.size(); kk++)
+            {
+                rx_node[jj].rx(wire[kk]);
+                if (sink[jj].rx_pending)
+                {
+                    sink[jj].rx_pending = false;
+                    rx_node[jj].select();
+                    receiver[jj]->receive();
+                }
+            }
+            for (size_t kk=0; kk<sink[jj].events.size(); kk++)
+            {
+                event_element_class const &A = sink[jj].events[kk];
+                if ((A.get_current_event() == E_SET_RGB_VALUE) && (A.get_payload_length() == 3))
+                {
+                    for (uint8_t cc=0; cc<3; cc++) applied[3 * jj + cc] = A.get_payload()[cc];
+                }
+            }
+            sink[jj].events.clear();
+
+            for (uint8_t cc=0; cc<3; cc++)
+            {
+                if (applied[3 * jj + cc] != rgb[3 * jj + cc])
+                {
+                    result.mismatches++;
+                    break;
+                }
+            }
+        }
+    }
+    count_ops(all, result);
+
+    for (uint8_t jj=0; jj<stream.slots; jj++) delete receiver[jj];
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<stream_struct> streams;
+    if (argc > 1)
+    {
+        for (int ii=1; ii<argc; ii++)
+        {
+            stream_struct stream;
+            if (!load_stream(argv[ii], stream))
+            {
+                fprintf(stderr, "%s: not a recorded stream\n", argv[ii]);
+                return 1;
+            }
+            streams.push_back(stream);
+        }
+    }
+    else
+    {
+        make_streams(streams);
+    }
+
+    printf("Stream msgs vs a universe msg per frame, keyframe every %u frames, CRC %u\n",
+           (unsigned)COMM_CLASS_STREAM_KEYFRAME_PERIOD, (unsigned)COMM_CLASS_CRC);
+    printf("%-15s %6s %9s %9s %6s %6s   %-27s %6s\n",
+           "stream", "frames", "univ B/f", "strm B/f", "ratio", "keyfr",
+           "slots: skip/repeat/delta/lit", "wrong");
+
+    int failed = 0;
+    for (size_t ss=0; ss<streams.size(); ss++)
+    {
+        stream_struct const &stream = streams[ss];
+        uint16_t frames = stream.frames.size() / (3 * stream.slots);
+        result_struct result = run_stream(stream);
+
+        uint32_t op_total = 0;
+        for (uint8_t ii=0; ii<STREAM_OPS; ii++) op_total += result.op_slots[ii];
+        char ops[64] = "-";
+        if (op_total)
+        {
+            snprintf(ops, sizeof(ops), "%3.0f%% %3.0f%% %3.0f%% %3.0f%%",
+                     100.0 * result.op_slots[0] / op_total, 100.0 * result.op_slots[1] / op_total,
+                     100.0 * result.op_slots[2] / op_total, 100.0 * result.op_slots[3] / op_total);
+        }
+
+        printf("%-15.15s %6u %9.1f %9.1f %6.2f %6u   %-27s %6u\n",
+               stream.name, (unsigned)frames,
+               (double)result.universe_bytes / frames, (double)result.stream_bytes / frames,
+               (double)result.universe_bytes / result.stream_bytes,
+               (unsigned)result.keyframes, ops, (unsigned)result.mismatches);
+        if (result.mismatches) failed++;
+    }
+
+    printf("%s\n", failed ? "FAILED" : "ok");
+    return failed ? 1 : 0;
+}
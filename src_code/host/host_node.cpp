@@ -0,0 +1,182 @@
+/****************************************************
+    Host Node
+
+    File:   host_node.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    host_node.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file runs the comm and UART classes on a PC for the host
+     benchmarks and simulators.  Each host_node has its own register
+     file, EEPROM and UART class.  The TX ISR is run until the TX ring
+     is empty and characters are fed one at a time through the RX ISR.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <string.h>
+#include <avr/eeprom.h>
+#include <avr/boot.h>
+
+#include "host_node.h"
+
+// Register file of the selected node
+static host_avr_regs host_boot_regs;
+host_avr_regs *host_avr = &host_boot_regs;
+
+host_node *host_node::current = 0;
+
+host_node::host_node()
+: rx_interrupts(0)
+, rx_ignored(0)
+, _Uart(0)
+{
+    memset((void *)&regs, 0, sizeof(regs));
+
+    // Data register empty, DIP switch and button inputs pulled up.
+    host_avr_regs *selected = host_avr;
+    host_avr = &regs;
+    UCSR0A = (1<<UDRE0);
+    PINB = PINC = PIND = 0xFF;
+    host_avr = selected;
+}
+
+void host_node::select()
+{
+    current = this;
+    host_avr = &regs;
+    if (_Uart) UartBaseClass::pUart = _Uart;
+}
+
+void host_node::drain(host_wire &wire)
+{
+    select();
+    while (UCSR0B & (1<<UDRIE0))
+    {
+        _Uart->transmit();
+        if (!(UCSR0B & (1<<UDRIE0))) break;
+
+        uint16_t character = UDR0;
+        if (UCSR0B & (1<<TXB80)) character |= HOST_ADDRESS_BIT;
+        wire.push_back(character);
+    }
+}
+
+bool host_node::rx(uint16_t const &character, uint8_t const &status)
+{
+    select();
+    bool address = (character & HOST_ADDRESS_BIT) != 0;
+
+    // MPCM:  data characters are dropped by the USART itself.
+    if ((UCSR0A & (1<<MPCM0)) && !address)
+    {
+        rx_ignored++;
+        return false;
+    }
+
+    UCSR0A = (UCSR0A & ((1<<MPCM0)|(1<<U2X0))) | status;
+    if (address) UCSR0B |= (1<<RXB80);
+    else UCSR0B &= ~(1<<RXB80);
+    UDR0 = character & 0xFF;
+
+    rx_interrupts++;
+    _Uart->receive();
+    return true;
+}
+
+void host_node::rx(host_wire const &wire)
+{
+    for (size_t jj=0; jj<wire.size(); jj++) rx(wire[jj]);
+}
+
+void host_sink::Update(event_element_class const &A)
+{
+    if ((A.get_current_hardware() == E_UART_00) &&
+        ((A.get_current_event() == E_UART_RX_FRAME_EVENT) ||
+         (A.get_current_event() == E_UART_FLAG_BYTE_FOUND_EVENT)))
+    {
+        rx_pending = true;
+        return;
+    }
+    if ((A.get_current_hardware() == E_UART_00) &&
+        (A.get_current_event() == E_UART_RX_FRAME_END))
+    {
+        frame_end_ms = A.get_current_data();
+        return;
+    }
+    events.push_back(A);
+}
+
+// EEPROM of the selected node.  Erased bytes read 0xFF.
+static std::map<void const *, uint8_t> &host_eeprom()
+{
+    static std::map<void const *, uint8_t> boot_eeprom;
+    return host_node::current ? host_node::current->eeprom : boot_eeprom;
+}
+
+uint8_t eeprom_read_byte(uint8_t const *address)
+{
+    std::map<void const *, uint8_t>::const_iterator it = host_eeprom().find(address);
+    return (it == host_eeprom().end()) ? 0xFF : it->second;
+}
+
+void eeprom_update_byte(uint8_t *address, uint8_t value)
+{
+    host_eeprom()[address] = value;
+}
+
+uint16_t eeprom_read_word(uint16_t const *address)
+{
+    uint8_t const *p = (uint8_t const *)address;
+    return eeprom_read_byte(p) | ((uint16_t)eeprom_read_byte(p + 1) << 8);
+}
+
+void eeprom_update_word(uint16_t *address, uint16_t value)
+{
+    uint8_t *p = (uint8_t *)address;
+    eeprom_update_byte(p, value & 0xFF);
+    eeprom_update_byte(p + 1, value >> 8);
+}
+
+void eeprom_read_block(void *dest, void const *source, size_t length)
+{
+    for (size_t jj=0; jj<length; jj++)
+    {
+        ((uint8_t *)dest)[jj] = eeprom_read_byte((uint8_t const *)source + jj);
+    }
+}
+
+void eeprom_update_block(void const *source, void *dest, size_t length)
+{
+    for (size_t jj=0; jj<length; jj++)
+    {
+        eeprom_update_byte((uint8_t *)dest + jj, ((uint8_t const *)source)[jj]);
+    }
+}
+
+uint8_t boot_signature_byte_get(uint16_t address)
+{
+    (void)address;
+    return 0;
+}
@@ -0,0 +1,122 @@
+#ifndef _HOST_NODE_H_
+#define _HOST_NODE_H_
+
+/****************************************************
+    Host Node
+
+    File:   host_node.h
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    host_node.h file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file runs the comm and UART classes on a PC for the host
+     benchmarks and simulators.  Each host_node has its own register
+     file, EEPROM and UART class.  The TX ISR is run until the TX ring
+     is empty and characters are fed one at a time through the RX ISR.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <avr/io.h>
+#include <map>
+#include <vector>
+
+#ifndef _UART_CLASS_H_
+#include "uart_class.h"
+#endif
+
+// Characters on the wire.  Bit 8 is the 9th (address) bit of a
+//  UART_MPCM character.
+typedef std::vector<uint16_t> host_wire;
+static const uint16_t HOST_ADDRESS_BIT = 0x100;
+
+// Bits per character on the wire (start, data, stop)
+#if UART_MPCM
+static const uint8_t HOST_CHAR_BITS = 11;
+#else
+static const uint8_t HOST_CHAR_BITS = 10;
+#endif
+
+// Microseconds the characters take on the wire at BAUD
+inline uint32_t host_airtime_us(uint32_t const &chars)
+{
+    return (uint32_t)((uint64_t)chars * HOST_CHAR_BITS * 1000000UL / BAUD);
+}
+
+class host_node
+{
+public:
+    host_node();
+
+    // Run the firmware on this node (registers, EEPROM and UART).
+    void select();
+
+    // Call with this node selected, once the node's UART class is
+    //  built (the UART class constructor sets UartBaseClass::pUart).
+    void attach_uart() { _Uart = UartBaseClass::pUart; }
+
+    // Run the TX ISR until the TX ring is empty, adding the characters
+    //  sent to wire.
+    void drain(host_wire &wire);
+
+    // Pass one character to the RX ISR (status is the UCSR0A error
+    //  bits).  In multi-processor mode the USART ignores data
+    //  characters while MPCM0 is set, then false is returned and no
+    //  RX interrupt is taken.
+    bool rx(uint16_t const &character, uint8_t const &status = 0);
+    void rx(host_wire const &wire);
+
+    // RX interrupts taken and characters ignored (MPCM)
+    uint32_t rx_interrupts;
+    uint32_t rx_ignored;
+
+    host_avr_regs regs;
+    std::map<void const *, uint8_t> eeprom;
+
+    static host_node *current;
+
+private:
+    UartBaseClass *_Uart;
+};
+
+// Keeps the events a comm class passes on.  Frame notifications only
+//  set rx_pending, the host program then calls comm_class::receive()
+//  like the node's main loop does.  Frame end times are kept apart
+//  from the events.
+class host_sink
+: public EventObserver
+{
+public:
+    host_sink() : rx_pending(false), frame_end_ms(0) {}
+    virtual ~host_sink() {}
+
+    virtual void Update(event_element_class const &A);
+
+    bool rx_pending;
+    // Data of the last E_UART_RX_FRAME_END (kept out of events)
+    uint8_t frame_end_ms;
+    std::vector<event_element_class> events;
+};
+
+#endif
@@ -0,0 +1,307 @@
+/****************************************************
+    Reply Slot Channel Simulator
+
+    File:   sim_channel.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    sim_channel.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file simulates the reply slots on a shared bus.  After a
+     broadcast poll every addressed node answers (feedback, STATUS or
+     STATS) in its own slot,
+     timed with its own RC oscillator (off by up to
+     COMM_CLASS_CLOCK_ERROR permille) and a 1 ms timer.  The replies
+     are encoded by the comm class, their airtime taken from the
+     characters on the wire, and any two that overlap are lost.  It
+     reports the collisions and round length of the old flat 10 ms
+     slots and of comm_class::reply_slot_ms(), with random clock
+     errors and with neighbours off the worst way.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+    2026 Oct 18  James Stokebrand   STATUS and STATS replies.
+
+*****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "host_node.h"
+
+#ifndef _COMM_CLASS_H_
+#include "comm_class.h"
+#endif
+
+// The old flat slot width
+static const uint16_t OLD_SLOT_MS = 10;
+
+// Highest addresses answering
+static const uint8_t NODE_COUNTS[] = { 15, 63, 127 };
+static const uint8_t TRIALS = 20;
+
+static const int32_t E = COMM_CLASS_CLOCK_ERROR;
+
+// How each node's clock and timer are off
+enum E_Clocks { E_RANDOM, E_WORST, E_LAST_CLOCKS };
+static const char *CLOCKS_NAME[] = { "random", "worst" };
+
+enum E_Schedule { E_OLD, E_NEW, E_LAST_SCHEDULE };
+static const char *SCHEDULE_NAME[] = { "flat 10ms", "reply_slot" };
+
+// What the nodes answer with
+enum E_Reply { E_FEEDBACK, E_STATUS, E_STATS, E_LAST_REPLY };
+static const char *REPLY_NAME[] = { "feedback", "status", "stats" };
+static const uint8_t REPLY_LENGTH[] =
+{
+     comm_class::FEEDBACK_MSG_LENGTH
+    ,comm_class::STATUS_MSG_LENGTH
+    ,comm_class::STATS_MSG_LENGTH
+};
+
+struct reply
+{
+    int32_t start_us;
+    int32_t end_us;
+    uint8_t node;
+    uint16_t value;
+};
+
+static bool by_start(reply const &a, reply const &b) { return a.start_us < b.start_us; }
+
+struct result
+{
+    uint16_t collided;
+    uint16_t delivered;
+    int32_t round_us;
+};
+
+struct channel_sim
+{
+    // Device 0 is the controller, device n is node n
+    channel_sim(uint8_t const &nodes)
+    : count(nodes + 1)
+    , host(count)
+    , comm(count)
+    , sink(count)
+    {
+        for (uint8_t ii=0; ii<count; ii++)
+        {
+            host[ii].select();
+            comm[ii] = new comm_class;
+            host[ii].attach_uart();
+            comm[ii]->Attach(&sink[ii]);
+            if (ii) comm[ii]->setNodeAddress(ii);
+        }
+    }
+
+    ~channel_sim()
+    {
+        for (uint8_t ii=0; ii<count; ii++) delete comm[ii];
+    }
+
+    // The node's reply (as rgb_node_state_machine sends it).  The
+    //  report bytes are all the low byte of value.
+    host_wire encode(uint8_t const &ii, E_Reply const &kind, uint16_t const &value)
+    {
+        host[ii].select();
+        if (kind == E_FEEDBACK)
+        {
+            event_element_class A;
+            A.set(E_RGB_NODE, E_LED_RED_PWM);
+            A.set_data16(value);
+            comm[ii]->encode(A, comm_class::CONTROLLER_ADDRESS);
+        }
+        else
+        {
+            uint8_t report[node_report_class::STATS_PAYLOAD_LENGTH];
+            memset(report, value & 0xFF, sizeof(report));
+            if (kind == E_STATUS) comm[ii]->encode_status(report);
+            else comm[ii]->encode_stats(report);
+        }
+        host_wire wire;
+        host[ii].drain(wire);
+        return wire;
+    }
+
+    // Did the controller decode this node's reply from the wire?
+    bool deliver(host_wire const &wire, uint8_t const &ii, E_Reply const &kind, uint16_t const &value)
+    {
+        for (size_t jj=0; jj<wire.size(); jj++)
+        {
+            host[0].rx(wire[jj]);
+            if (sink[0].rx_pending)
+            {
+                sink[0].rx_pending = false;
+                host[0].select();
+                comm[0]->receive();
+            }
+        }
+        // Report payloads hold event pool blocks, take them now.
+        uint8_t decoded = 0;
+        for (size_t ee=0; ee<sink[0].events.size(); ee++)
+        {
+            event_element_class const &A = sink[0].events[ee];
+            if (kind == E_FEEDBACK)
+            {
+                if ((A.get_current_event() == E_LED_RED_PWM) && (A.get_data16() == value)) decoded++;
+            }
+            else if ((A.get_current_event() == ((kind == E_STATUS) ? E_NODE_STATUS : E_NODE_STATS)) &&
+                     (A.get_current_data() == ii) && (A.get_payload_length() > 0) &&
+                     (A.get_payload()[A.get_payload_length() - 1] == (value & 0xFF)))
+            {
+                decoded++;
+            }
+        }
+        sink[0].events.clear();
+        return decoded == 1;
+    }
+
+    uint8_t count;
+    std::vector<host_node> host;
+    std::vector<comm_class *> comm;
+    std::vector<host_sink> sink;
+};
+
+// Delay node n starts its reply after the end of the poll
+static uint16_t slot_ms(E_Schedule const &schedule, E_Reply const &kind, uint8_t const &address)
+{
+    if (schedule == E_OLD) return address * OLD_SLOT_MS;
+    return comm_class::reply_slot_ms(address, REPLY_LENGTH[kind]);
+}
+
+static int32_t uniform(int32_t const &low, int32_t const &high)
+{
+    return low + (int32_t)(((int64_t)rand() * (high - low + 1)) / ((int64_t)RAND_MAX + 1));
+}
+
+// Every node answers one poll
+static result poll(uint8_t const &nodes, E_Reply const &kind, E_Schedule const &schedule,
+                   E_Clocks const &clocks)
+{
+    channel_sim bus(nodes);
+    std::vector<reply> replies;
+
+    for (uint8_t ii=1; ii<bus.count; ii++)
+    {
+        // Clock error (permille of the delay) and where the 1 ms timer
+        //  and frame end stamp leave the start.  Worst: odd nodes late,
+        //  the even nodes after them early.
+        int32_t error, tick_us;
+        uint16_t value;
+        if (clocks == E_WORST)
+        {
+            error = (ii & 1) ? E : -E;
+            tick_us = (ii & 1) ? 999 : -1000;
+            value = 0x7E7D;
+        }
+        else
+        {
+            error = uniform(-E, E);
+            tick_us = uniform(-1000, 999);
+            value = rand() & 0xFFFF;
+        }
+
+        reply r;
+        int64_t delay_us = (int64_t)slot_ms(schedule, kind, ii) * 1000;
+        r.start_us = (int32_t)(delay_us + delay_us * error / 1000) + tick_us;
+        host_wire wire = bus.encode(ii, kind, value);
+        r.end_us = r.start_us + host_airtime_us(wire.size());
+        r.node = ii;
+        r.value = value;
+        replies.push_back(r);
+    }
+
+    // Overlapping replies are garbled, the rest reach the controller
+    std::sort(replies.begin(), replies.end(), by_start);
+    result res = { 0, 0, 0 };
+    for (size_t kk=0; kk<replies.size(); kk++)
+    {
+        bool overlap = ((kk > 0) && (replies[kk-1].end_us > replies[kk].start_us)) ||
+                       ((kk + 1 < replies.size()) && (replies[kk].end_us > replies[kk+1].start_us));
+        if (replies[kk].end_us > res.round_us) res.round_us = replies[kk].end_us;
+        if (overlap)
+        {
+            res.collided++;
+            continue;
+        }
+        host_wire wire = bus.encode(replies[kk].node, kind, replies[kk].value);
+        if (bus.deliver(wire, replies[kk].node, kind, replies[kk].value)) res.delivered++;
+    }
+    return res;
+}
+
+int main()
+{
+    int failed = 0;
+
+    printf("Reply slots after a broadcast poll, clock error %ld permille, BAUD %lu\n",
+           (long)E, (unsigned long)BAUD);
+
+    for (uint8_t kind=E_FEEDBACK; kind<E_LAST_REPLY; kind++)
+    {
+        printf("%s msg worst case %u chars, %lu us\n", REPLY_NAME[kind],
+               (unsigned)comm_class::frame_chars(REPLY_LENGTH[kind]),
+               (unsigned long)comm_class::frame_airtime_us(REPLY_LENGTH[kind]));
+        printf("%-10s %-6s %5s | %9s %9s %9s %5s\n",
+               "slots", "clocks", "nodes", "collided", "max", "round ms", "ok%");
+
+        for (uint8_t schedule=E_OLD; schedule<E_LAST_SCHEDULE; schedule++)
+        {
+            for (uint8_t clocks=E_RANDOM; clocks<E_LAST_CLOCKS; clocks++)
+            {
+                for (uint8_t nn=0; nn<sizeof(NODE_COUNTS); nn++)
+                {
+                    srand(nn * 101 + clocks * 7 + kind * 3 + 1);
+
+                    uint8_t trials = (clocks == E_WORST) ? 1 : TRIALS;
+                    uint32_t collided = 0;
+                    uint16_t max_collided = 0;
+                    int32_t round_us = 0;
+                    uint32_t delivered = 0;
+                    for (uint8_t tt=0; tt<trials; tt++)
+                    {
+                        result r = poll(NODE_COUNTS[nn], (E_Reply)kind, (E_Schedule)schedule,
+                                        (E_Clocks)clocks);
+                        collided += r.collided;
+                        if (r.collided > max_collided) max_collided = r.collided;
+                        if (r.round_us > round_us) round_us = r.round_us;
+                        delivered += r.delivered;
+                    }
+                    uint32_t ok = delivered * 100 / ((uint32_t)NODE_COUNTS[nn] * trials);
+                    printf("%-10s %-6s %5u | %9.1f %9u %9.0f %5lu\n",
+                           SCHEDULE_NAME[schedule], CLOCKS_NAME[clocks], (unsigned)NODE_COUNTS[nn],
+                           (double)collided / trials, (unsigned)max_collided,
+                           (double)round_us / 1000, (unsigned long)ok);
+
+                    // Every reply must get through in its own slot
+                    if ((schedule == E_NEW) && (delivered != (uint32_t)NODE_COUNTS[nn] * trials)) failed++;
+                }
+            }
+        }
+    }
+
+    printf("%s\n", failed ? "FAILED" : "ok");
+    return failed ? 1 : 0;
+}
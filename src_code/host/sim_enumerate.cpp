@@ -0,0 +1,396 @@
+/****************************************************
+    Address Discovery Simulator
+
+    File:   sim_enumerate.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    sim_enumerate.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file simulates address discovery on a shared bus: a controller
+     and N nodes powered up with no address.  The controller sends
+     DISCOVER msgs, each node answers with an ANNOUNCE in a random time
+     slot (answers in the same slot collide and reach the controller
+     as one frame with a bad CRC) and the controller ASSIGNs the next
+     free address to every unique ID it heard.  It reports the rounds
+     and time to address every node for fixed and adaptive slot
+     counts, and checks a node addressed by its DIP switches refuses
+     an ASSIGN.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "host_node.h"
+
+#ifndef _COMM_CLASS_H_
+#include "comm_class.h"
+#endif
+
+// Same as rgb_node_state_machine
+static const uint32_t ANNOUNCE_SLOT_US = 10000;
+
+// The DIP switch address of the node that refuses ASSIGN msgs (above
+//  every address the controller hands out here).
+static const uint8_t DIP_ADDRESS = 0x7F;
+
+// Node counts, the last is every address but the DIP one
+static const uint8_t NODE_COUNTS[] = { 4, 15, 32, 64, 126 };
+static const uint8_t TRIALS = 20;
+
+// Rounds before the controller gives up
+static const uint8_t MAX_ROUNDS = 64;
+
+static const uint8_t UID_LENGTH = node_identity_class::UID_LENGTH;
+
+// Slots in the next DISCOVER.  Fixed, or adaptive: about 2.4 nodes
+//  are left for every slot that collided, one slot per node left is
+//  best for slotted answers.
+enum E_Slots { E_FIXED_16, E_FIXED_64, E_ADAPTIVE, E_LAST_SLOTS };
+static const char *SLOTS_NAME[] = { "fixed 16", "fixed 64", "adaptive" };
+
+static uint8_t next_slots(E_Slots const &slots, uint8_t const &round, uint16_t const &collided)
+{
+    switch (slots)
+    {
+    case E_FIXED_16: return 16;
+    case E_FIXED_64: return 64;
+    default:
+    {
+        if (round == 0) return 16;
+        uint32_t want = (collided * 12 + 4) / 5;
+        if (want < 4) want = 4;
+        if (want > 255) want = 255;
+        return want;
+    }
+    }
+}
+
+struct bus_sim
+{
+    // Device 0 is the controller, device n is node n.  Node 1 is the
+    //  DIP switch node.
+    bus_sim(uint8_t const &nodes)
+    : count(nodes + 2)
+    , host(count)
+    , comm(count)
+    , sink(count)
+    , dip(count, false)
+    {
+        for (uint8_t ii=0; ii<count; ii++)
+        {
+            host[ii].select();
+            comm[ii] = new comm_class;
+            host[ii].attach_uart();
+            comm[ii]->Attach(&sink[ii]);
+        }
+        dip[1] = true;
+        comm[1]->setNodeAddress(DIP_ADDRESS);
+    }
+
+    ~bus_sim()
+    {
+        for (uint8_t ii=0; ii<count; ii++) delete comm[ii];
+    }
+
+    // Characters the device has queued
+    host_wire take(uint8_t const &from)
+    {
+        host_wire wire;
+        host[from].drain(wire);
+        return wire;
+    }
+
+    // Pass the characters to the device and decode the frames
+    void deliver(uint8_t const &to, host_wire const &wire)
+    {
+        for (size_t jj=0; jj<wire.size(); jj++)
+        {
+            host[to].rx(wire[jj]);
+            if (sink[to].rx_pending)
+            {
+                sink[to].rx_pending = false;
+                host[to].select();
+                comm[to]->receive();
+            }
+        }
+    }
+
+    // Controller to every node, returns the airtime
+    uint32_t broadcast()
+    {
+        host_wire wire = take(0);
+        for (uint8_t ii=1; ii<count; ii++) deliver(ii, wire);
+        return host_airtime_us(wire.size());
+    }
+
+    // What the node does with the events it got (the state machine's
+    //  E_DISCOVER and E_ASSIGN_ADDRESS).  Returns the DISCOVER slot or
+    //  -1.
+    int node_events(uint8_t const &ii)
+    {
+        int slot = -1;
+        host[ii].select();
+        node_identity_class &identity = comm[ii]->getIdentity();
+        for (size_t ee=0; ee<sink[ii].events.size(); ee++)
+        {
+            event_element_class const &A = sink[ii].events[ee];
+            if (A.get_current_event() == E_DISCOVER)
+            {
+                // Nodes only differ in their RC oscillators, so the
+                //  Millis() and timer counts they stir in differ.
+                identity.stirRandom(((uint32_t)rand() << 16) ^ (uint32_t)rand());
+                slot = identity.random(A.get_current_data());
+            }
+            else if (A.get_current_event() == E_ASSIGN_ADDRESS)
+            {
+                if (!dip[ii])
+                {
+                    identity.saveAssignedAddress(A.get_current_data());
+                    comm[ii]->setNodeAddress(A.get_current_data());
+                }
+                comm[ii]->encode_announce();
+            }
+        }
+        sink[ii].events.clear();
+        return slot;
+    }
+
+    // ANNOUNCE msgs the controller took since the last call
+    struct announce { uint8_t uid[UID_LENGTH]; uint8_t address; };
+    std::vector<announce> announces()
+    {
+        std::vector<announce> found;
+        for (size_t ee=0; ee<sink[0].events.size(); ee++)
+        {
+            event_element_class const &A = sink[0].events[ee];
+            if ((A.get_current_event() != E_NODE_ANNOUNCE) ||
+                (A.get_payload_length() != UID_LENGTH)) continue;
+            announce a;
+            memcpy(a.uid, A.get_payload(), UID_LENGTH);
+            a.address = A.get_current_data();
+            found.push_back(a);
+        }
+        sink[0].events.clear();
+        return found;
+    }
+
+    uint16_t rejected()
+    {
+        return comm[0]->getCrcErrorCount() + comm[0]->getLengthErrorCount() +
+               comm[0]->getInvalidCount();
+    }
+
+    uint8_t count;
+    std::vector<host_node> host;
+    std::vector<comm_class *> comm;
+    std::vector<host_sink> sink;
+    std::vector<bool> dip;
+};
+
+struct result
+{
+    uint8_t rounds;
+    uint32_t us;
+    uint16_t collided;
+    bool all_addressed;
+};
+
+// Address every node, then check every address is different.
+static result enumerate(uint8_t const &nodes, E_Slots const &strategy)
+{
+    bus_sim bus(nodes);
+    result r = { 0, 0, 0, false };
+    uint8_t next_address = 1;
+    uint16_t collided = 0;
+
+    for (r.rounds=0; r.rounds<MAX_ROUNDS; r.rounds++)
+    {
+        uint8_t slots = next_slots(strategy, r.rounds, collided);
+        bus.host[0].select();
+        bus.comm[0]->encode_discover(slots);
+        r.us += bus.broadcast();
+
+        // Each node picks its slot, the controller hears the slots
+        //  in order.  More than one answer in a slot is garbled.
+        std::vector< std::vector<uint8_t> > in_slot(slots);
+        for (uint8_t ii=1; ii<bus.count; ii++)
+        {
+            int slot = bus.node_events(ii);
+            if (slot >= 0) in_slot[slot].push_back(ii);
+        }
+
+        // The controller takes each ANNOUNCE before the next slot (the
+        //  payloads hold event pool blocks).
+        std::vector<bus_sim::announce> heard;
+        uint16_t rejected = bus.rejected();
+        for (uint8_t ss=0; ss<slots; ss++)
+        {
+            if (in_slot[ss].empty()) continue;
+            host_wire wire;
+            for (size_t kk=0; kk<in_slot[ss].size(); kk++)
+            {
+                bus.host[in_slot[ss][kk]].select();
+                bus.comm[in_slot[ss][kk]]->encode_announce();
+                wire = bus.take(in_slot[ss][kk]);
+            }
+            if (in_slot[ss].size() > 1)
+            {
+                uint8_t bad = wire[2] ^ 0x01;
+                if ((bad == 0x7E) || (bad == 0x7D)) bad = wire[2] ^ 0x10;
+                wire[2] = bad;
+            }
+            bus.deliver(0, wire);
+
+            std::vector<bus_sim::announce> taken = bus.announces();
+            heard.insert(heard.end(), taken.begin(), taken.end());
+        }
+        collided = bus.rejected() - rejected;
+        r.collided += collided;
+        r.us += (slots + 1) * ANNOUNCE_SLOT_US;
+
+        // ASSIGN each unique ID heard, the node confirms with an
+        //  ANNOUNCE.
+        for (size_t kk=0; kk<heard.size(); kk++)
+        {
+            if ((heard[kk].address != 0) || (next_address >= DIP_ADDRESS)) continue;
+            bus.host[0].select();
+            bus.comm[0]->encode_assign(heard[kk].uid, next_address++);
+            r.us += bus.broadcast();
+            for (uint8_t ii=1; ii<bus.count; ii++)
+            {
+                bus.node_events(ii);
+                host_wire wire = bus.take(ii);
+                if (wire.empty()) continue;
+                r.us += host_airtime_us(wire.size());
+                bus.deliver(0, wire);
+            }
+            bus.announces();
+        }
+
+        // Done once a DISCOVER gets no answer at all
+        if (heard.empty() && (collided == 0))
+        {
+            r.rounds++;
+            break;
+        }
+    }
+
+    // Every node but the DIP one has an address, no two the same
+    bool used[0x80];
+    memset(used, 0, sizeof(used));
+    r.all_addressed = true;
+    for (uint8_t ii=1; ii<bus.count; ii++)
+    {
+        bus.host[ii].select();
+        uint8_t address = bus.comm[ii]->getIdentity().loadAssignedAddress();
+        if (bus.dip[ii]) address = DIP_ADDRESS;
+        if ((address == 0) || used[address]) r.all_addressed = false;
+        used[address] = true;
+    }
+    return r;
+}
+
+// The controller ASSIGNs an address to the DIP node's unique ID (say
+//  it was assigned before the switches were set).  It must keep the
+//  switch address, not save the new one and announce the switch
+//  address.
+static bool check_dip_refusal()
+{
+    bus_sim bus(1);
+
+    bus.host[1].select();
+    bus.comm[1]->getIdentity().makeUid();
+    uint8_t uid[UID_LENGTH];
+    memcpy(uid, bus.comm[1]->getIdentity().getUid(), UID_LENGTH);
+
+    bus.host[0].select();
+    bus.comm[0]->encode_assign(uid, 0x22);
+    bus.broadcast();
+    bus.node_events(1);
+    bus.node_events(2);
+    bus.deliver(0, bus.take(1));
+
+    std::vector<bus_sim::announce> heard = bus.announces();
+    bus.host[1].select();
+    uint8_t saved = bus.comm[1]->getIdentity().loadAssignedAddress();
+
+    bool ok = (heard.size() == 1) && (heard[0].address == DIP_ADDRESS) &&
+              !memcmp(heard[0].uid, uid, UID_LENGTH) && (saved == 0);
+    printf("DIP node 0x%02X assigned 0x22: announces 0x%02X, saved 0x%02X  %s\n",
+           (unsigned)DIP_ADDRESS, heard.empty() ? 0 : (unsigned)heard[0].address,
+           (unsigned)saved, ok ? "ok" : "WRONG");
+    return ok;
+}
+
+int main()
+{
+    int failed = 0;
+
+    printf("Address discovery, controller and N unaddressed nodes (plus one DIP node), BAUD %lu\n",
+           (unsigned long)BAUD);
+    printf("%-9s %5s | %7s %7s %9s %9s %9s %5s\n",
+           "slots", "nodes", "rounds", "max", "mean ms", "max ms", "collided", "ok%");
+
+    for (uint8_t strategy=E_FIXED_16; strategy<E_LAST_SLOTS; strategy++)
+    {
+        for (uint8_t nn=0; nn<sizeof(NODE_COUNTS); nn++)
+        {
+            srand(nn * 101 + strategy * 7 + 1);
+
+            uint32_t rounds = 0;
+            uint8_t max_rounds = 0;
+            uint64_t us = 0;
+            uint32_t max_us = 0;
+            uint32_t collided = 0;
+            uint8_t ok = 0;
+            for (uint8_t tt=0; tt<TRIALS; tt++)
+            {
+                result r = enumerate(NODE_COUNTS[nn], (E_Slots)strategy);
+                rounds += r.rounds;
+                if (r.rounds > max_rounds) max_rounds = r.rounds;
+                us += r.us;
+                if (r.us > max_us) max_us = r.us;
+                collided += r.collided;
+                if (r.all_addressed) ok++;
+            }
+            printf("%-9s %5u | %7.1f %7u %9.0f %9.0f %9.1f %5u\n",
+                   SLOTS_NAME[strategy], (unsigned)NODE_COUNTS[nn],
+                   (double)rounds / TRIALS, (unsigned)max_rounds,
+                   (double)us / TRIALS / 1000, (double)max_us / 1000,
+                   (double)collided / TRIALS, (unsigned)ok * 100 / TRIALS);
+
+            // Adaptive slots must always get there
+            if ((strategy == E_ADAPTIVE) && (ok != TRIALS)) failed++;
+        }
+    }
+
+    if (!check_dip_refusal()) failed++;
+
+    printf("%s\n", failed ? "FAILED" : "ok");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,252 @@
+/****************************************************
+    Interrupt Load Model
+
+    File:   sim_isr_load.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    sim_isr_load.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file models the node's interrupts cycle by cycle under PWM and
+     UART load: the timer2 PWM ISR (observers run with interrupts on,
+     see hal_interrupts.cpp), the UART RX ISR with back to back frames
+     arriving, and the timer0 tick.  It counts the RX bytes lost to
+     overruns (what getOverrunCount() reports on the node) and the PWM
+     steps lost, for a range of observer and RX ISR lengths, with the
+     observers nested and with them run with interrupts off.  The
+     cycle counts of the ISRs are estimates (no AVR here to measure
+     them), the model shows where the limits are.
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+// Same as hal_interrupts.cpp
+#define PWM_FREQ 60UL
+#define PWM_OCR (F_CPU/(PWM_FREQ*8UL*256UL))
+
+static const uint32_t PWM_CYCLES = PWM_OCR * 8;
+static const uint32_t CHAR_CYCLES = (uint32_t)(F_CPU * 10 / BAUD);
+static const uint32_t TICK_CYCLES = F_CPU / 1000;
+
+// Estimated ISR lengths (cycles, vector to reti)
+static const uint32_t ENTRY_CYCLES = 7;         // finish instruction, vector, jmp
+static const uint32_t PWM_PROLOGUE_CYCLES = 40; // push, mask OCIE2A, sei
+static const uint32_t PWM_EPILOGUE_CYCLES = 40; // cli, unmask, pop
+static const uint32_t TICK_ISR_CYCLES = 80;
+static const uint32_t RX_BYTE_CYCLES = 120;     // deframer, one byte
+
+// Back to back universe msgs
+static const uint32_t FRAME_CHARS = 50;
+
+// One second
+static const uint32_t RUN_CYCLES = F_CPU;
+
+// USART RX holds two bytes (UDR0), the third one overruns.
+static const uint8_t RX_FIFO = 2;
+
+enum E_Isr { E_ISR_PWM, E_ISR_TICK, E_ISR_RX };
+
+struct isr_context
+{
+    E_Isr isr;
+    uint8_t phase;          // PWM: prologue, observers, epilogue
+    uint32_t remaining;
+};
+
+struct load_result
+{
+    uint32_t overruns;
+    uint32_t pwm_lost;
+    uint32_t pwm_latency;   // worst, compare match to observers
+    uint32_t rx_latency;    // worst, byte in to RX ISR
+    uint32_t rx_isrs;
+    uint32_t main_cycles;
+};
+
+static load_result run_load(bool const &nested, uint32_t const &observer_cycles, uint32_t const &rx_frame_cycles)
+{
+    load_result result = { 0, 0, 0, 0, 0, 0 };
+
+    std::vector<isr_context> stack;
+    bool interrupts = true;
+    bool pwm_enabled = true;
+
+    bool pwm_pending = false;
+    uint32_t pwm_match = 0;
+    bool tick_pending = false;
+    uint8_t rx_fifo = 0;
+    uint32_t rx_oldest = 0;
+    uint32_t rx_count = 0;
+
+    uint32_t next_char = CHAR_CYCLES;
+    uint32_t next_pwm = PWM_CYCLES;
+    uint32_t next_tick = TICK_CYCLES;
+
+    for (uint32_t cycle=0; cycle<RUN_CYCLES; cycle++)
+    {
+        // Hardware
+        if (cycle == next_char)
+        {
+            if (rx_fifo >= RX_FIFO) result.overruns++;
+            else
+            {
+                if (rx_fifo == 0) rx_oldest = cycle;
+                rx_fifo++;
+            }
+            next_char += CHAR_CYCLES;
+        }
+        if (cycle == next_pwm)
+        {
+            if (pwm_pending) result.pwm_lost++;
+            pwm_pending = true;
+            pwm_match = cycle;
+            next_pwm += PWM_CYCLES;
+        }
+        if (cycle == next_tick)
+        {
+            tick_pending = true;
+            next_tick += TICK_CYCLES;
+        }
+
+        // Take the highest priority interrupt (lowest vector first)
+        if (interrupts)
+        {
+            isr_context context;
+            bool taken = true;
+            if (pwm_pending && pwm_enabled)
+            {
+                pwm_pending = false;
+                uint32_t latency = cycle - pwm_match;
+                if (latency > result.pwm_latency) result.pwm_latency = latency;
+                context.isr = E_ISR_PWM;
+                context.phase = 0;
+                context.remaining = ENTRY_CYCLES + PWM_PROLOGUE_CYCLES;
+            }
+            else if (tick_pending)
+            {
+                tick_pending = false;
+                context.isr = E_ISR_TICK;
+                context.phase = 0;
+                context.remaining = ENTRY_CYCLES + TICK_ISR_CYCLES;
+            }
+            else if (rx_fifo)
+            {
+                uint32_t latency = cycle - rx_oldest;
+                if (latency > result.rx_latency) result.rx_latency = latency;
+                rx_fifo--;
+                rx_oldest = cycle;
+                rx_count++;
+                result.rx_isrs++;
+                context.isr = E_ISR_RX;
+                context.phase = 0;
+                context.remaining = ENTRY_CYCLES + RX_BYTE_CYCLES +
+                                    (((rx_count % FRAME_CHARS) == 0) ? rx_frame_cycles : 0);
+            }
+            else
+            {
+                taken = false;
+            }
+            if (taken)
+            {
+                stack.push_back(context);
+                interrupts = false;
+            }
+        }
+
+        if (stack.empty())
+        {
+            result.main_cycles++;
+            continue;
+        }
+
+        isr_context &top = stack.back();
+        if (--top.remaining) continue;
+
+        if ((top.isr == E_ISR_PWM) && (top.phase == 0))
+        {
+            // Mask this interrupt and (nested) let the others in
+            top.phase = 1;
+            top.remaining = observer_cycles;
+            if (nested)
+            {
+                pwm_enabled = false;
+                interrupts = true;
+            }
+        }
+        else if ((top.isr == E_ISR_PWM) && (top.phase == 1))
+        {
+            top.phase = 2;
+            top.remaining = PWM_EPILOGUE_CYCLES;
+            interrupts = false;
+            pwm_enabled = true;
+        }
+        else
+        {
+            // reti
+            stack.pop_back();
+            interrupts = true;
+        }
+    }
+    return result;
+}
+
+int main()
+{
+    static const uint8_t OBSERVER_PERCENT[] = { 25, 50, 75, 90 };
+    static const uint32_t RX_FRAME_CYCLES[] = { 300, 600, 1200, 5000 };
+
+    printf("PWM period %lu cycles, character %lu cycles, %lu byte frames back to back, F_CPU %lu\n",
+           (unsigned long)PWM_CYCLES, (unsigned long)CHAR_CYCLES,
+           (unsigned long)FRAME_CHARS, (unsigned long)F_CPU);
+    printf("Cycles per ISR (estimates): RX byte %lu, tick %lu, PWM prologue and epilogue %lu\n",
+           (unsigned long)RX_BYTE_CYCLES, (unsigned long)TICK_ISR_CYCLES,
+           (unsigned long)(PWM_PROLOGUE_CYCLES + PWM_EPILOGUE_CYCLES));
+    printf("RX frame is the extra RX ISR cycles at the end of a frame, latencies are the worst seen\n");
+    printf("%-7s %9s %9s | %9s %9s %9s %9s %6s\n",
+           "PWM ISR", "observers", "RX frame", "overrun/s", "PWM lost", "PWM lat", "RX lat", "main");
+
+    for (uint8_t nn=0; nn<2; nn++)
+    {
+        bool nested = (nn == 0);
+        for (uint8_t oo=0; oo<sizeof(OBSERVER_PERCENT); oo++)
+        {
+            uint32_t observer_cycles = PWM_CYCLES * OBSERVER_PERCENT[oo] / 100;
+            for (uint8_t rr=0; rr<sizeof(RX_FRAME_CYCLES)/sizeof(RX_FRAME_CYCLES[0]); rr++)
+            {
+                load_result result = run_load(nested, observer_cycles, RX_FRAME_CYCLES[rr]);
+                char rx_latency[16] = "never";
+                if (result.rx_isrs) snprintf(rx_latency, sizeof(rx_latency), "%lu", (unsigned long)result.rx_latency);
+                printf("%-7s %9lu %9lu | %9lu %9lu %9lu %9s %5.0f%%\n",
+                       nested ? "nested" : "masked",
+                       (unsigned long)observer_cycles, (unsigned long)RX_FRAME_CYCLES[rr],
+                       (unsigned long)result.overruns, (unsigned long)result.pwm_lost,
+                       (unsigned long)result.pwm_latency, rx_latency,
+                       100.0 * result.main_cycles / RUN_CYCLES);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,226 @@
+/****************************************************
+    MPCM Bus Simulator
+
+    File:   sim_mpcm.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    sim_mpcm.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file simulates a wired multidrop bus in multi-processor mode
+     (UART_MPCM).  Every character on the bus reaches the controller
+     and every node, a node's USART only interrupts for the address
+     characters and for the frames sent to its address (or to every
+     node).  For each kind of traffic it counts the RX interrupts each
+     node took, against the one per character an 8 bit bus costs, and
+     checks every node got exactly the events meant for it.
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <stdio.h>
+#include <vector>
+
+#include "host_node.h"
+
+#ifndef _COMM_CLASS_H_
+#include "comm_class.h"
+#endif
+
+// A node per universe slot, addresses 1 to NODES
+static const uint8_t NODES = comm_class::MAX_UNIVERSE_SLOTS;
+
+// comm_class takes counts by reference, these need storage.
+static uint8_t const UNIVERSE_SLOTS = comm_class::MAX_UNIVERSE_SLOTS;
+static uint8_t const BATCH_EVENTS = comm_class::MAX_BATCH_EVENTS;
+
+enum E_Traffic { E_EVENT_PER_NODE, E_BATCH_PER_NODE, E_BROADCAST, E_UNIVERSE, E_REPLIES, E_LAST_TRAFFIC };
+static const char *TRAFFIC_NAME[] = {
+    "event per node", "batch per node", "broadcast event", "universe", "node replies" };
+
+// Device 0 is the controller, device n is node n.
+struct bus_sim
+{
+    bus_sim()
+    {
+        for (uint8_t ii=0; ii<=NODES; ii++)
+        {
+            host[ii].select();
+            comm[ii] = new comm_class;
+            host[ii].attach_uart();
+            comm[ii]->Attach(&sink[ii]);
+            comm[ii]->setNodeAddress(ii);
+        }
+    }
+
+    ~bus_sim()
+    {
+        for (uint8_t ii=0; ii<=NODES; ii++) delete comm[ii];
+    }
+
+    // Put what the device sent on the bus, every other device hears it.
+    uint32_t send(uint8_t const &from)
+    {
+        host_wire wire;
+        host[from].drain(wire);
+        for (uint8_t ii=0; ii<=NODES; ii++)
+        {
+            if (ii == from) continue;
+            for (size_t jj=0; jj<wire.size(); jj++)
+            {
+                host[ii].rx(wire[jj]);
+                if (sink[ii].rx_pending)
+                {
+                    sink[ii].rx_pending = false;
+                    host[ii].select();
+                    comm[ii]->receive();
+
+                    // The pool is shared by every simulated node, let
+                    //  the payloads go.
+                    received[ii] += sink[ii].events.size();
+                    sink[ii].events.clear();
+                }
+            }
+        }
+        return wire.size();
+    }
+
+    host_node host[NODES + 1];
+    comm_class *comm[NODES + 1];
+    host_sink sink[NODES + 1];
+    uint16_t received[NODES + 1];
+};
+
+// Send the traffic, returns the characters on the bus.  expected gets
+//  the events each device should end up with.
+static uint32_t run_traffic(bus_sim &bus, E_Traffic const &traffic, uint16_t *expected, uint16_t &frames)
+{
+    uint32_t chars = 0;
+    frames = 0;
+    for (uint8_t ii=0; ii<=NODES; ii++) expected[ii] = 0;
+
+    switch (traffic)
+    {
+    case E_EVENT_PER_NODE:
+        for (uint8_t nn=1; nn<=NODES; nn++)
+        {
+            bus.host[0].select();
+            bus.comm[0]->encode(event_element_class(E_RGB_CONTROLLER, E_SET_RED, nn));
+            chars += bus.send(0);
+            frames++;
+            expected[nn]++;
+        }
+    break;
+    case E_BATCH_PER_NODE:
+        for (uint8_t nn=1; nn<=NODES; nn++)
+        {
+            event_element_class batch[BATCH_EVENTS];
+            for (uint8_t jj=0; jj<BATCH_EVENTS; jj++) batch[jj].set(E_RGB_CONTROLLER, E_SET_GREEN, nn);
+            bus.host[0].select();
+            bus.comm[0]->encode(batch, BATCH_EVENTS);
+            chars += bus.send(0);
+            frames++;
+            expected[nn] += BATCH_EVENTS;
+        }
+    break;
+    case E_BROADCAST:
+        for (uint8_t nn=1; nn<=NODES; nn++)
+        {
+            bus.host[0].select();
+            bus.comm[0]->encode(event_element_class(E_RGB_CONTROLLER, E_ALL_OFF, 0));
+            chars += bus.send(0);
+            frames++;
+            for (uint8_t ii=1; ii<=NODES; ii++) expected[ii]++;
+        }
+    break;
+    case E_UNIVERSE:
+    {
+        uint8_t rgb[3 * UNIVERSE_SLOTS];
+        for (uint8_t jj=0; jj<sizeof(rgb); jj++) rgb[jj] = jj * 5;
+        bus.host[0].select();
+        bus.comm[0]->encode_universe(1, rgb, UNIVERSE_SLOTS);
+        chars += bus.send(0);
+        frames++;
+        for (uint8_t ii=1; ii<=NODES; ii++) expected[ii]++;
+    }
+    break;
+    default:
+        for (uint8_t nn=1; nn<=NODES; nn++)
+        {
+            bus.host[nn].select();
+            bus.comm[nn]->encode(event_element_class(E_RGB_NODE, E_LED_RED_PWM, nn), comm_class::CONTROLLER_ADDRESS);
+            chars += bus.send(nn);
+            frames++;
+            expected[0]++;
+        }
+    break;
+    }
+    return chars;
+}
+
+int main()
+{
+    bus_sim bus;
+
+    printf("MPCM bus, controller and %u nodes, BAUD %lu\n", (unsigned)NODES, (unsigned long)BAUD);
+    printf("%-16s %6s %6s %14s %14s %12s %6s\n",
+           "traffic", "frames", "chars", "irq/node MPCM", "irq/node 8bit", "ignored/node", "events");
+
+    int failed = 0;
+    for (uint8_t traffic=E_EVENT_PER_NODE; traffic<E_LAST_TRAFFIC; traffic++)
+    {
+        for (uint8_t ii=0; ii<=NODES; ii++)
+        {
+            bus.host[ii].rx_interrupts = 0;
+            bus.host[ii].rx_ignored = 0;
+            bus.received[ii] = 0;
+        }
+
+        uint16_t expected[NODES + 1];
+        uint16_t frames;
+        uint32_t chars = run_traffic(bus, (E_Traffic)traffic, expected, frames);
+
+        // Nodes only, the controller hears every reply anyway.  A node
+        //  does not hear itself.
+        uint32_t interrupts = 0;
+        uint32_t ignored = 0;
+        uint32_t heard = 0;
+        bool events_ok = true;
+        for (uint8_t ii=0; ii<=NODES; ii++)
+        {
+            if (bus.received[ii] != expected[ii]) events_ok = false;
+            if (ii == 0) continue;
+            interrupts += bus.host[ii].rx_interrupts;
+            ignored += bus.host[ii].rx_ignored;
+            heard += bus.host[ii].rx_interrupts + bus.host[ii].rx_ignored;
+        }
+
+        printf("%-16s %6u %6u %14.1f %14.1f %12.1f %6s\n",
+               TRAFFIC_NAME[traffic], (unsigned)frames, (unsigned)chars,
+               (double)interrupts / NODES, (double)heard / NODES, (double)ignored / NODES,
+               events_ok ? "ok" : "WRONG");
+        if (!events_ok) failed++;
+    }
+
+    printf("%s\n", failed ? "FAILED" : "ok");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,483 @@
+/****************************************************
+    Relay Topology Simulator
+
+    File:   sim_relay.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    sim_relay.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file simulates relay nodes (COMM_CLASS_RELAY == 2) on a radio
+     link where each node only hears its neighbours.  A node repeats
+     a new msg after a random delay like rgb_node_state_machine does,
+     two msgs a node hears at once are both lost.  It reports the
+     share of controller broadcasts each hop distance gets and the
+     latency the relays add, for a line, a grid and random layouts.
+     It also checks the (source, sequence) dedup key: msgs from a node
+     that restarted, and ANNOUNCEs from unaddressed nodes (all source
+     ZERO), must still get through.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "host_node.h"
+
+#ifndef _COMM_CLASS_H_
+#include "comm_class.h"
+#endif
+
+// Same as rgb_node_state_machine
+static const uint32_t RELAY_SLOT_US = 20000;
+static const uint8_t RELAY_JITTER_SLOTS = 8;
+
+// Controller broadcasts per layout, far enough apart that every relay
+//  is done before the next.
+static const uint16_t BROADCASTS = 50;
+static const uint32_t BROADCAST_US = 500000;
+
+// Hop distances reported (nodes further away are counted in the last)
+static const uint8_t MAX_HOPS = 6;
+
+struct tx
+{
+    uint8_t from;
+    uint32_t start_us;
+    uint32_t end_us;
+    host_wire wire;
+};
+
+struct relay_sim
+{
+    // Device 0 is the controller, device n is node n (address n, or
+    //  none).  hears[a][b] is true when b gets what a sends.
+    relay_sim(uint8_t const &nodes, bool const &addressed)
+    : count(nodes + 1)
+    , hears(count, std::vector<bool>(count, false))
+    , host(count)
+    , comm(count, (comm_class *)0)
+    , sink(count)
+    , relay_at(count, 0)
+    , now_us(0)
+    {
+        for (uint8_t ii=0; ii<count; ii++) boot(ii, addressed && (ii != 0));
+    }
+
+    ~relay_sim()
+    {
+        for (uint8_t ii=0; ii<count; ii++) delete comm[ii];
+    }
+
+    // Power up (or restart) a device, its EEPROM is kept.
+    void boot(uint8_t const &ii, bool const &addressed)
+    {
+        delete comm[ii];
+        host[ii].select();
+        comm[ii] = new comm_class;
+        host[ii].attach_uart();
+        comm[ii]->Attach(&sink[ii]);
+        if (addressed) comm[ii]->setNodeAddress(ii);
+        sink[ii].events.clear();
+        relay_at[ii] = 0;
+    }
+
+    void link(uint8_t const &a, uint8_t const &b)
+    {
+        hears[a][b] = hears[b][a] = true;
+    }
+
+    // Hops from the controller (0xFF if not connected)
+    std::vector<uint8_t> hops()
+    {
+        std::vector<uint8_t> distance(count, 0xFF);
+        distance[0] = 0;
+        for (uint8_t hh=0; hh<count; hh++)
+        {
+            for (uint8_t a=0; a<count; a++)
+            {
+                if (distance[a] != hh) continue;
+                for (uint8_t b=0; b<count; b++)
+                {
+                    if (hears[a][b] && (distance[b] == 0xFF)) distance[b] = hh + 1;
+                }
+            }
+        }
+        return distance;
+    }
+
+    // Send what the device has queued, starting now
+    void send(uint8_t const &from)
+    {
+        tx t;
+        t.from = from;
+        host[from].drain(t.wire);
+        if (t.wire.empty()) return;
+        t.start_us = now_us;
+        t.end_us = now_us + host_airtime_us(t.wire.size());
+        air.push_back(t);
+    }
+
+    // Did anything else reach (or leave) device d while t was on the air?
+    bool collided(tx const &t, uint8_t const &d)
+    {
+        for (size_t kk=0; kk<air.size(); kk++)
+        {
+            tx const &o = air[kk];
+            if (&o == &t) continue;
+            if ((o.start_us >= t.end_us) || (o.end_us <= t.start_us)) continue;
+            if ((o.from == d) || hears[o.from][d]) return true;
+        }
+        return false;
+    }
+
+    // Pass the characters to the device and decode the frames.  A held
+    //  msg is repeated after a random number of relay slots.
+    void deliver(uint8_t const &to, host_wire const &wire)
+    {
+        for (size_t jj=0; jj<wire.size(); jj++)
+        {
+            host[to].rx(wire[jj]);
+            if (sink[to].rx_pending)
+            {
+                sink[to].rx_pending = false;
+                host[to].select();
+                comm[to]->receive();
+            }
+        }
+
+        std::vector<event_element_class> &events = sink[to].events;
+        for (size_t ee=0; ee<events.size(); )
+        {
+            if ((to != 0) &&
+                (events[ee].get_current_hardware() == E_UART_00) &&
+                (events[ee].get_current_event() == E_UART_RELAY_PENDING))
+            {
+                node_identity_class &identity = comm[to]->getIdentity();
+                identity.stirRandom(((uint32_t)rand() << 16) ^ (uint32_t)rand());
+                relay_at[to] = now_us + identity.random(RELAY_JITTER_SLOTS) * RELAY_SLOT_US + RELAY_SLOT_US;
+                events.erase(events.begin() + ee);
+            }
+            else ee++;
+        }
+    }
+
+    // Run until the air is quiet and no relay is waiting, or until
+    //  the time given.
+    void run(uint32_t const &until_us)
+    {
+        for (;;)
+        {
+            // Next relay to start and next msg to end
+            uint32_t start_us = 0xFFFFFFFFUL;
+            uint8_t starter = 0;
+            for (uint8_t ii=1; ii<count; ii++)
+            {
+                if (relay_at[ii] && (relay_at[ii] < start_us))
+                {
+                    start_us = relay_at[ii];
+                    starter = ii;
+                }
+            }
+            uint32_t end_us = 0xFFFFFFFFUL;
+            size_t ender = 0;
+            for (size_t kk=0; kk<air.size(); kk++)
+            {
+                if (!air[kk].wire.empty() && (air[kk].end_us < end_us))
+                {
+                    end_us = air[kk].end_us;
+                    ender = kk;
+                }
+            }
+            if ((start_us >= until_us) && (end_us >= until_us)) break;
+
+            if (end_us <= start_us)
+            {
+                // Everyone in reach gets it unless they heard (or sent)
+                //  something else at the same time.
+                now_us = end_us;
+                tx &t = air[ender];
+                for (uint8_t d=0; d<count; d++)
+                {
+                    if (!hears[t.from][d] || collided(t, d)) continue;
+                    deliver(d, t.wire);
+                }
+                // Done, the times are kept for the collision checks.
+                t.wire.clear();
+            }
+            else
+            {
+                now_us = start_us;
+                relay_at[starter] = 0;
+                host[starter].select();
+                comm[starter]->relayFrame();
+                send(starter);
+            }
+        }
+        now_us = until_us;
+
+        // Forget msgs nothing can overlap any more
+        std::vector<tx> still;
+        for (size_t kk=0; kk<air.size(); kk++)
+        {
+            if (air[kk].end_us > now_us) still.push_back(air[kk]);
+        }
+        air.swap(still);
+    }
+
+    uint8_t count;
+    std::vector< std::vector<bool> > hears;
+    std::vector<host_node> host;
+    std::vector<comm_class *> comm;
+    std::vector<host_sink> sink;
+    std::vector<uint32_t> relay_at;
+    std::vector<tx> air;
+    uint32_t now_us;
+};
+
+static double uniform()
+{
+    return (double)rand() / ((double)RAND_MAX + 1);
+}
+
+// Layouts, the controller is device 0
+static void line(relay_sim &sim)
+{
+    for (uint8_t ii=1; ii<sim.count; ii++) sim.link(ii - 1, ii);
+}
+
+static void grid(relay_sim &sim, uint8_t const &side)
+{
+    for (uint8_t ii=0; ii<sim.count; ii++)
+    {
+        if ((ii % side) + 1 < side) sim.link(ii, ii + 1);
+        if (ii + side < sim.count) sim.link(ii, ii + side);
+    }
+}
+
+static void scatter(relay_sim &sim, double const &range)
+{
+    std::vector<double> x(sim.count), y(sim.count);
+    x[0] = y[0] = 0.5;
+    for (uint8_t ii=1; ii<sim.count; ii++)
+    {
+        x[ii] = uniform();
+        y[ii] = uniform();
+    }
+    for (uint8_t a=0; a<sim.count; a++)
+    {
+        for (uint8_t b=a+1; b<sim.count; b++)
+        {
+            double dx = x[a] - x[b], dy = y[a] - y[b];
+            if (dx*dx + dy*dy <= range*range) sim.link(a, b);
+        }
+    }
+}
+
+struct hop_stats
+{
+    hop_stats() : nodes(0), delivered(0), duplicates(0), latency_us(0), max_latency_us(0) {}
+    uint32_t nodes;
+    uint32_t delivered;
+    uint32_t duplicates;
+    uint64_t latency_us;
+    uint32_t max_latency_us;
+};
+
+// The controller broadcasts, each node counts what it got and when.
+static void broadcasts(relay_sim &sim, std::vector<hop_stats> &stats)
+{
+    std::vector<uint8_t> distance = sim.hops();
+
+    for (uint16_t mm=0; mm<BROADCASTS; mm++)
+    {
+        uint32_t sent_us = sim.now_us;
+        sim.host[0].select();
+        sim.comm[0]->encode(event_element_class(E_RGB_CONTROLLER, E_SET_RED, 0));
+        sim.send(0);
+        uint32_t direct_us = sim.air.back().end_us;
+
+        // Drop what the controller got back, note the nodes' first copy.
+        std::vector<uint32_t> got(sim.count, 0);
+        std::vector<uint8_t> copies(sim.count, 0);
+        while (sim.now_us < sent_us + BROADCAST_US)
+        {
+            sim.run(sim.now_us + 1000);
+            sim.sink[0].events.clear();
+            for (uint8_t ii=1; ii<sim.count; ii++)
+            {
+                for (size_t ee=0; ee<sim.sink[ii].events.size(); ee++)
+                {
+                    if (sim.sink[ii].events[ee].get_current_event() != E_SET_RED) continue;
+                    if (copies[ii]++ == 0) got[ii] = sim.now_us;
+                }
+                sim.sink[ii].events.clear();
+            }
+        }
+
+        for (uint8_t ii=1; ii<sim.count; ii++)
+        {
+            hop_stats &h = stats[(distance[ii] > MAX_HOPS) ? MAX_HOPS : distance[ii]];
+            h.nodes++;
+            if (copies[ii] > 1) h.duplicates += copies[ii] - 1;
+            if (!copies[ii]) continue;
+            h.delivered++;
+            // Time past the controller's frame (1 ms steps)
+            uint32_t added = (got[ii] > direct_us + 1000) ? got[ii] - direct_us - 1000 : 0;
+            h.latency_us += added;
+            if (added > h.max_latency_us) h.max_latency_us = added;
+        }
+    }
+}
+
+// Returns the number of hop distances that got fewer broadcasts than
+//  want_pct (within the relay hops) or any beyond them.
+static int report(char const *name, std::vector<hop_stats> const &stats, uint8_t const &want_pct)
+{
+    int failed = 0;
+    for (uint8_t hh=1; hh<=MAX_HOPS; hh++)
+    {
+        hop_stats const &h = stats[hh];
+        if (!h.nodes) continue;
+        uint32_t pct = h.delivered * 100 / h.nodes;
+        printf("%-12s %4u%s | %9.1f %6lu %10.1f %10.1f %6lu\n",
+               name, (unsigned)hh, (hh == MAX_HOPS) ? "+" : " ",
+               (double)h.nodes / BROADCASTS, (unsigned long)pct,
+               h.delivered ? (double)h.latency_us / h.delivered / 1000 : 0.0,
+               (double)h.max_latency_us / 1000, (unsigned long)h.duplicates);
+        if (h.duplicates) failed++;
+        if ((hh <= comm_class::RELAY_HOPS + 1) && (pct < want_pct)) failed++;
+        if ((hh > comm_class::RELAY_HOPS + 1) && h.delivered) failed++;
+    }
+    return failed;
+}
+
+// Node 2 is out of the controller's reach, node 1 relays.  Node 2
+//  sends, restarts and sends again, every msg must get through.
+static bool check_restart()
+{
+    relay_sim sim(2, true);
+    line(sim);
+
+    static const uint8_t SENDS = 4;
+    uint16_t heard = 0;
+    for (uint8_t boot=0; boot<2; boot++)
+    {
+        if (boot) sim.boot(2, true);
+        for (uint8_t jj=0; jj<SENDS; jj++)
+        {
+            sim.host[2].select();
+            sim.comm[2]->encode(event_element_class(E_RGB_NODE, E_LED_RED_PWM, 2), comm_class::CONTROLLER_ADDRESS);
+            sim.send(2);
+            sim.run(sim.now_us + BROADCAST_US);
+            for (size_t ee=0; ee<sim.sink[0].events.size(); ee++)
+            {
+                if (sim.sink[0].events[ee].get_current_event() == E_LED_RED_PWM) heard++;
+            }
+            sim.sink[0].events.clear();
+            sim.sink[1].events.clear();
+        }
+    }
+
+    bool ok = (heard == 2 * SENDS);
+    printf("node restarts between msgs: controller got %u of %u  %s\n",
+           (unsigned)heard, (unsigned)(2 * SENDS), ok ? "ok" : "WRONG");
+    return ok;
+}
+
+// Unaddressed nodes 2 to 9 only reach relay node 1.  Each sends its
+//  first ANNOUNCE (all source ZERO), every one must get through.
+static bool check_unaddressed()
+{
+    static const uint8_t NODES = 9;
+    relay_sim sim(NODES, false);
+    sim.link(0, 1);
+    for (uint8_t ii=2; ii<=NODES; ii++) sim.link(1, ii);
+    sim.comm[1]->setNodeAddress(1);
+
+    uint16_t heard = 0;
+    for (uint8_t ii=2; ii<=NODES; ii++)
+    {
+        // As on E_DISCOVER, the timers are stirred in first.
+        sim.host[ii].select();
+        sim.comm[ii]->getIdentity().stirRandom(((uint32_t)rand() << 16) ^ (uint32_t)rand());
+        sim.comm[ii]->encode_announce();
+        sim.send(ii);
+        sim.run(sim.now_us + BROADCAST_US);
+        for (size_t ee=0; ee<sim.sink[0].events.size(); ee++)
+        {
+            if (sim.sink[0].events[ee].get_current_event() == E_NODE_ANNOUNCE) heard++;
+        }
+        for (uint8_t jj=0; jj<=NODES; jj++) sim.sink[jj].events.clear();
+    }
+
+    bool ok = (heard == NODES - 1);
+    printf("unaddressed nodes announce through a relay: controller got %u of %u  %s\n",
+           (unsigned)heard, (unsigned)(NODES - 1), ok ? "ok" : "WRONG");
+    return ok;
+}
+
+int main()
+{
+    int failed = 0;
+
+    printf("Controller broadcasts through relay nodes, %u relay hops, BAUD %lu\n",
+           (unsigned)comm_class::RELAY_HOPS, (unsigned long)BAUD);
+    printf("%-12s %5s | %9s %6s %10s %10s %6s\n",
+           "layout", "hops", "nodes", "got%", "added ms", "max ms", "dups");
+
+    srand(1);
+    {
+        relay_sim sim(6, true);
+        line(sim);
+        std::vector<hop_stats> stats(MAX_HOPS + 1);
+        broadcasts(sim, stats);
+        failed += report("line 6", stats, 100);
+    }
+    {
+        relay_sim sim(24, true);
+        grid(sim, 5);
+        std::vector<hop_stats> stats(MAX_HOPS + 1);
+        broadcasts(sim, stats);
+        failed += report("grid 5x5", stats, 90);
+    }
+    {
+        std::vector<hop_stats> stats(MAX_HOPS + 1);
+        for (uint8_t ss=0; ss<5; ss++)
+        {
+            relay_sim sim(40, true);
+            scatter(sim, 0.25);
+            broadcasts(sim, stats);
+        }
+        failed += report("random 40", stats, 80);
+    }
+
+    if (!check_restart()) failed++;
+    if (!check_unaddressed()) failed++;
+
+    printf("%s\n", failed ? "FAILED" : "ok");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,459 @@
+/****************************************************
+    Lossy Link Transfer Simulator
+
+    File:   sim_transfer.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    sim_transfer.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file simulates a transfer to a bus of nodes over a lossy
+     link, repaired with NACK polls (encode_nack_poll(), encode_nack())
+     and, for comparison, sent blind a fixed number of times.  Bits on
+     the wire are flipped at random (in both directions) and the
+     frame CRC drops the damaged frames.  Time is the wire airtime
+     plus the NACK time slots.  A second case times each node's NACK
+     slot on a drifting clock (COMM_CLASS_CLOCK_ERROR) and loses NACKs
+     that overlap, for the old flat 10 ms slots and for
+     comm_class::reply_slot_ms().
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+    2026 Oct 18  James Stokebrand   NACK slots from reply_slot_ms(), clock
+                                      drift case.
+
+*****************************************************/
+
+#include <stdio.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "host_node.h"
+
+#ifndef _COMM_CLASS_H_
+#include "comm_class.h"
+#endif
+
+// Nodes on the bus, addresses 1 to NODES
+static const uint8_t NODES = 8;
+
+// Node n answers a poll in its NACK slot.  rgb_node_state_machine
+//  uses reply_slot_ms(), the old slots were a flat 10 ms per address.
+enum E_Schedule { E_REPLY_SLOT, E_FLAT, E_LAST_SCHEDULE };
+static const char *SCHEDULE_NAME[] = { "reply_slot", "flat 10ms" };
+static const uint16_t FLAT_SLOT_MS = 10;
+
+static uint32_t slot_us(E_Schedule const &schedule, uint8_t const &address)
+{
+    if (schedule == E_FLAT) return (uint32_t)address * FLAT_SLOT_MS * 1000;
+    return (uint32_t)comm_class::reply_slot_ms(address, comm_class::NACK_MSG_LENGTH) * 1000;
+}
+
+// How each node's clock times its slot:  exact, off by a random amount
+//  up to COMM_CLASS_CLOCK_ERROR permille (plus or minus the 1 ms tick),
+//  or neighbours off the worst way (odd addresses late, even early).
+enum E_Clocks { E_EXACT, E_RANDOM, E_WORST, E_LAST_CLOCKS };
+static const char *CLOCKS_NAME[] = { "exact", "random", "worst" };
+static const int32_t E = COMM_CLASS_CLOCK_ERROR;
+
+// Drift case, nodes and bit error rate
+static const uint8_t DRIFT_NODES[] = { 15, 63, 127 };
+static const double DRIFT_BER = 1e-3;
+static const uint16_t DRIFT_TRIALS = 10;
+
+static const uint8_t SEGMENTS = comm_class::MAX_TRANSFER_SEGMENTS;
+static const uint8_t SEGMENT_LENGTH = event_pool_class::BLOCK_SIZE;
+static const uint8_t TRANSFER_ID = 1;
+
+static const uint16_t TRIALS = 200;
+static const uint8_t MAX_ROUNDS = 50;
+static const uint8_t MAX_COPIES = 4;
+
+static std::mt19937 rng(1);
+
+class link_sim
+{
+public:
+    link_sim(double const &ber, uint8_t const &nodes = NODES,
+             E_Schedule const &schedule = E_REPLY_SLOT, E_Clocks const &clocks = E_EXACT)
+    : now_us(0)
+    , frames(0)
+    , collided(0)
+    , _Ber(ber)
+    , _Nodes(nodes)
+    , _Schedule(schedule)
+    , _Clocks(clocks)
+    , _Node(nodes)
+    , _NodeComm(nodes)
+    , _NodeSink(nodes)
+    , _DoneUs(nodes, 0)
+    , _Polled(nodes, false)
+    , _Error(nodes, 0)
+    {
+        _Controller.select();
+        _ControllerComm = new comm_class;
+        _Controller.attach_uart();
+        _ControllerComm->Attach(&_ControllerSink);
+
+        std::uniform_int_distribution<int32_t> error(-E, E);
+        for (uint8_t ii=0; ii<_Nodes; ii++)
+        {
+            _Node[ii].select();
+            _NodeComm[ii] = new comm_class;
+            _Node[ii].attach_uart();
+            _NodeComm[ii]->Attach(&_NodeSink[ii]);
+            _NodeComm[ii]->setNodeAddress(ii + 1);
+
+            // Address ii + 1, odd addresses late
+            if (_Clocks == E_RANDOM) _Error[ii] = error(rng);
+            if (_Clocks == E_WORST) _Error[ii] = (ii & 1) ? -E : E;
+        }
+    }
+
+    ~link_sim()
+    {
+        delete _ControllerComm;
+        for (uint8_t ii=0; ii<_Nodes; ii++) delete _NodeComm[ii];
+    }
+
+    void send_segment(uint8_t const &index)
+    {
+        uint8_t data[SEGMENT_LENGTH];
+        for (uint8_t jj=0; jj<SEGMENT_LENGTH; jj++) data[jj] = index * 16 + jj;
+
+        _Controller.select();
+        _ControllerComm->encode_segment(TRANSFER_ID, index, SEGMENTS, data, SEGMENT_LENGTH);
+        broadcast();
+    }
+
+    void send_poll()
+    {
+        _Controller.select();
+        _ControllerComm->encode_nack_poll(TRANSFER_ID);
+        broadcast();
+    }
+
+    // Run the NACK time slots after a poll.  maps gets the missing map
+    //  of each node heard from, answered which nodes those are.  Each
+    //  node starts its NACK on its own clock, NACKs that overlap on the
+    //  wire are both lost.
+    void nack_slots(std::vector<uint16_t> &maps, std::vector<bool> &answered)
+    {
+        struct nack { uint32_t start_us; uint32_t end_us; uint8_t node; host_wire wire; };
+        std::vector<nack> nacks;
+        std::uniform_int_distribution<int32_t> tick(-1000, 999);
+
+        uint32_t poll_end_us = now_us;
+        for (uint8_t ii=0; ii<_Nodes; ii++)
+        {
+            answered[ii] = false;
+            if (!_Polled[ii]) continue;
+            _Polled[ii] = false;
+
+            nack n;
+            int64_t delay_us = slot_us(_Schedule, ii + 1);
+            delay_us += delay_us * _Error[ii] / 1000;
+            if (_Clocks == E_RANDOM) delay_us += tick(rng);
+            if (_Clocks == E_WORST) delay_us += (ii & 1) ? -1000 : 999;
+            n.start_us = poll_end_us + (uint32_t)delay_us;
+            n.node = ii;
+            _Node[ii].select();
+            _NodeComm[ii]->encode_nack();
+            _Node[ii].drain(n.wire);
+            n.end_us = n.start_us + host_airtime_us(n.wire.size());
+            frames++;
+            nacks.push_back(n);
+        }
+        std::sort(nacks.begin(), nacks.end(),
+                  [](nack const &a, nack const &b) { return a.start_us < b.start_us; });
+
+        for (size_t kk=0; kk<nacks.size(); kk++)
+        {
+            nack const &n = nacks[kk];
+            if (n.end_us > now_us) now_us = n.end_us;
+            if (((kk > 0) && (nacks[kk-1].end_us > n.start_us)) ||
+                ((kk + 1 < nacks.size()) && (n.end_us > nacks[kk+1].start_us)))
+            {
+                collided++;
+                continue;
+            }
+            deliver(_Controller, *_ControllerComm, _ControllerSink, n.wire);
+
+            for (size_t ee=0; ee<_ControllerSink.events.size(); ee++)
+            {
+                event_element_class const &A = _ControllerSink.events[ee];
+                if ((A.get_current_event() != E_TRANSFER_NACK) || (A.get_payload_length() != 3)) continue;
+
+                uint8_t const *payload = A.get_payload();
+                uint8_t node = A.get_current_data() - 1;
+                if (node >= _Nodes) continue;
+
+                // A NACK for some other transfer is all missing
+                maps[node] = (payload[0] == TRANSFER_ID) ? (((uint16_t)payload[1] << 8) | payload[2]) : 0xFFFF;
+                answered[node] = true;
+            }
+            _ControllerSink.events.clear();
+        }
+
+        // The controller waits out the last slot
+        uint32_t window_end_us = poll_end_us + slot_us(_Schedule, _Nodes + 1);
+        if (now_us < window_end_us) now_us = window_end_us;
+    }
+
+    // Time every node had the whole transfer, 0 if some node is missing
+    //  segments.
+    uint32_t done_us()
+    {
+        uint32_t last = 0;
+        for (uint8_t ii=0; ii<_Nodes; ii++)
+        {
+            if (_DoneUs[ii] == 0) return 0;
+            if (_DoneUs[ii] > last) last = _DoneUs[ii];
+        }
+        return last;
+    }
+
+    uint8_t nodes() { return _Nodes; }
+
+    uint32_t now_us;
+    uint32_t frames;
+    // NACKs lost to overlapping slots
+    uint32_t collided;
+
+private:
+    void broadcast()
+    {
+        host_wire wire;
+        _Controller.drain(wire);
+        frames++;
+        now_us += host_airtime_us(wire.size());
+
+        for (uint8_t ii=0; ii<_Nodes; ii++)
+        {
+            deliver(_Node[ii], *_NodeComm[ii], _NodeSink[ii], wire);
+            for (size_t kk=0; kk<_NodeSink[ii].events.size(); kk++)
+            {
+                event_element_class const &A = _NodeSink[ii].events[kk];
+                if ((A.get_current_event() == E_TRANSFER_COMPLETE) && (_DoneUs[ii] == 0)) _DoneUs[ii] = now_us;
+                if (A.get_current_event() == E_TRANSFER_POLL) _Polled[ii] = true;
+            }
+            _NodeSink[ii].events.clear();
+        }
+    }
+
+    // Each receiver hears its own copy, bits flipped at _Ber
+    void deliver(host_node &node, comm_class &comm, host_sink &sink, host_wire const &wire)
+    {
+        std::uniform_real_distribution<double> chance(0.0, 1.0);
+        for (size_t jj=0; jj<wire.size(); jj++)
+        {
+            uint16_t character = wire[jj];
+            for (uint8_t bb=0; bb<8; bb++)
+            {
+                if (chance(rng) < _Ber) character ^= (1 << bb);
+            }
+            node.rx(character);
+            if (sink.rx_pending)
+            {
+                sink.rx_pending = false;
+                node.select();
+                comm.receive();
+            }
+        }
+    }
+
+    double _Ber;
+    uint8_t _Nodes;
+    E_Schedule _Schedule;
+    E_Clocks _Clocks;
+
+    host_node _Controller;
+    comm_class *_ControllerComm;
+    host_sink _ControllerSink;
+
+    std::vector<host_node> _Node;
+    std::vector<comm_class *> _NodeComm;
+    std::vector<host_sink> _NodeSink;
+    std::vector<uint32_t> _DoneUs;
+    std::vector<bool> _Polled;
+    // Clock error of each node (permille)
+    std::vector<int32_t> _Error;
+};
+
+struct nack_result
+{
+    uint32_t done_us;       // every node had it
+    uint32_t confirmed_us;  // the controller knew
+    uint32_t frames;
+    uint32_t collided;      // NACKs lost to overlapping slots
+    uint8_t rounds;
+};
+
+// Send every segment, then poll and resend the missing segments until
+//  every node reports a ZERO map.
+static nack_result run_nack(link_sim &sim)
+{
+    uint8_t nodes = sim.nodes();
+    for (uint8_t ss=0; ss<SEGMENTS; ss++) sim.send_segment(ss);
+
+    std::vector<bool> confirmed(nodes, false);
+
+    nack_result result = { 0, 0, 0, 0, 0 };
+    for (uint8_t round=0; round<MAX_ROUNDS; round++)
+    {
+        sim.send_poll();
+        result.rounds++;
+
+        std::vector<uint16_t> maps(nodes, 0);
+        std::vector<bool> answered(nodes, false);
+        sim.nack_slots(maps, answered);
+
+        // Resend what the nodes heard from are missing.  Nodes not
+        //  heard from are polled again.
+        uint16_t missing = 0;
+        bool all = true;
+        for (uint8_t ii=0; ii<nodes; ii++)
+        {
+            if (answered[ii])
+            {
+                missing |= maps[ii];
+                confirmed[ii] = (maps[ii] == 0);
+            }
+            all = all && confirmed[ii];
+        }
+        if (all)
+        {
+            result.confirmed_us = sim.now_us;
+            break;
+        }
+        for (uint8_t ss=0; ss<SEGMENTS; ss++)
+        {
+            if (missing & (1U << ss)) sim.send_segment(ss);
+        }
+    }
+    result.done_us = sim.done_us();
+    result.frames = sim.frames;
+    result.collided = sim.collided;
+    return result;
+}
+
+// Send the whole transfer copies times, no feedback
+static uint32_t run_blind(double const &ber, uint8_t const &copies, uint32_t &time_us)
+{
+    link_sim sim(ber);
+    for (uint8_t cc=0; cc<copies; cc++)
+    {
+        for (uint8_t ss=0; ss<SEGMENTS; ss++) sim.send_segment(ss);
+    }
+    time_us = sim.now_us;
+    return sim.done_us();
+}
+
+int main()
+{
+    static const double BER[] = { 0.0, 1e-4, 3e-4, 1e-3, 3e-3 };
+
+    printf("Transfer of %u x %u bytes to %u nodes, BAUD %lu, CRC %u, %u trials\n",
+           (unsigned)SEGMENTS, (unsigned)SEGMENT_LENGTH, (unsigned)NODES,
+           (unsigned long)BAUD, (unsigned)COMM_CLASS_CRC, (unsigned)TRIALS);
+    printf("%-8s | %-28s | %s\n", "", "NACK repair (ms)", "blind repetition (all done %, ms)");
+    printf("%-8s | %7s %7s %6s %5s |", "BER", "done", "confirm", "frames", "ok%");
+    for (uint8_t cc=1; cc<=MAX_COPIES; cc++) printf("  x%u: %4s %6s", cc, "ok%", "ms");
+    printf("\n");
+
+    int failed = 0;
+    for (uint8_t bb=0; bb<sizeof(BER)/sizeof(BER[0]); bb++)
+    {
+        double done_ms = 0;
+        double confirm_ms = 0;
+        double frames = 0;
+        uint16_t ok = 0;
+        for (uint16_t tt=0; tt<TRIALS; tt++)
+        {
+            link_sim sim(BER[bb]);
+            nack_result result = run_nack(sim);
+            if (result.confirmed_us && result.done_us)
+            {
+                ok++;
+                done_ms += result.done_us / 1000.0;
+                confirm_ms += result.confirmed_us / 1000.0;
+            }
+            frames += result.frames;
+        }
+        printf("%-8.0e | %7.1f %7.1f %6.1f %5.1f |", BER[bb],
+               ok ? done_ms / ok : 0.0, ok ? confirm_ms / ok : 0.0, frames / TRIALS, 100.0 * ok / TRIALS);
+        if (ok != TRIALS) failed++;
+
+        for (uint8_t cc=1; cc<=MAX_COPIES; cc++)
+        {
+            uint16_t blind_ok = 0;
+            uint32_t time_us = 0;
+            for (uint16_t tt=0; tt<TRIALS; tt++)
+            {
+                if (run_blind(BER[bb], cc, time_us)) blind_ok++;
+            }
+            printf("  x%u: %4.0f %6.1f", cc, 100.0 * blind_ok / TRIALS, time_us / 1000.0);
+        }
+        printf("\n");
+    }
+
+    // NACK slots timed on drifting clocks, over a lossy link
+    printf("NACK slots with clock error %ld permille, BER %.0e, %u trials\n",
+           (long)E, DRIFT_BER, (unsigned)DRIFT_TRIALS);
+    printf("%-10s %-6s %5s | %9s %7s %9s %5s\n",
+           "slots", "clocks", "nodes", "collided", "rounds", "confirm s", "ok%");
+    for (uint8_t schedule=E_REPLY_SLOT; schedule<E_LAST_SCHEDULE; schedule++)
+    {
+        for (uint8_t clocks=E_RANDOM; clocks<E_LAST_CLOCKS; clocks++)
+        {
+            for (uint8_t nn=0; nn<sizeof(DRIFT_NODES); nn++)
+            {
+                uint16_t ok = 0;
+                uint32_t collided = 0;
+                uint32_t rounds = 0;
+                double confirm_s = 0;
+                for (uint16_t tt=0; tt<DRIFT_TRIALS; tt++)
+                {
+                    link_sim sim(DRIFT_BER, DRIFT_NODES[nn], (E_Schedule)schedule, (E_Clocks)clocks);
+                    nack_result result = run_nack(sim);
+                    collided += result.collided;
+                    rounds += result.rounds;
+                    if (result.confirmed_us && result.done_us)
+                    {
+                        ok++;
+                        confirm_s += result.confirmed_us / 1e6;
+                    }
+                }
+                printf("%-10s %-6s %5u | %9.1f %7.1f %9.1f %5.0f\n",
+                       SCHEDULE_NAME[schedule], CLOCKS_NAME[clocks], (unsigned)DRIFT_NODES[nn],
+                       (double)collided / DRIFT_TRIALS, (double)rounds / DRIFT_TRIALS,
+                       ok ? confirm_s / ok : 0.0, 100.0 * ok / DRIFT_TRIALS);
+
+                // reply_slot_ms() slots must never overlap
+                if ((schedule == E_REPLY_SLOT) && (collided || (ok != DRIFT_TRIALS))) failed++;
+            }
+        }
+    }
+
+    printf("%s\n", failed ? "FAILED" : "ok");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,508 @@
+/****************************************************
+    XBee Radio Simulator
+
+    File:   sim_xbee.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    sim_xbee.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file is a stand-in for the XBee radios, so the XBEE_API_MODE
+     framing can be checked without hardware.  Each radio parses the
+     escaped API frames its node sends (delimiter, length, checksum and
+     escaping), answers TX requests with a TX status and AT commands
+     with an AT response, and hands the RF data to the radios whose MY
+     address matches as RX packets (16 bit address).  The nodes then
+     decode those with api_frame_to_msg().
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <stdio.h>
+#include <vector>
+
+#include "host_node.h"
+
+#ifndef _COMM_CLASS_H_
+#include "comm_class.h"
+#endif
+
+// API frame types (XBee 802.15.4 manual)
+static const uint8_t API_TX_REQUEST_16 = 0x01;
+static const uint8_t API_AT_COMMAND = 0x08;
+static const uint8_t API_RX_PACKET_16 = 0x81;
+static const uint8_t API_AT_RESPONSE = 0x88;
+static const uint8_t API_TX_STATUS = 0x89;
+
+// Escaped API mode (AP=2)
+static const uint8_t API_DELIMITER = 0x7E;
+static const uint8_t API_ESCAPE = 0x7D;
+static const uint8_t API_XON = 0x11;
+static const uint8_t API_XOFF = 0x13;
+static const uint8_t API_ESCAPE_XOR = 0x20;
+
+// TX status
+static const uint8_t TX_SUCCESS = 0x00;
+static const uint8_t TX_NO_ACK = 0x01;
+
+// RX options, address broadcast
+static const uint8_t RX_BROADCAST = 0x02;
+
+static const uint8_t RSSI = 40;
+
+static bool api_special(uint8_t const &A)
+{
+    return (A == API_DELIMITER) || (A == API_ESCAPE) || (A == API_XON) || (A == API_XOFF);
+}
+
+// One RF packet in the air
+class xbee_radio;
+struct air_packet
+{
+    xbee_radio *radio;
+    uint8_t frame_id;
+    uint16_t source;
+    uint16_t dest;
+    std::vector<uint8_t> data;
+};
+
+class xbee_radio
+{
+public:
+    xbee_radio(host_node &node)
+    : my(0xFFFE)
+    , frames(0)
+    , checksum_errors(0)
+    , length_errors(0)
+    , escape_errors(0)
+    , stray_bytes(0)
+    , unknown_frames(0)
+    , _Node(node)
+    , _State(E_HUNT)
+    , _Escape(false)
+    {}
+
+    // Parse the characters the node sent to the radio.  RF packets go
+    //  to air, replies to the node are queued.
+    void from_node(host_wire const &wire, std::vector<air_packet> &air);
+
+    // Queue an RX packet for a packet heard on the air
+    void receive(air_packet const &packet);
+
+    // Queue the TX status of a packet this radio sent.  Unicast
+    //  packets nobody ACKed failed.
+    void sent(air_packet const &packet, bool const &acked);
+
+    // Pass the queued API frames to the node's RX ISR, calling
+    //  receive() whenever the node's main loop would.
+    void deliver(comm_class &comm, host_sink &sink);
+
+    uint16_t my;
+
+    // API frames parsed, and those rejected
+    uint32_t frames;
+    uint32_t checksum_errors;
+    uint32_t length_errors;
+    uint32_t escape_errors;
+    uint32_t stray_bytes;
+    uint32_t unknown_frames;
+
+private:
+    enum E_State { E_HUNT, E_LENGTH_MSB, E_LENGTH_LSB, E_DATA, E_CHECKSUM };
+
+    void frame(std::vector<air_packet> &air);
+    void send(std::vector<uint8_t> const &data);
+    void put(uint8_t const &A);
+
+    host_node &_Node;
+    host_wire _ToNode;
+
+    E_State _State;
+    bool _Escape;
+    uint16_t _Length;
+    std::vector<uint8_t> _Data;
+};
+
+void xbee_radio::from_node(host_wire const &wire, std::vector<air_packet> &air)
+{
+    for (size_t ii=0; ii<wire.size(); ii++)
+    {
+        uint8_t data = (uint8_t)wire[ii];
+
+        if (data == API_DELIMITER)
+        {
+            // A delimiter inside a frame ends it early.
+            if (_State != E_HUNT) length_errors++;
+            _State = E_LENGTH_MSB;
+            _Escape = false;
+            _Data.clear();
+            continue;
+        }
+        if (_State == E_HUNT)
+        {
+            stray_bytes++;
+            continue;
+        }
+        if ((data == API_XON) || (data == API_XOFF))
+        {
+            // Taken as flow control by the radio
+            escape_errors++;
+            continue;
+        }
+        if (data == API_ESCAPE)
+        {
+            _Escape = true;
+            continue;
+        }
+        if (_Escape)
+        {
+            data ^= API_ESCAPE_XOR;
+            _Escape = false;
+
+            // Only the special bytes are escaped
+            if (!api_special(data)) escape_errors++;
+        }
+
+        switch (_State)
+        {
+        case E_LENGTH_MSB:
+            _Length = (uint16_t)data << 8;
+            _State = E_LENGTH_LSB;
+        break;
+        case E_LENGTH_LSB:
+            _Length |= data;
+            _State = (_Length == 0) ? E_HUNT : E_DATA;
+            if (_Length == 0) length_errors++;
+        break;
+        case E_DATA:
+            _Data.push_back(data);
+            if (_Data.size() == _Length) _State = E_CHECKSUM;
+        break;
+        case E_CHECKSUM:
+        {
+            uint8_t sum = data;
+            for (size_t jj=0; jj<_Data.size(); jj++) sum += _Data[jj];
+            if (sum == 0xFF) frame(air);
+            else checksum_errors++;
+            _State = E_HUNT;
+        }
+        break;
+        case E_HUNT:
+        break;
+        }
+    }
+}
+
+void xbee_radio::frame(std::vector<air_packet> &air)
+{
+    frames++;
+
+    switch (_Data[0])
+    {
+    case API_TX_REQUEST_16:
+    {
+        // Type, Frame ID, Destination (2 bytes), Options, RF data
+        if (_Data.size() < 5)
+        {
+            length_errors++;
+            return;
+        }
+        air_packet packet;
+        packet.radio = this;
+        packet.frame_id = _Data[1];
+        packet.source = my;
+        packet.dest = ((uint16_t)_Data[2] << 8) | _Data[3];
+        packet.data.assign(_Data.begin() + 5, _Data.end());
+        air.push_back(packet);
+    }
+    break;
+    case API_AT_COMMAND:
+    {
+        // Type, Frame ID, Command (2 chars), Parameter
+        if (_Data.size() < 4)
+        {
+            length_errors++;
+            return;
+        }
+        uint8_t status = 0;
+        if ((_Data[2] == 'M') && (_Data[3] == 'Y') && (_Data.size() == 6))
+        {
+            my = ((uint16_t)_Data[4] << 8) | _Data[5];
+        }
+        else
+        {
+            status = 1;  // ERROR
+        }
+        if (_Data[1] != 0)
+        {
+            std::vector<uint8_t> response;
+            response.push_back(API_AT_RESPONSE);
+            response.push_back(_Data[1]);
+            response.push_back(_Data[2]);
+            response.push_back(_Data[3]);
+            response.push_back(status);
+            send(response);
+        }
+    }
+    break;
+    default:
+        unknown_frames++;
+    break;
+    }
+}
+
+void xbee_radio::receive(air_packet const &packet)
+{
+    // RX Packet: Type, Source (2 bytes), RSSI, Options, RF data
+    std::vector<uint8_t> rx;
+    rx.push_back(API_RX_PACKET_16);
+    rx.push_back(packet.source >> 8);
+    rx.push_back(packet.source & 0xFF);
+    rx.push_back(RSSI);
+    rx.push_back((packet.dest == comm_class::BROADCAST_ADDRESS) ? RX_BROADCAST : 0);
+    rx.insert(rx.end(), packet.data.begin(), packet.data.end());
+    send(rx);
+}
+
+void xbee_radio::sent(air_packet const &packet, bool const &acked)
+{
+    // Frame ID ZERO asks for no status
+    if (packet.frame_id == 0) return;
+
+    std::vector<uint8_t> status;
+    status.push_back(API_TX_STATUS);
+    status.push_back(packet.frame_id);
+    status.push_back((acked || (packet.dest == comm_class::BROADCAST_ADDRESS)) ? TX_SUCCESS : TX_NO_ACK);
+    send(status);
+}
+
+void xbee_radio::send(std::vector<uint8_t> const &data)
+{
+    _ToNode.push_back(API_DELIMITER);
+    put(data.size() >> 8);
+    put(data.size() & 0xFF);
+    uint8_t sum = 0;
+    for (size_t ii=0; ii<data.size(); ii++)
+    {
+        put(data[ii]);
+        sum += data[ii];
+    }
+    put(0xFF - sum);
+}
+
+void xbee_radio::put(uint8_t const &A)
+{
+    if (api_special(A))
+    {
+        _ToNode.push_back(API_ESCAPE);
+        _ToNode.push_back(A ^ API_ESCAPE_XOR);
+    }
+    else
+    {
+        _ToNode.push_back(A);
+    }
+}
+
+void xbee_radio::deliver(comm_class &comm, host_sink &sink)
+{
+    for (size_t ii=0; ii<_ToNode.size(); ii++)
+    {
+        _Node.rx(_ToNode[ii]);
+        if (sink.rx_pending)
+        {
+            // The main loop gets the notification.
+            sink.rx_pending = false;
+            _Node.select();
+            comm.receive();
+        }
+    }
+    _ToNode.clear();
+}
+
+// A node with its radio
+struct sim_node
+{
+    sim_node() : radio(host) {}
+
+    host_node host;
+    comm_class *comm;
+    host_sink sink;
+    xbee_radio radio;
+};
+
+static const uint8_t NODES = 4;         // controller plus 3 nodes
+static const uint16_t NO_RADIO = comm_class::NODE_ADDRESS_BASE + 0x7F;
+
+// Hand the frames every node sent to its radio, then put the packets
+//  on the air.  Unicast packets to a radio nobody has get a NO ACK
+//  status.
+static void air_time(sim_node *node)
+{
+    std::vector<air_packet> air;
+    for (uint8_t ii=0; ii<NODES; ii++)
+    {
+        host_wire wire;
+        node[ii].host.drain(wire);
+        node[ii].radio.from_node(wire, air);
+    }
+
+    for (size_t pp=0; pp<air.size(); pp++)
+    {
+        bool acked = false;
+        for (uint8_t ii=0; ii<NODES; ii++)
+        {
+            if (&node[ii].radio == air[pp].radio) continue;
+            if ((air[pp].dest == comm_class::BROADCAST_ADDRESS) ||
+                (air[pp].dest == node[ii].radio.my))
+            {
+                node[ii].radio.receive(air[pp]);
+                acked = true;
+            }
+        }
+        air[pp].radio->sent(air[pp], acked);
+    }
+
+    for (uint8_t ii=0; ii<NODES; ii++)
+    {
+        node[ii].radio.deliver(*node[ii].comm, node[ii].sink);
+    }
+}
+
+int main()
+{
+    sim_node node[NODES];
+    for (uint8_t ii=0; ii<NODES; ii++)
+    {
+        node[ii].host.select();
+        node[ii].comm = new comm_class;
+        node[ii].host.attach_uart();
+        node[ii].comm->Attach(&node[ii].sink);
+    }
+
+    // The controller's radio is set up by the PC, the nodes set their
+    //  own MY address.
+    node[0].radio.my = comm_class::CONTROLLER_ADDRESS;
+    for (uint8_t ii=1; ii<NODES; ii++)
+    {
+        node[ii].host.select();
+        node[ii].comm->setNodeAddress(ii);
+    }
+    air_time(node);
+
+    int failed = 0;
+    for (uint8_t ii=1; ii<NODES; ii++)
+    {
+        if (node[ii].radio.my != comm_class::radio_address(ii))
+        {
+            printf("node %u: radio MY 0x%04X, expected 0x%04X\n",
+                   ii, node[ii].radio.my, comm_class::radio_address(ii));
+            failed++;
+        }
+    }
+
+    // Unicast to each node, a broadcast, and a universe msg with every
+    //  byte one the radio needs escaped.
+    uint8_t const slots = 3;
+    uint8_t rgb[3 * slots];
+    uint8_t const special[] = { API_DELIMITER, API_ESCAPE, API_XON, API_XOFF };
+    for (uint8_t jj=0; jj<sizeof(rgb); jj++) rgb[jj] = special[jj % sizeof(special)];
+
+    node[0].host.select();
+    for (uint8_t ii=1; ii<NODES; ii++)
+    {
+        node[0].comm->encode(event_element_class(E_RGB_CONTROLLER, E_SET_RED, ii), comm_class::radio_address(ii));
+    }
+    node[0].comm->encode(event_element_class(E_RGB_CONTROLLER, E_SET_GREEN, 0));
+    node[0].comm->encode_universe(1, rgb, slots);
+    air_time(node);
+
+    // Each node answers the controller
+    for (uint8_t ii=1; ii<NODES; ii++)
+    {
+        node[ii].host.select();
+        node[ii].comm->encode(event_element_class(E_RGB_NODE, E_LED_RED_PWM, ii), comm_class::CONTROLLER_ADDRESS);
+    }
+    air_time(node);
+
+    // A unicast nobody ACKs.  The radio reports the failure in the TX
+    //  status.
+    node[0].host.select();
+    node[0].comm->encode(event_element_class(E_RGB_CONTROLLER, E_SET_BLUE, 1), NO_RADIO);
+    air_time(node);
+
+    // Every node gets its unicast, the broadcast and its universe slot,
+    //  the controller gets the three answers.
+    uint8_t const EVENTS = 3;
+
+    printf("XBee API mode, %u radios, CRC %u\n", (unsigned)NODES, (unsigned)COMM_CLASS_CRC);
+    printf("%-10s %6s %7s %7s %7s %7s %7s %7s %7s\n",
+           "node", "MY", "frames", "cksum", "length", "escape", "stray", "events", "crc err");
+    for (uint8_t ii=0; ii<NODES; ii++)
+    {
+        xbee_radio const &radio = node[ii].radio;
+        printf("%-10u 0x%04X %7u %7u %7u %7u %7u %7u %7u\n",
+               ii, radio.my, (unsigned)radio.frames, (unsigned)radio.checksum_errors,
+               (unsigned)radio.length_errors, (unsigned)radio.escape_errors,
+               (unsigned)radio.stray_bytes, (unsigned)node[ii].sink.events.size(),
+               node[ii].comm->getCrcErrorCount());
+        if (radio.checksum_errors || radio.length_errors || radio.escape_errors ||
+            radio.stray_bytes || radio.unknown_frames || node[ii].comm->getCrcErrorCount() ||
+            (node[ii].sink.events.size() != EVENTS))
+        {
+            failed++;
+        }
+        for (size_t jj=0; jj<node[ii].sink.events.size(); jj++)
+        {
+            event_element_class const &A = node[ii].sink.events[jj];
+            if ((A.get_current_event() == E_SET_RED) && (A.get_current_data() != ii)) failed++;
+            if ((A.get_current_event() == E_LED_RED_PWM) && (ii != 0)) failed++;
+        }
+    }
+
+    printf("unicast without an ACK: TX status errors %u\n", node[0].comm->getTxStatusErrorCount());
+    if (node[0].comm->getTxStatusErrorCount() != 1) failed++;
+
+    // Set the MY address right after a frame the TX ring had no room
+    //  for.  The AT command must still go out whole.
+    node[1].host.select();
+    uint16_t rejects = node[1].comm->getTxRejectCount();
+    while (node[1].comm->getTxRejectCount() == rejects)
+    {
+        node[1].comm->encode_universe(1, rgb, slots);
+    }
+    air_time(node);
+    uint32_t length_errors = node[1].radio.length_errors;
+    node[1].radio.my = 0;
+    node[1].host.select();
+    node[1].comm->setNodeAddress(1);
+    air_time(node);
+    printf("ATMY after a rejected frame: MY 0x%04X, length errors %u\n",
+           node[1].radio.my, (unsigned)(node[1].radio.length_errors - length_errors));
+    if ((node[1].radio.my != comm_class::radio_address(1)) ||
+        (node[1].radio.length_errors != length_errors))
+    {
+        failed++;
+    }
+
+    printf("%s\n", failed ? "FAILED" : "ok");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,17 @@
+#ifndef _HOST_UTIL_ATOMIC_H_
+#define _HOST_UTIL_ATOMIC_H_
+
+// Host stand-in for <util/atomic.h>.  Host programs call the ISR code
+//  from the one thread, so the blocks just run once.
+
+#include <avr/io.h>
+
+#define ATOMIC_RESTORESTATE      1
+#define ATOMIC_FORCEON           1
+#define NONATOMIC_RESTORESTATE   1
+#define NONATOMIC_FORCEOFF       1
+
+#define ATOMIC_BLOCK(type)    for (int _host_atomic = 1; _host_atomic; _host_atomic = 0)
+#define NONATOMIC_BLOCK(type) for (int _host_nonatomic = 1; _host_nonatomic; _host_nonatomic = 0)
+
+#endif
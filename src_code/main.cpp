@@ -31,6 +31,8 @@
      When         Who                Description of change
     -----------  ----------         ------------------------
     2014 Nov 18  James Stokebrand   Initial creation.
+    2026 Oct 18  James Stokebrand   Restore OSCCAL at boot.
+    2026 Oct 18  James Stokebrand   Push status msgs after each event.
 
 *****************************************************/
 
@@ -94,6 +96,10 @@ LOCKBIT = 0xFF (valid)
 #include "mcu_sleep_class.h"
 #endif
 
+#ifndef _OSCCAL_CLASS_H_
+#include "osccal_class.h"
+#endif
+
 
 int main(void)
 {
@@ -119,6 +125,11 @@ int main(void)
     mcu_sleep_class::getInstance()->SetInputAndPullupResistor(IOPinDefines::E_PinDef::E_PIN_PB4);
     mcu_sleep_class::getInstance()->SetInputAndPullupResistor(IOPinDefines::E_PinDef::E_PIN_PB3);
 
+#if OSCCAL_CALIBRATION
+    // Restore the calibrated RC oscillator before the UART is set up.
+    osccal_class::getInstance()->Load();
+#endif
+
     // Event queue 
     EventQueue event_queue;
 
@@ -143,6 +154,12 @@ int main(void)
         {
             // Process events throught the RGB Node state machine
             RGB_Node.process(anEvent);
+
+            // Color or state changed?  Tell the controller.
+            RGB_Node.push_status();
+
+            // Done with this event.  Return its payload to the event pool.
+            anEvent.clear();
         } else {
 
             // Nothing in the queue ... go to sleep
@@ -0,0 +1,147 @@
+/****************************************************
+    Node Identity Class
+
+    File:   node_identity.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    node_identity.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file keeps what makes a node itself across power cycles: its
+     unique ID, the address the controller assigned to it and the
+     groups it is in (all saved in EEPROM), plus the random numbers
+     used to pick answer slots.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+    2026 Oct 18  James Stokebrand   Boot count seeds the random numbers.
+
+*****************************************************/
+
+#include <avr/eeprom.h>
+
+#ifndef _NODE_IDENTITY_H_
+#include "node_identity.h"
+#endif
+
+// Passed by reference, so they need a definition.
+const uint8_t node_identity_class::UID_LENGTH;
+const uint8_t node_identity_class::GROUP_MASK;
+
+// Saved unique ID (an erased EEPROM reads all 0xFF), and the assigned
+//  address and group mask, each followed by its complement.
+static uint8_t EEMEM ee_uid[node_identity_class::UID_LENGTH];
+static uint8_t EEMEM ee_assigned_address[2];
+static uint8_t EEMEM ee_group_mask[2];
+
+// Boots so far (wraps)
+static uint16_t EEMEM ee_boot_count;
+
+node_identity_class::node_identity_class()
+{
+    _UidValid = false;
+    for (uint8_t jj=0; jj<UID_LENGTH; jj++)
+    {
+        _Uid[jj] = eeprom_read_byte(&ee_uid[jj]);
+        if (_Uid[jj] != 0xFF) _UidValid = true;
+    }
+
+    uint8_t value = eeprom_read_byte(&ee_group_mask[0]);
+    uint8_t check = eeprom_read_byte(&ee_group_mask[1]);
+    _GroupMask = (value == (uint8_t)~check) ? (value & GROUP_MASK) : 0;
+
+    uint16_t boots = eeprom_read_word(&ee_boot_count) + 1;
+    eeprom_update_word(&ee_boot_count, boots);
+
+    _Random = ((uint32_t)boots << 16) | boots;
+    for (uint8_t jj=0; jj<UID_LENGTH; jj++)
+    {
+        _Random ^= (uint32_t)_Uid[jj] << (8 * (UID_LENGTH - 1 - jj));
+    }
+    if (_Random == 0) _Random = 1;
+}
+
+void node_identity_class::makeUid()
+{
+    if (_UidValid) return;
+
+    // Each state is a different ID, skip the one that reads as erased.
+    uint32_t uid;
+    do {
+        uid = next();
+    } while (uid == 0xFFFFFFFFUL);
+
+    for (uint8_t jj=0; jj<UID_LENGTH; jj++)
+    {
+        _Uid[jj] = uid >> 24;
+        uid <<= 8;
+        eeprom_update_byte(&ee_uid[jj], _Uid[jj]);
+    }
+    _UidValid = true;
+}
+
+uint8_t node_identity_class::loadAssignedAddress()
+{
+    uint8_t value = eeprom_read_byte(&ee_assigned_address[0]);
+    uint8_t check = eeprom_read_byte(&ee_assigned_address[1]);
+
+    if ((value == (uint8_t)~check) && !(value & ~GROUP_MASK)) return value;
+    return 0;
+}
+
+void node_identity_class::saveAssignedAddress(uint8_t const &A)
+{
+    eeprom_update_byte(&ee_assigned_address[0], A);
+    eeprom_update_byte(&ee_assigned_address[1], ~A);
+}
+
+void node_identity_class::setGroupMask(uint8_t const &mask)
+{
+    _GroupMask = mask & GROUP_MASK;
+
+    eeprom_update_byte(&ee_group_mask[0], _GroupMask);
+    eeprom_update_byte(&ee_group_mask[1], ~_GroupMask);
+}
+
+void node_identity_class::stirRandom(uint32_t const &seed)
+{
+    _Random ^= seed;
+    if (_Random == 0) _Random = 1;
+}
+
+uint32_t node_identity_class::next()
+{
+    _Random ^= _Random << 13;
+    _Random ^= _Random >> 17;
+    _Random ^= _Random << 5;
+
+    return _Random;
+}
+
+uint8_t node_identity_class::random(uint8_t const &range)
+{
+    return (uint8_t)(((next() >> 16) * range) >> 16);
+}
+
+uint16_t node_identity_class::random16()
+{
+    return next() >> 16;
+}
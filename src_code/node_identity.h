@@ -0,0 +1,97 @@
+#ifndef _NODE_IDENTITY_H_
+#define _NODE_IDENTITY_H_
+
+/****************************************************
+    Node Identity Class
+
+    File:   node_identity.h
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    node_identity.h file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file keeps what makes a node itself across power cycles: its
+     unique ID, the address the controller assigned to it and the
+     groups it is in (all saved in EEPROM), plus the random numbers
+     used to pick answer slots.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+    2026 Oct 18  James Stokebrand   Boot count and unique ID seed the
+                                      random numbers, random16().
+
+*****************************************************/
+
+#include <avr/io.h>
+#include <stdbool.h>
+
+class node_identity_class
+{
+public:
+    // Loads the unique ID and groups saved in EEPROM and counts the
+    //  boot.  The random numbers start from the unique ID and boot
+    //  count, so they differ per node and per boot before any timer
+    //  is stirred in.
+    node_identity_class();
+
+    /*
+        Each node has a random unique ID, made on the first call to
+        makeUid() (the first ANNOUNCE) and saved in EEPROM.  An erased
+        EEPROM reads all 0xFF, so that ID is never used.
+    */
+    static const uint8_t UID_LENGTH = 4;
+    uint8_t const *getUid() { return _Uid; }
+    bool isUidValid() { return _UidValid; }
+
+    // Make (and save) a unique ID if there is none yet.
+    void makeUid();
+
+    // Address saved by an ASSIGN msg (ZERO if none or not valid).
+    uint8_t loadAssignedAddress();
+    // Save an assigned address (1 to 0x7F, ZERO to forget it).
+    void saveAssignedAddress(uint8_t const &A);
+
+    // Groups this node is in (bit 7 always clear, see
+    //  comm_class::GROUP_ADDRESS_FLAG).  Set saves them in EEPROM.
+    static const uint8_t GROUP_MASK = 0x7F;
+    uint8_t getGroupMask() { return _GroupMask; }
+    void setGroupMask(uint8_t const &mask);
+
+    // Mix seed (timer counts etc.) into the random number generator.
+    //  The unique ID is the generator's 32 bit state, so stir in every
+    //  bit that differs between nodes before the first ANNOUNCE.
+    void stirRandom(uint32_t const &seed);
+    // Random number from 0 to range - 1 (range not ZERO)
+    uint8_t random(uint8_t const &range);
+    // Random number from 0 to 0xFFFF
+    uint16_t random16();
+
+private:
+    uint8_t _Uid[UID_LENGTH];
+    bool _UidValid;
+    uint8_t _GroupMask;
+    uint32_t _Random;
+
+    // Next 32 bit xorshift (13,17,5) state
+    uint32_t next();
+};
+
+#endif
@@ -0,0 +1,122 @@
+/****************************************************
+    Node Report Class
+
+    File:   node_report.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    node_report.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file builds the reports a node sends the controller: the
+     STATUS report (color, state and counters) and the pages of the
+     STATS report (link and delivery counters).  The comm class frames
+     and sends them.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <util/atomic.h>
+
+#ifndef _NODE_REPORT_H_
+#include "node_report.h"
+#endif
+
+#ifndef _COMM_CLASS_H_
+#include "comm_class.h"
+#endif
+
+#ifndef _EVENT_POOL_H_
+#include "event_pool.h"
+#endif
+
+// Passed by reference, so they need a definition.
+const uint8_t node_report_class::STATUS_PAYLOAD_LENGTH;
+const uint8_t node_report_class::STATS_PAGE_LINK;
+const uint8_t node_report_class::STATS_PAGE_DELIVERY;
+const uint8_t node_report_class::STATS_PAYLOAD_LENGTH;
+
+uint8_t *node_report_class::put16(uint8_t *report, uint16_t const &value)
+{
+    *report++ = value >> 8;
+    *report++ = value & 0xFF;
+    return report;
+}
+
+void node_report_class::status(uint8_t *report, comm_class &comm,
+                               uint8_t const &state, uint16_t const *rgb,
+                               uint8_t const &queue_high, uint32_t const &uptime_s)
+{
+    // Rejected frames of any kind (saturates at 0xFFFF)
+    uint32_t rejected = (uint32_t)comm.getCrcErrorCount() + comm.getLengthErrorCount() +
+                        comm.getInvalidCount();
+    if (rejected > 0xFFFF) rejected = 0xFFFF;
+
+    *report++ = state;
+    for (uint8_t jj=0; jj<3; jj++)
+    {
+        report = put16(report, rgb[jj]);
+    }
+    *report++ = queue_high;
+    *report++ = event_pool_class::HighWaterMark();
+    report = put16(report, rejected);
+    report = put16(report, uptime_s >> 16);
+    report = put16(report, uptime_s & 0xFFFF);
+}
+
+void node_report_class::stats(uint8_t *report, comm_class &comm, uint8_t const &page)
+{
+    uint16_t counts[7];
+    uint8_t last = 0;
+
+    // The RX ISR may be counting
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (page == STATS_PAGE_DELIVERY)
+        {
+            counts[0] = comm.getRealtimeLostCount();
+            counts[1] = comm.getRealtimeLateCount();
+            counts[2] = comm.getRealtimeSupersededCount();
+            counts[3] = comm.getFilteredCount();
+            counts[4] = comm.getTxRejectCount();
+            counts[5] = comm.getTxDropCount();
+            counts[6] = event_pool_class::ExhaustedCount();
+        }
+        else
+        {
+            counts[0] = comm.getFramingErrorCount();
+            counts[1] = comm.getOverrunCount();
+            counts[2] = comm.getOverflowCount();
+            counts[3] = comm.getEscapeErrorCount();
+            counts[4] = comm.getResyncCount();
+            counts[5] = comm.getLengthErrorCount();
+            counts[6] = comm.getCrcErrorCount();
+        }
+    }
+    if (page != STATS_PAGE_DELIVERY) last = comm.getErrorRate();
+
+    *report++ = (page == STATS_PAGE_DELIVERY) ? STATS_PAGE_DELIVERY : STATS_PAGE_LINK;
+    for (uint8_t jj=0; jj<7; jj++)
+    {
+        report = put16(report, counts[jj]);
+    }
+    *report = last;
+}
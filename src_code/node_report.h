@@ -0,0 +1,85 @@
+#ifndef _NODE_REPORT_H_
+#define _NODE_REPORT_H_
+
+/****************************************************
+    Node Report Class
+
+    File:   node_report.h
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    node_report.h file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file builds the reports a node sends the controller: the
+     STATUS report (color, state and counters) and the pages of the
+     STATS report (link and delivery counters).  The comm class frames
+     and sends them.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <avr/io.h>
+
+class comm_class;
+
+/*
+    STATUS report (STATUS_PAYLOAD_LENGTH bytes):
+        State       (1 byte, feedback event of the state, E_LED_RED_PWM ...)
+        Red, Green, Blue (6 bytes, 16 bit MSB first)
+        Event queue high water (1 byte)
+        Event pool high water  (1 byte)
+        Rejected frames (2 bytes MSB first, CRC + length + invalid)
+        Uptime      (4 bytes MSB first, seconds)
+
+    STATS report (STATS_PAYLOAD_LENGTH bytes):
+        Page        (1 byte, STATS_PAGE_LINK or STATS_PAGE_DELIVERY)
+        7 counters  (2 bytes each MSB first, see comm_class.h)
+        Last byte   (1 byte, error rate on STATS_PAGE_LINK, else ZERO)
+
+    Counters saturate at 0xFFFF.
+*/
+class node_report_class
+{
+public:
+    static const uint8_t STATUS_PAYLOAD_LENGTH = 15;
+
+    static const uint8_t STATS_PAGE_LINK = 0;
+    static const uint8_t STATS_PAGE_DELIVERY = 1;
+    static const uint8_t STATS_PAYLOAD_LENGTH = 16;
+
+    // Fill report with this node's STATUS.  The pool high water and
+    //  rejected frames are read here.
+    static void status(uint8_t *report, comm_class &comm,
+                       uint8_t const &state, uint16_t const *rgb,
+                       uint8_t const &queue_high, uint32_t const &uptime_s);
+
+    // Fill report with a page of this node's STATS.  Unknown pages
+    //  send STATS_PAGE_LINK.
+    static void stats(uint8_t *report, comm_class &comm, uint8_t const &page);
+
+private:
+    // Store value MSB first, returns the next byte.
+    static uint8_t *put16(uint8_t *report, uint16_t const &value);
+};
+
+#endif
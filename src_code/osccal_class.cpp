@@ -0,0 +1,131 @@
+
+/****************************************************
+    OSCCAL Class
+
+    File:   osccal_class.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    osccal_class.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file trims the internal RC oscillator (OSCCAL) against the
+     bit rate of a sync msg from the controller.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <avr/eeprom.h>
+
+#ifndef _OSCCAL_CLASS_H_
+#include "osccal_class.h"
+#endif
+
+#ifndef _MCU_SLEEP_CLASS_H_
+#include "mcu_sleep_class.h"
+#endif
+
+// Saved OSCCAL and its complement (an erased EEPROM reads 0xFF 0xFF)
+static uint8_t EEMEM ee_osccal[2];
+
+osccal_class* osccal_class::m_pInstance = nullptr;
+
+osccal_class* osccal_class::getInstance()
+{
+    return m_pInstance ? m_pInstance : (m_pInstance = new osccal_class);
+}
+
+osccal_class::osccal_class()
+: _Running(false)
+, _Error(0)
+{
+}
+
+void osccal_class::Load()
+{
+    uint8_t value = eeprom_read_byte(&ee_osccal[0]);
+    uint8_t check = eeprom_read_byte(&ee_osccal[1]);
+
+    if (value == (uint8_t)~check)
+    {
+        OSCCAL = value;
+    }
+}
+
+void osccal_class::Start()
+{
+    if (_Running) return;
+
+    // Power up Timer1 and let it run free
+    mcu_sleep_class::getInstance()->SetInterfaceUsage(
+            mcu_sleep_class::E_TIMER_ONE_INTERFACE,
+            mcu_sleep_class::E_POWER_INTERFACE_DISABLE_POWER_SAVINGS);
+
+    TCCR1A = 0;
+    TCNT1 = 0;
+    TCCR1B = (1 << CS11);   /* start timer (ck/8 prescalar) */
+
+    _Running = true;
+}
+
+void osccal_class::Stop(bool const &save)
+{
+    if (!_Running) return;
+
+    TCCR1B = 0;
+    mcu_sleep_class::getInstance()->SetInterfaceUsage(
+            mcu_sleep_class::E_TIMER_ONE_INTERFACE,
+            mcu_sleep_class::E_POWER_INTERFACE_ENABLE_POWER_SAVINGS);
+
+    if (save)
+    {
+        eeprom_update_byte(&ee_osccal[0], OSCCAL);
+        eeprom_update_byte(&ee_osccal[1], ~OSCCAL);
+    }
+
+    _Running = false;
+}
+
+bool osccal_class::Measure(uint16_t const &ticks, uint8_t const &bytes)
+{
+    if (!_Running) return false;
+
+    // Too short to be accurate, or too long for 16 bits of Timer1.
+    uint32_t expected = ((uint32_t)bytes * 10UL * (F_CPU / OSCCAL_TIMER_PRESCALE)) / BAUD;
+    if ((bytes < MIN_SYNC_BYTES) || (expected > 0xF000)) return false;
+
+    // A fast oscillator counts more ticks than it should.
+    _Error = (int16_t)((((int32_t)ticks - (int32_t)expected) * 1000L) / (int32_t)expected);
+
+    // One step at a time so the UART never jumps too far.  OSCCAL has
+    //  two overlapping ranges, stay in the current one.
+    if ((_Error > DEADBAND) && ((OSCCAL & 0x7F) != 0x00))
+    {
+        OSCCAL = OSCCAL - 1;
+    }
+    else if ((_Error < -DEADBAND) && ((OSCCAL & 0x7F) != 0x7F))
+    {
+        OSCCAL = OSCCAL + 1;
+    }
+
+    return true;
+}
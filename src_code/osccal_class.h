@@ -0,0 +1,110 @@
+#ifndef _OSCCAL_CLASS_H_
+#define _OSCCAL_CLASS_H_
+
+/****************************************************
+    OSCCAL Class
+
+    File:   osccal_class.h
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    osccal_class.h file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file trims the internal RC oscillator (OSCCAL) against the
+     bit rate of a sync msg from the controller.  The UART RX ISR
+     time stamps each byte with Timer1.  A burst of back to back
+     bytes lasts exactly 10 bit times per byte at the radio's
+     (crystal) baud rate, so the number of Timer1 ticks it took
+     tells how far off the RC oscillator is.
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+
+*****************************************************/
+
+#include <avr/io.h>
+
+// Set OSCCAL_CALIBRATION to 1 to time stamp RXed bytes and trim
+//  OSCCAL from sync msgs.
+#ifndef OSCCAL_CALIBRATION
+    #define OSCCAL_CALIBRATION 0
+#endif
+
+// Timer1 prescaler while calibrating (ck/8)
+#define OSCCAL_TIMER_PRESCALE 8UL
+
+class osccal_class
+{
+public:
+    static osccal_class* getInstance();
+
+    // Timer1 ticks in one byte (10 bits) at BAUD
+    static const uint16_t TICKS_PER_BYTE = (10UL * (F_CPU / OSCCAL_TIMER_PRESCALE)) / BAUD;
+
+    // Fewest bytes in a burst worth measuring
+    static const uint8_t MIN_SYNC_BYTES = 8;
+
+    // Time stamp for the UART RX ISR
+    static inline uint16_t Stamp() { return TCNT1; }
+
+    // Restore OSCCAL from EEPROM (if it was saved).  Call at boot.
+    void Load();
+
+    // Start Timer1 and accept sync bursts
+    void Start();
+
+    // Stop Timer1.  Save OSCCAL to EEPROM if save is true.
+    void Stop(bool const &save);
+
+    bool isRunning() { return _Running; }
+
+    // A sync burst of bytes (back to back) took ticks Timer1 ticks.
+    //  Moves OSCCAL one step toward the right rate.  Returns false if
+    //  not running or the burst can't be used.
+    bool Measure(uint16_t const &ticks, uint8_t const &bytes);
+
+    // Error (in 0.1%, positive is fast) of the last measurement
+    int16_t getError() { return _Error; }
+
+private:
+    // Constructor is private for singleton
+    osccal_class();
+
+    // Copy constructor is private for singleton
+    osccal_class(osccal_class const&);
+
+    // Reference to itself
+    static osccal_class* m_pInstance;
+
+    // Destructor is private for singletons
+    ~osccal_class() {}
+
+    // Equal operator is private for singletons
+    void operator=(osccal_class const&);
+
+    // Errors within half an OSCCAL step (about 0.8%) are left alone
+    static const int16_t DEADBAND = 4;
+
+    bool    _Running;
+    int16_t _Error;
+};
+
+#endif
@@ -39,6 +39,8 @@
      When         Who                Description of change
     -----------  ----------         ------------------------
     2014 Oct 05  James Stokebrand   Initial Creation
+    2026 Oct 18  James Stokebrand   Added 16 bit values.  The low byte
+                                      is dithered across PWM periods.
 
 *****************************************************/
 
@@ -55,7 +57,12 @@ TIMER2_interrupt_subject aTIMER2_Inter;
 pwm_class::pwm_class(IOPinDefines::E_PinDef const &A
     , bool const &CommonCathode
     , uint8_t const &StartValue)
-: _ObserverID(0xFF)
+: _PwmValue16(0)
+, _PwmBase(0)
+, _PwmFraction(0)
+, _PwmValue(0)
+, _DitherAccumulator(0)
+, _ObserverID(0xFF)
 {
 
     if (CommonCathode) 
@@ -78,16 +85,26 @@ pwm_class::pwm_class(IOPinDefines::E_PinDef const &A
 
 void pwm_class::setValue(uint8_t const &A)
 {
+    // 0xFF expands to 0xFFFF
+    setValue16(A * 257U);
+}
+
+void pwm_class::setValue16(uint16_t const &A)
+{
+    _PwmValue16 = A;
+
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        _PwmValue = A;
+        _PwmBase = A >> 8;
+        _PwmFraction = A & 0xFF;
+        _PwmValue = _PwmBase;
     }
 
 #if 1
     // If the value is ON or OFF
-    if (_PwmValue == 0x00) { 
+    if (_PwmValue16 == 0x0000) { 
         Off(); // Detach and turn led OFF
         return; // Return here to avoid the _ObserverID check below
-    } else if (_PwmValue == 0xFF) {
+    } else if (_PwmValue16 == 0xFFFF) {
         On();  // Detach and turn led ON
         return; // Return here to avoid the _ObserverID check below
     } 
@@ -134,22 +151,30 @@ void pwm_class::Off()
 void pwm_class::Toggle()
 {
     // Flip the value (pwm based)
-    uint8_t temp;
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        temp = _PwmValue;
-    }
-    if ((temp == 0xFF) || (temp == 0))
+    uint16_t temp = _PwmValue16;
+    if ((temp == 0xFFFF) || (temp == 0))
     {
         _LED->Toggle();
     } else {
-        temp += 128;
-        setValue(temp);
+        temp += 0x8000;
+        setValue16(temp);
     }
 }
 
 // Update is called from the Timer ISR
 void pwm_class::Update(uint8_t const &_Pwm)
 {
+    if (_Pwm == 0)
+    {
+        // Start of a new PWM period.  Dither the low byte of the
+        //  16 bit value by carrying it into this period's duty cycle.
+        uint8_t temp = _DitherAccumulator + _PwmFraction;
+        uint8_t duty = _PwmBase;
+        if ((temp < _DitherAccumulator) && (duty < 0xFF)) duty++;
+        _DitherAccumulator = temp;
+        _PwmValue = duty;
+    }
+
     if (_PwmValue <= _Pwm)
     {
         _LED->Off();
@@ -42,6 +42,8 @@
      When         Who                Description of change
     -----------  ----------         ------------------------
     2014 Oct 05  James Stokebrand   Initial Creation
+    2026 Oct 18  James Stokebrand   Added 16 bit values.  The low byte
+                                      is dithered across PWM periods.
 
 *****************************************************/
 
@@ -62,6 +64,7 @@ public:
             , uint8_t const &_StartValue = 0);
 
     void setValue(uint8_t const &A);
+    void setValue16(uint16_t const &A);
     void setPercent(uint8_t const &A);
     void On();
     void Off();
@@ -69,14 +72,33 @@ public:
 
     inline uint8_t getValue()
     {
-        return _PwmValue;
+        return _PwmValue16 >> 8;
+    }
+
+    inline uint16_t getValue16()
+    {
+        return _PwmValue16;
     }
 
 protected:
     void Update(uint8_t const &_Pwm);
 
 private:
+    // 16 bit value requested by the user
+    uint16_t _PwmValue16;
+
+    // High and low bytes of _PwmValue16 for use in the ISR
+    volatile uint8_t _PwmBase;
+    volatile uint8_t _PwmFraction;
+
+    // Duty cycle of the current PWM period.  This is _PwmBase
+    //  plus the carry from the dither accumulator.
     volatile uint8_t _PwmValue;
+
+    // _PwmFraction is added to this accumulator each PWM period.
+    //  Every carry adds one count to that period.
+    volatile uint8_t _DitherAccumulator;
+
     uint8_t _ObserverID;
     OutputPinClass *_LED;
 
@@ -32,6 +32,9 @@
      When         Who                Description of change
     -----------  ----------         ------------------------
     2014 Oct 15  James Stokebrand   Initial creation.
+    2026 Oct 18  James Stokebrand   Colors are kept with 16 bits per
+                                      channel down to the PWM layer.
+    2026 Oct 18  James Stokebrand   Added color fades.
 
 *****************************************************/
 
@@ -41,19 +44,70 @@
 
 
 void rgb_led_class::set(RgbColor const &A)
+{
+    set(RgbColor16(A));
+}
+
+void rgb_led_class::set(RgbColor16 const &A)
+{
+    // A new color stops the fade (if any)
+    _FadeSteps = _FadeStep = 0;
+
+    show(A);
+}
+
+void rgb_led_class::show(RgbColor16 const &A)
 {
     // Scale and set the RGB value
-    red_led.setValue(A.r*red_scale_value);
-    green_led.setValue(A.g*green_scale_value);
-    blue_led.setValue(A.b*blue_scale_value);
+    apply(A);
 
-    RGB_currentColor.r = A.r;
-    RGB_currentColor.g = A.g;
-    RGB_currentColor.b = A.b;
+    RGB16_currentColor = A;
+    A.get(RGB_currentColor);
 
     HSL_color_valid = false;
 }
 
+void rgb_led_class::fade(RgbColor16 const &A, uint16_t const &steps)
+{
+    if (steps == 0)
+    {
+        set(A);
+        return;
+    }
+
+    _FadeFrom = RGB16_currentColor;
+    _FadeTo = A;
+    _FadeSteps = steps;
+    _FadeStep = 0;
+}
+
+// Linear step from A to B
+static uint16_t fade_value(uint16_t const &A, uint16_t const &B, uint16_t const &step, uint16_t const &steps)
+{
+    return A + (int32_t)((int32_t)B - A) * step / steps;
+}
+
+bool rgb_led_class::FadeStep()
+{
+    if (!isFading()) return false;
+
+    _FadeStep++;
+
+    RgbColor16 B(fade_value(_FadeFrom.r, _FadeTo.r, _FadeStep, _FadeSteps)
+                ,fade_value(_FadeFrom.g, _FadeTo.g, _FadeStep, _FadeSteps)
+                ,fade_value(_FadeFrom.b, _FadeTo.b, _FadeStep, _FadeSteps));
+    show(B);
+
+    return isFading();
+}
+
+void rgb_led_class::apply(RgbColor16 const &A)
+{
+    red_led.setValue16(A.r*red_scale_value);
+    green_led.setValue16(A.g*green_scale_value);
+    blue_led.setValue16(A.b*blue_scale_value);
+}
+
 #if SUPPORT_HSV_COLOR
 void rgb_led_class::set(HsvColor const &A)
 {
@@ -66,7 +120,7 @@ void rgb_led_class::set(HsvColor const &A)
 void rgb_led_class::set(HslColor const &A)
 {
     HSL_currentColor = A;
-    RgbColor B;
+    RgbColor16 B;
     hslToRgb(A,B);
     set(B);
 
@@ -84,6 +138,11 @@ void rgb_led_class::get(RgbColor &A)
     A.b = RGB_currentColor.b;
 }
 
+void rgb_led_class::get(RgbColor16 &A)
+{
+    A = RGB16_currentColor;
+}
+
 #if SUPPORT_HSV_COLOR
 void rgb_led_class::get(HsvColor &A)
 {
@@ -97,7 +156,7 @@ void rgb_led_class::get(HslColor &A)
         A = HSL_currentColor;
         return;
     }
-    rgbToHsl(RGB_currentColor,A);
+    rgbToHsl(RGB16_currentColor,A);
 }
 
 
@@ -35,6 +35,9 @@
      When         Who                Description of change
     -----------  ----------         ------------------------
     2014 Oct 15  James Stokebrand   Initial creation.
+    2026 Oct 18  James Stokebrand   Colors are kept with 16 bits per
+                                      channel down to the PWM layer.
+    2026 Oct 18  James Stokebrand   Added color fades.
 
 *****************************************************/
 
@@ -59,6 +62,8 @@ public:
     , green_led(G,CommonCathode,0)
     , blue_led(B,CommonCathode,0)
     , HSL_color_valid(false)
+    , _FadeSteps(0)
+    , _FadeStep(0)
     { 
         // Scale values for adjusting RGB LED color
         red_scale_value = 1.0;
@@ -67,39 +72,51 @@ public:
 
         // Clear the current color values.
         RGB_currentColor.clear();
+        RGB16_currentColor.clear();
         HSL_currentColor.clear();
     }
 
     void set(RgbColor const &A);
+    void set(RgbColor16 const &A);
 #if SUPPORT_HSV_COLOR
     void set(HsvColor const &A);
 #endif
     void set(HslColor const &A);
 
     void get(RgbColor &A);
+    void get(RgbColor16 &A);
 #if SUPPORT_HSV_COLOR
     void get(HsvColor &A);
 #endif
     void get(HslColor &A);
 
+    // Fade from the current color to A in steps calls to FadeStep().
+    //  Setting a color stops the fade.
+    void fade(RgbColor16 const &A, uint16_t const &steps);
+
+    // Move the fade one step.  Returns true while the fade is running.
+    bool FadeStep();
+
+    bool isFading() { return (_FadeStep < _FadeSteps); }
+
     void RGB_On() 
     {
         // Set the current color to max
-        RGB_currentColor.r = RGB_currentColor.g = RGB_currentColor.b = 255;
+        RGB16_currentColor.r = RGB16_currentColor.g = RGB16_currentColor.b = 0xFFFF;
 
         // Use SET instead of On() for each LED 
         //  in case of the use of color scaling.
-        set(RGB_currentColor);
+        set(RGB16_currentColor);
     }
 
     void RGB_Off()
     {
         // Remember the current color
-        RGB_currentColor.clear();
+        RGB16_currentColor.clear();
 
         // Use SET instead of On() for each LED 
         //  in case of the use of color scaling.
-        set(RGB_currentColor);
+        set(RGB16_currentColor);
 
         
     }
@@ -141,6 +158,7 @@ public:
         RGB_currentColor.r = red_led.getValue();
         RGB_currentColor.g = green_led.getValue();
         RGB_currentColor.b = blue_led.getValue();
+        RGB16_currentColor = RgbColor16(RGB_currentColor);
     }
 
     inline uint8_t getRed()
@@ -150,8 +168,18 @@ public:
 
     void setRed(uint8_t const &A)
     {
-        RGB_currentColor.r = A;
-        set(RGB_currentColor);
+        setRed16(A * 257U);
+    }
+
+    inline uint16_t getRed16()
+    {
+        return RGB16_currentColor.r;
+    }
+
+    void setRed16(uint16_t const &A)
+    {
+        RGB16_currentColor.r = A;
+        set(RGB16_currentColor);
     }
 
     inline uint8_t getGreen()
@@ -161,8 +189,18 @@ public:
 
     void setGreen(uint8_t const &A)
     {
-        RGB_currentColor.g = A;
-        set(RGB_currentColor);
+        setGreen16(A * 257U);
+    }
+
+    inline uint16_t getGreen16()
+    {
+        return RGB16_currentColor.g;
+    }
+
+    void setGreen16(uint16_t const &A)
+    {
+        RGB16_currentColor.g = A;
+        set(RGB16_currentColor);
     }
     
     inline uint8_t getBlue()
@@ -172,8 +210,18 @@ public:
 
     void setBlue(uint8_t const &A)
     {
-        RGB_currentColor.b = A;
-        set(RGB_currentColor);
+        setBlue16(A * 257U);
+    }
+
+    inline uint16_t getBlue16()
+    {
+        return RGB16_currentColor.b;
+    }
+
+    void setBlue16(uint16_t const &A)
+    {
+        RGB16_currentColor.b = A;
+        set(RGB16_currentColor);
     }
 
     double getHue()
@@ -260,13 +308,18 @@ public:
             blue_led.setValue(B);
         }
 
-        red_led.setValue(RGB_currentColor.r);
-        green_led.setValue(RGB_currentColor.g);
-        blue_led.setValue(RGB_currentColor.b);
+        // Restore the current color
+        apply(RGB16_currentColor);
     }
 
 
 private:
+    // Scale and write the color to the PWMs
+    void apply(RgbColor16 const &A);
+
+    // Write the color and remember it as the current color
+    void show(RgbColor16 const &A);
+
     pwm_class red_led;
     pwm_class green_led;
     pwm_class blue_led;
@@ -277,10 +330,18 @@ private:
     float green_scale_value;
     float blue_scale_value;
 
+    // RGB_currentColor is the high byte of RGB16_currentColor
     RgbColor RGB_currentColor;
+    RgbColor16 RGB16_currentColor;
 
     bool HSL_color_valid;
     HslColor HSL_currentColor;
+
+    // Color fade
+    RgbColor16 _FadeFrom;
+    RgbColor16 _FadeTo;
+    uint16_t _FadeSteps;
+    uint16_t _FadeStep;
 };
 
 #endif
@@ -35,6 +35,42 @@
      When         Who                Description of change
     -----------  ----------         ------------------------
     2014 Oct 31  James Stokebrand   Initial creation.
+    2026 Oct 18  James Stokebrand   Feedback values are 16 bit.
+    2026 Oct 18  James Stokebrand   Absolute RGB/HSL color and fade msgs.
+    2026 Oct 18  James Stokebrand   Comm class knows the node address.
+    2026 Oct 18  James Stokebrand   Feedback msgs go to the controller address.
+    2026 Oct 18  James Stokebrand   Realtime stream colors.
+    2026 Oct 18  James Stokebrand   Transfer NACKs in this node's time slot.
+    2026 Oct 18  James Stokebrand   OSCCAL calibration msgs.
+    2026 Oct 18  James Stokebrand   Group addresses (E_SET_GROUPS).
+    2026 Oct 18  James Stokebrand   Address discovery, DIP switches all off
+                                      uses the assigned address.
+    2026 Oct 18  James Stokebrand   Feedback to broadcast/group msgs is sent
+                                      in this node's time slot.
+    2026 Oct 18  James Stokebrand   Status msgs on request and when the
+                                      color or state changes.
+    2026 Oct 18  James Stokebrand   Link statistics msgs on request.
+    2026 Oct 18  James Stokebrand   Relay nodes repeat msgs after a random
+                                      delay (COMM_CLASS_RELAY).
+    2026 Oct 18  James Stokebrand   Encoder adjusts RED/GREEN/BLUE in 16 bits.
+    2026 Oct 18  James Stokebrand   Received frames are decoded here (main
+                                      loop) instead of in the RX ISR.
+    2026 Oct 18  James Stokebrand   STATS requests pick the page to send.
+    2026 Oct 18  James Stokebrand   DIP switch addresses refuse
+                                      E_ASSIGN_ADDRESS.
+    2026 Oct 18  James Stokebrand   STATUS/STATS reports built by
+                                      node_report_class.
+    2026 Oct 18  James Stokebrand   All 32 bits of Millis() stirred into
+                                      the random numbers (unique ID).
+    2026 Oct 18  James Stokebrand   Reply time slots are timed from the end
+                                      of the frame (E_UART_RX_FRAME_END).
+    2026 Oct 18  James Stokebrand   Feedback slots sized for the airtime
+                                      and clock error.
+    2026 Oct 18  James Stokebrand   STATUS and STATS replies have their own
+                                      slot widths.
+    2026 Oct 18  James Stokebrand   Only red/green/blue and half keep the
+                                      other channels at 16 bits.
+    2026 Oct 18  James Stokebrand   NACK replies use reply_slot_ms() slots.
 
 *****************************************************/
 
@@ -55,6 +91,10 @@
 #include "pin_class.h"
 #endif
 
+#ifndef _TIMER_CLASS_H_
+#include "timer_class.h"
+#endif
+
 #define DEBUG 0
 
 class rgb_node_state_machine
@@ -70,11 +110,23 @@ public:
               // this "false" sets this to common anode RGB LED
               ,false)
     , _NODE_ADDRESS(0)
+    , _DipAddress(false)
     , RGB_adjust_value(RGB_LARGE_ADJUST_VALUE)
     , RGB_color_adjust_temp(0)
     , HSL_adjust_value(HSL_LARGE_ADJUST_VALUE)
     , HSL_color_adjust_temp(0)
     , _event_queue(event_queue)
+    , _FeedbackEvent(E_LED_RED_PWM)
+    , _FeedbackValue(0)
+    , _StatusState(0)
+    , _StatusForce(false)
+    , _StatusSentMs(0)
+    , _StatsPage(node_report_class::STATS_PAGE_LINK)
+    , _FrameEndMs(0)
+    , _FeedbackSlotMs(0)
+    , _StatusSlotMs(0)
+    , _StatsSlotMs(0)
+    , _NackSlotMs(0)
     {
         // Initial state of the RGB LED is OFF.
         _RGB_Led.HSL_Off();
@@ -85,9 +137,15 @@ public:
         // Init in HSL mode.  Set Intensity to 25%
         _RGB_Led.setIntensity(0.25);
 
+        // Nothing to push until the color or state changes.
+        mark_status_sent();
+
         // Attach the UART object to start receiving events
         _Comm.Attach(event_queue);
 
+        // Attach the timer to receive timer expired events
+        timer_class::getInstance()->Attach(event_queue);
+
         (this->*state)(ENTER_EVENT);
 
         // Read the DIP switch
@@ -101,6 +159,16 @@ public:
         _NODE_ADDRESS |= (DipSwitch_02.Read() << 1);
         _NODE_ADDRESS |= (DipSwitch_03.Read() << 2);
         _NODE_ADDRESS |= (DipSwitch_04.Read() << 3);
+        _DipAddress = (_NODE_ADDRESS != 0);
+
+        // DIP switches all off ... use the address assigned by the
+        //  controller (if any, see E_ASSIGN_ADDRESS).
+        if (_NODE_ADDRESS == 0)
+        {
+            _NODE_ADDRESS = _Comm.getIdentity().loadAssignedAddress();
+        }
+
+        set_node_address(_NODE_ADDRESS);
 
 #if 0
 // For debugging.  Send the node address over the comm link
@@ -116,6 +184,30 @@ public:
 
     virtual ~rgb_node_state_machine() {}
 
+    // Called after each event.  If the color or state has moved past
+    //  the hysteresis since the last STATUS msg, schedule one in this
+    //  node's time slot, no sooner than STATUS_MIN_INTERVAL_MS after
+    //  the last one.
+    void push_status()
+    {
+        // Nodes without an address don't push
+        if (_NODE_ADDRESS == 0) return;
+
+        // Already scheduled?
+        if (timer_class::getInstance()->isRunning(timer_class::E_TIMER_CHANNEL_STATUS)) return;
+
+        if (!status_changed()) return;
+
+        uint16_t delay_ms = _StatusSlotMs;
+        uint32_t elapsed = timer_class::getInstance()->Millis() - _StatusSentMs;
+        if ((elapsed < STATUS_MIN_INTERVAL_MS) &&
+            ((STATUS_MIN_INTERVAL_MS - elapsed) > delay_ms))
+        {
+            delay_ms = STATUS_MIN_INTERVAL_MS - elapsed;
+        }
+        timer_class::getInstance()->Start(timer_class::E_TIMER_CHANNEL_STATUS, delay_ms, false);
+    }
+
 private:
 
     void STATE_ADJ_MODE_RED(event_element_class &A)
@@ -123,6 +215,9 @@ private:
 #if DEBUG
 _Comm.encode(A);
 #endif
+        // Msgs handled the same in every state
+        if (process_common(A)) return;
+
         // Is a msg we should process?
         if (!(act_on_this_msg(A.get_current_data()))) return;
         
@@ -133,7 +228,7 @@ _Comm.encode(A);
             if (A.get_current_event() == E_ENTER_STATE)
             {
                 // Send RED PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed());
+                send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed16());
             }
         break;
         case E_RGB_CONTROLLER:
@@ -141,7 +236,7 @@ _Comm.encode(A);
             {
             case E_SET_RED:
                 // Already in RED state ... do nothing.
-                send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed());
+                send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed16());
             break;
             case E_SET_GREEN:
                 // Green State requested ... transition
@@ -165,25 +260,25 @@ _Comm.encode(A);
             break;
             case E_RE_CW:
                 // Rotary Encoder Counter Clockwise turn the LED Up
-                RGB_color_adjust_temp = _RGB_Led.getRed() + RGB_adjust_value;
+                RGB_color_adjust_temp = (int32_t)_RGB_Led.getRed16() + RGB_adjust_value;
 
                 // Out of bounds?
-                if (RGB_color_adjust_temp > 255) RGB_color_adjust_temp = 255;
-                _RGB_Led.setRed((uint8_t)RGB_color_adjust_temp);
+                if (RGB_color_adjust_temp > 0xFFFF) RGB_color_adjust_temp = 0xFFFF;
+                _RGB_Led.setRed16((uint16_t)RGB_color_adjust_temp);
 
                 // Send RED PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed());
+                send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed16());
             break;
             case E_RE_CCW:
                 // Rotary Encoder Counter Clockwise turn the LED Down
-                RGB_color_adjust_temp = _RGB_Led.getRed() - RGB_adjust_value;
+                RGB_color_adjust_temp = (int32_t)_RGB_Led.getRed16() - RGB_adjust_value;
 
                 // Out of bounds?
                 if (RGB_color_adjust_temp < 0) RGB_color_adjust_temp = 0;
-                _RGB_Led.setRed((uint8_t)RGB_color_adjust_temp);
+                _RGB_Led.setRed16((uint16_t)RGB_color_adjust_temp);
 
                 // Send RED PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed());
+                send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed16());
             break;
             case E_RE_PRESSED:
                 // Set adjust value to small
@@ -196,24 +291,24 @@ _Comm.encode(A);
             case E_ONLY_RED:
                 {
                     // Set color to 50% red.
-                    RgbColor _color_temp(128,_RGB_Led.getGreen(),_RGB_Led.getBlue());
+                    RgbColor16 _color_temp(0x8000,_RGB_Led.getGreen16(),_RGB_Led.getBlue16());
                     _RGB_Led.set(_color_temp);
 
                     // Send RED PWM value feedback.
-                    send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed());
+                    send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed16());
                 }
             break;
             case E_ONLY_GREEN:
                 {
                     // Set color to 50% green.
-                    RgbColor _color_temp(_RGB_Led.getRed(),128,_RGB_Led.getBlue());
+                    RgbColor16 _color_temp(_RGB_Led.getRed16(),0x8000,_RGB_Led.getBlue16());
                     _RGB_Led.set(_color_temp);
                 }
             break;
             case E_ONLY_BLUE:
                 {
                     // Set color to 50% blue.
-                    RgbColor _color_temp(_RGB_Led.getRed(),_RGB_Led.getGreen(),128);
+                    RgbColor16 _color_temp(_RGB_Led.getRed16(),_RGB_Led.getGreen16(),0x8000);
                     _RGB_Led.set(_color_temp);
                 }
             break;
@@ -221,30 +316,30 @@ _Comm.encode(A);
                 _RGB_Led.RGB_Off();
 
                 // Send RED PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed());
+                send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed16());
             break;
             case E_ALL_HALF:
                 {
                     // Set color to 50% blue.
-                    RgbColor _color_temp(128,128,128);
+                    RgbColor16 _color_temp(0x8000,0x8000,0x8000);
                     _RGB_Led.set(_color_temp);
 
                     // Send RED PWM value feedback.
-                    send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed());
+                    send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed16());
                 }
             break;
             case E_ALL_ON:
                 _RGB_Led.RGB_On();
 
                 // Send RED PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed());
+                send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed16());
             break;
             case E_SELECT:
                 Blink(A.get_current_data());
             break;
             case E_FORCE_FEEDBACK:
                 // Send RED PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed());
+                send_feedback(A.get_current_data(), E_LED_RED_PWM, _RGB_Led.getRed16());
             break;
             case E_ENABLE_STATUS_LED:
                 // Enable the node's status LED.
@@ -268,6 +363,9 @@ _Comm.encode(A);
 #if DEBUG
 _Comm.encode(A);
 #endif
+        // Msgs handled the same in every state
+        if (process_common(A)) return;
+
         // Is a msg we should process?
         if (!(act_on_this_msg(A.get_current_data()))) return;
 
@@ -278,7 +376,7 @@ _Comm.encode(A);
             if (A.get_current_event() == E_ENTER_STATE)
             {
                 // Send GREEN PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen());
+                send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen16());
             }
         break;
         case E_RGB_CONTROLLER:
@@ -290,7 +388,7 @@ _Comm.encode(A);
             break;
             case E_SET_GREEN:
                 // Already in Green state ... do nothing.
-                send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen());
+                send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen16());
             break;
             case E_SET_BLUE:
                 // Blue State requested ... transition
@@ -310,25 +408,25 @@ _Comm.encode(A);
             break;
             case E_RE_CW:
                 // Rotary Encoder Counter Clockwise turn the LED Up
-                RGB_color_adjust_temp = _RGB_Led.getGreen() + RGB_adjust_value;
+                RGB_color_adjust_temp = (int32_t)_RGB_Led.getGreen16() + RGB_adjust_value;
 
                 // Out of bounds?
-                if (RGB_color_adjust_temp > 255) RGB_color_adjust_temp = 255;
-                _RGB_Led.setGreen((uint8_t)RGB_color_adjust_temp);
+                if (RGB_color_adjust_temp > 0xFFFF) RGB_color_adjust_temp = 0xFFFF;
+                _RGB_Led.setGreen16((uint16_t)RGB_color_adjust_temp);
 
                 // Send GREEN PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen());
+                send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen16());
             break;
             case E_RE_CCW:
                 // Rotary Encoder Counter Clockwise turn the LED Down
-                RGB_color_adjust_temp = _RGB_Led.getGreen() - RGB_adjust_value;
+                RGB_color_adjust_temp = (int32_t)_RGB_Led.getGreen16() - RGB_adjust_value;
 
                 // Out of bounds?
                 if (RGB_color_adjust_temp < 0) RGB_color_adjust_temp = 0;
-                _RGB_Led.setGreen((uint8_t)RGB_color_adjust_temp);
+                _RGB_Led.setGreen16((uint16_t)RGB_color_adjust_temp);
 
                 // Send GREEN PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen());
+                send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen16());
             break;
             case E_RE_PRESSED:
                 // Set adjust value to small
@@ -341,24 +439,24 @@ _Comm.encode(A);
             case E_ONLY_RED:
                 {
                     // Set color to 50% red.
-                    RgbColor _color_temp(128,_RGB_Led.getGreen(),_RGB_Led.getBlue());
+                    RgbColor16 _color_temp(0x8000,_RGB_Led.getGreen16(),_RGB_Led.getBlue16());
                     _RGB_Led.set(_color_temp);
                 }
             break;
             case E_ONLY_GREEN:
                 {
                     // Set color to 50% green.
-                    RgbColor _color_temp(_RGB_Led.getRed(),128,_RGB_Led.getBlue());
+                    RgbColor16 _color_temp(_RGB_Led.getRed16(),0x8000,_RGB_Led.getBlue16());
                     _RGB_Led.set(_color_temp);
 
                     // Send Green PWM value feedback.
-                    send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen());
+                    send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen16());
                 }
             break;
             case E_ONLY_BLUE:
                 {
                     // Set color to 50% Blue.
-                    RgbColor _color_temp(_RGB_Led.getRed(),_RGB_Led.getGreen(),128);
+                    RgbColor16 _color_temp(_RGB_Led.getRed16(),_RGB_Led.getGreen16(),0x8000);
                     _RGB_Led.set(_color_temp);
                 }
             break;
@@ -366,30 +464,30 @@ _Comm.encode(A);
                 _RGB_Led.RGB_Off();
 
                 // Send GREEN PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen());
+                send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen16());
             break;
             case E_ALL_HALF:
                 {
                     // Set color to 50% blue.
-                    RgbColor _color_temp(128,128,128);
+                    RgbColor16 _color_temp(0x8000,0x8000,0x8000);
                     _RGB_Led.set(_color_temp);
 
                     // Send GREEN PWM value feedback.
-                    send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen());
+                    send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen16());
                 }
             break;
             case E_ALL_ON:
                 _RGB_Led.RGB_On();
 
                 // Send GREEN PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen());
+                send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen16());
             break;
             case E_SELECT:
                 Blink(A.get_current_data());
             break;
             case E_FORCE_FEEDBACK:
                 // Send GREEN PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen());
+                send_feedback(A.get_current_data(), E_LED_GREEN_PWM, _RGB_Led.getGreen16());
             break;
             case E_ENABLE_STATUS_LED:
                 // Enable the node's status LED.
@@ -413,6 +511,9 @@ _Comm.encode(A);
 #if DEBUG
 _Comm.encode(A);
 #endif
+        // Msgs handled the same in every state
+        if (process_common(A)) return;
+
         // Is a msg we should process?
         if (!(act_on_this_msg(A.get_current_data()))) return;
 
@@ -423,7 +524,7 @@ _Comm.encode(A);
             if (A.get_current_event() == E_ENTER_STATE)
             {
                 // Send BLUE PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue());
+                send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue16());
             }
         break;
         case E_RGB_CONTROLLER:
@@ -439,7 +540,7 @@ _Comm.encode(A);
             break;
             case E_SET_BLUE:
                 // Already in BLUE State ... do nothing
-                send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue());
+                send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue16());
             break;
             case E_SET_HUE:
                 // Hue State requested ... transition
@@ -455,25 +556,25 @@ _Comm.encode(A);
             break;
             case E_RE_CW:
                 // Rotary Encoder Counter Clockwise turn the LED Up
-                RGB_color_adjust_temp = _RGB_Led.getBlue() + RGB_adjust_value;
+                RGB_color_adjust_temp = (int32_t)_RGB_Led.getBlue16() + RGB_adjust_value;
 
                 // Out of bounds?
-                if (RGB_color_adjust_temp > 255) RGB_color_adjust_temp = 255;
-                _RGB_Led.setBlue((uint8_t)RGB_color_adjust_temp);
+                if (RGB_color_adjust_temp > 0xFFFF) RGB_color_adjust_temp = 0xFFFF;
+                _RGB_Led.setBlue16((uint16_t)RGB_color_adjust_temp);
 
                 // Send BLUE PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue());
+                send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue16());
             break;
             case E_RE_CCW:
                 // Rotary Encoder Counter Clockwise turn the LED Down
-                RGB_color_adjust_temp = _RGB_Led.getBlue() - RGB_adjust_value;
+                RGB_color_adjust_temp = (int32_t)_RGB_Led.getBlue16() - RGB_adjust_value;
 
                 // Out of bounds?
                 if (RGB_color_adjust_temp < 0) RGB_color_adjust_temp = 0;
-                _RGB_Led.setBlue((uint8_t)RGB_color_adjust_temp);
+                _RGB_Led.setBlue16((uint16_t)RGB_color_adjust_temp);
 
                 // Send BLUE PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue());
+                send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue16());
             break;
             case E_RE_PRESSED:
                 // Set adjust value to small
@@ -486,55 +587,55 @@ _Comm.encode(A);
             case E_ONLY_RED:
                 {
                     // Set color to 50% red.
-                    RgbColor _color_temp(128,_RGB_Led.getGreen(),_RGB_Led.getBlue());
+                    RgbColor16 _color_temp(0x8000,_RGB_Led.getGreen16(),_RGB_Led.getBlue16());
                     _RGB_Led.set(_color_temp);
                 }
             break;
             case E_ONLY_GREEN:
                 {
                     // Set color to 50% green.
-                    RgbColor _color_temp(_RGB_Led.getRed(),128,_RGB_Led.getBlue());
+                    RgbColor16 _color_temp(_RGB_Led.getRed16(),0x8000,_RGB_Led.getBlue16());
                     _RGB_Led.set(_color_temp);
                 }
             break;
             case E_ONLY_BLUE:
                 {
                     // Set color to 50% Blue.
-                    RgbColor _color_temp(_RGB_Led.getRed(),_RGB_Led.getGreen(),128);
+                    RgbColor16 _color_temp(_RGB_Led.getRed16(),_RGB_Led.getGreen16(),0x8000);
                     _RGB_Led.set(_color_temp);
 
                     // Send BLUE PWM value feedback.
-                    send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue());
+                    send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue16());
                 }
             break;
             case E_ALL_OFF:
                 _RGB_Led.RGB_Off();
 
                 // Send BLUE PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue());
+                send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue16());
             break;
             case E_ALL_HALF:
                 {
                     // Set color to 50% red.
-                    RgbColor _color_temp(128,128,128);
+                    RgbColor16 _color_temp(0x8000,0x8000,0x8000);
                     _RGB_Led.set(_color_temp);
 
                     // Send BLUE PWM value feedback.
-                    send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue());
+                    send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue16());
                 }
             break;
             case E_ALL_ON:
                 _RGB_Led.RGB_On();
 
                 // Send BLUE PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue());
+                send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue16());
             break;
             case E_SELECT:
                 Blink(A.get_current_data());
             break;
             case E_FORCE_FEEDBACK:
                 // Send BLUE PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue());
+                send_feedback(A.get_current_data(), E_LED_BLUE_PWM, _RGB_Led.getBlue16());
             break;
             case E_ENABLE_STATUS_LED:
                 // Enable the node's status LED.
@@ -560,6 +661,9 @@ _Comm.encode(A);
 #if DEBUG
 _Comm.encode(A);
 #endif
+        // Msgs handled the same in every state
+        if (process_common(A)) return;
+
         // Is a msg we should process?
         if (!(act_on_this_msg(A.get_current_data()))) return;
         
@@ -570,7 +674,7 @@ _Comm.encode(A);
             if (A.get_current_event() == E_ENTER_STATE)
             {
                 // Send HUE value feedback.
-                send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*255);
+                send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*65535);
             }
         break;
         case E_RGB_CONTROLLER:
@@ -590,7 +694,7 @@ _Comm.encode(A);
             break;
             case E_SET_HUE:
                 // Already in Hue State. Do nothing.
-                send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*255);
+                send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*65535);
             break;
             case E_SET_SATURATION:
                 // Saturation State requested ... transition
@@ -609,7 +713,7 @@ _Comm.encode(A);
                 _RGB_Led.setHue(HSL_color_adjust_temp);
 
                 // Send HUE value feedback.
-                send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*255);
+                send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*65535);
             break;
             case E_RE_CCW:
                 // Rotary Encoder Counter Clockwise turn the LED Down
@@ -620,7 +724,7 @@ _Comm.encode(A);
                 _RGB_Led.setHue(HSL_color_adjust_temp);
 
                 // Send RED PWM value feedback.
-                send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*255);
+                send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*65535);
             break;
             case E_RE_PRESSED:
                 // Set adjust value to small
@@ -633,31 +737,31 @@ _Comm.encode(A);
             case E_ONLY_RED:
                 {
                     // Set color to 50% red.
-                    RgbColor _color_temp(128,_RGB_Led.getGreen(),_RGB_Led.getBlue());
+                    RgbColor16 _color_temp(0x8000,_RGB_Led.getGreen16(),_RGB_Led.getBlue16());
                     _RGB_Led.set(_color_temp);
 
                     // Send HUE value feedback.
-                    send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*255);
+                    send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*65535);
                 }
             break;
             case E_ONLY_GREEN:
                 {
                     // Set color to 50% green.
-                    RgbColor _color_temp(_RGB_Led.getRed(),128,_RGB_Led.getBlue());
+                    RgbColor16 _color_temp(_RGB_Led.getRed16(),0x8000,_RGB_Led.getBlue16());
                     _RGB_Led.set(_color_temp);
 
                     // Send HUE value feedback.
-                    send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*255);
+                    send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*65535);
                 }
             break;
             case E_ONLY_BLUE:
                 {
                     // Set color to 50% blue.
-                    RgbColor _color_temp(_RGB_Led.getRed(),_RGB_Led.getGreen(),128);
+                    RgbColor16 _color_temp(_RGB_Led.getRed16(),_RGB_Led.getGreen16(),0x8000);
                     _RGB_Led.set(_color_temp);
 
                     // Send HUE value feedback.
-                    send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*255);
+                    send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*65535);
                 }
             break;
             case E_ALL_OFF:
@@ -666,7 +770,7 @@ _Comm.encode(A);
                     _RGB_Led.setIntensity(0);
 
                     // Send HUE value feedback.
-                    send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*255);
+                    send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*65535);
                 }
             break;
             case E_ALL_HALF:
@@ -675,7 +779,7 @@ _Comm.encode(A);
                     _RGB_Led.setIntensity(0.5);
 
                     // Send HUE value feedback.
-                    send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*255);
+                    send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*65535);
                 }
             break;
             case E_ALL_ON:
@@ -684,7 +788,7 @@ _Comm.encode(A);
                     _RGB_Led.setIntensity(0.99);
 
                     // Send HUE value feedback.
-                    send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*255);
+                    send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*65535);
                 }
             break;
             case E_SELECT:
@@ -692,7 +796,7 @@ _Comm.encode(A);
             break;
             case E_FORCE_FEEDBACK:
                 // Send HUE value feedback.
-                send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*255);
+                send_feedback(A.get_current_data(), E_LED_HUE_PWM, _RGB_Led.getHue()*65535);
             break;
             case E_ENABLE_STATUS_LED:
                 // Enable the node's status LED.
@@ -718,6 +822,9 @@ _Comm.encode(A);
 #if DEBUG
 _Comm.encode(A);
 #endif
+        // Msgs handled the same in every state
+        if (process_common(A)) return;
+
         // Is a msg we should process?
         if (!(act_on_this_msg(A.get_current_data()))) return;
         
@@ -728,7 +835,7 @@ _Comm.encode(A);
             if (A.get_current_event() == E_ENTER_STATE)
             {
                 // Send Saturation value feedback.
-                send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*255);
+                send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*65535);
             }
         break;
         case E_RGB_CONTROLLER:
@@ -752,7 +859,7 @@ _Comm.encode(A);
             break;
             case E_SET_SATURATION:
                 // Already in Saturation State. Do nothing.
-                send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*255);
+                send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*65535);
             break;
             case E_SET_INTENSITY:
                 // Intensity State requested ... transition
@@ -767,7 +874,7 @@ _Comm.encode(A);
                 _RGB_Led.setSaturation(HSL_color_adjust_temp);
 
                 // Send Saturation value feedback.
-                send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*255);
+                send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*65535);
             break;
             case E_RE_CCW:
                 // Rotary Encoder Counter Clockwise turn the LED Down
@@ -778,7 +885,7 @@ _Comm.encode(A);
                 _RGB_Led.setSaturation(HSL_color_adjust_temp);
 
                 // Send Saturation value feedback.
-                send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*255);
+                send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*65535);
             break;
             case E_RE_PRESSED:
                 // Set adjust value to small
@@ -791,31 +898,31 @@ _Comm.encode(A);
             case E_ONLY_RED:
                 {
                     // Set color to 50% red.
-                    RgbColor _color_temp(128,_RGB_Led.getGreen(),_RGB_Led.getBlue());
+                    RgbColor16 _color_temp(0x8000,_RGB_Led.getGreen16(),_RGB_Led.getBlue16());
                     _RGB_Led.set(_color_temp);
 
                     // Send Saturation value feedback
-                    send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*255);
+                    send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*65535);
                 }
             break;
             case E_ONLY_GREEN:
                 {
                     // Set color to 50% green.
-                    RgbColor _color_temp(_RGB_Led.getRed(),128,_RGB_Led.getBlue());
+                    RgbColor16 _color_temp(_RGB_Led.getRed16(),0x8000,_RGB_Led.getBlue16());
                     _RGB_Led.set(_color_temp);
 
                     // Send Saturation value feedback.
-                    send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*255);
+                    send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*65535);
                 }
             break;
             case E_ONLY_BLUE:
                 {
                     // Set color to 50% blue.
-                    RgbColor _color_temp(_RGB_Led.getRed(),_RGB_Led.getGreen(),128);
+                    RgbColor16 _color_temp(_RGB_Led.getRed16(),_RGB_Led.getGreen16(),0x8000);
                     _RGB_Led.set(_color_temp);
 
                     // Send Saturation value feedback.
-                    send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*255);
+                    send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*65535);
                 }
             break;
             case E_ALL_OFF:
@@ -824,7 +931,7 @@ _Comm.encode(A);
                     _RGB_Led.setIntensity(0);
 
                     // Send Saturation value feedback.
-                    send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*255);
+                    send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*65535);
                 }
             break;
             case E_ALL_HALF:
@@ -833,7 +940,7 @@ _Comm.encode(A);
                     _RGB_Led.setIntensity(0.5);
 
                     // Send Saturation value feedback.
-                    send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*255);
+                    send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*65535);
                 }
             break;
             case E_ALL_ON:
@@ -842,7 +949,7 @@ _Comm.encode(A);
                     _RGB_Led.setIntensity(0.99);
 
                     // Send Saturation value feedback.
-                    send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*255);
+                    send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*65535);
                 }
             break;
             case E_SELECT:
@@ -850,7 +957,7 @@ _Comm.encode(A);
             break;
             case E_FORCE_FEEDBACK:
                 // Send Saturation value feedback.
-                send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*255);
+                send_feedback(A.get_current_data(), E_LED_SATURATION_PWM, _RGB_Led.getSaturation()*65535);
             break;
             case E_ENABLE_STATUS_LED:
                 // Enable the node's status LED.
@@ -875,6 +982,9 @@ _Comm.encode(A);
 #if DEBUG
 _Comm.encode(A);
 #endif
+        // Msgs handled the same in every state
+        if (process_common(A)) return;
+
         // Is a msg we should process?
         if (!(act_on_this_msg(A.get_current_data()))) return;
         
@@ -885,7 +995,7 @@ _Comm.encode(A);
             if (A.get_current_event() == E_ENTER_STATE)
             {
                 // Send Intensity value feedback.
-                send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*255);
+                send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*65535);
             }
         case E_RGB_CONTROLLER:
             switch(A.get_current_event())
@@ -912,7 +1022,7 @@ _Comm.encode(A);
             break;
             case E_SET_INTENSITY:
                 // Already in Intensity State. Do nothing.
-                send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*255);
+                send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*65535);
             break;
             case E_RE_CW:
                 // Rotary Encoder Counter Clockwise turn the LED Up
@@ -923,7 +1033,7 @@ _Comm.encode(A);
                 _RGB_Led.setIntensity(HSL_color_adjust_temp);
 
                 // Send Intensity value feedback.
-                send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*255);
+                send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*65535);
             break;
             case E_RE_CCW:
                 // Rotary Encoder Counter Clockwise turn the LED Down
@@ -934,7 +1044,7 @@ _Comm.encode(A);
                 _RGB_Led.setIntensity(HSL_color_adjust_temp);
 
                 // Send Intensity value feedback.
-                send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*255);
+                send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*65535);
             break;
             case E_RE_PRESSED:
                 // Set adjust value to small
@@ -947,31 +1057,31 @@ _Comm.encode(A);
             case E_ONLY_RED:
                 {
                     // Set color to 50% red.
-                    RgbColor _color_temp(128,_RGB_Led.getGreen(),_RGB_Led.getBlue());
+                    RgbColor16 _color_temp(0x8000,_RGB_Led.getGreen16(),_RGB_Led.getBlue16());
                     _RGB_Led.set(_color_temp);
 
                     // Send Intensity value feedback.
-                    send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*255);
+                    send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*65535);
                 }
             break;
             case E_ONLY_GREEN:
                 {
                     // Set color to 50% green.
-                    RgbColor _color_temp(_RGB_Led.getRed(),128,_RGB_Led.getBlue());
+                    RgbColor16 _color_temp(_RGB_Led.getRed16(),0x8000,_RGB_Led.getBlue16());
                     _RGB_Led.set(_color_temp);
 
                     // Send Intensity value feedback.
-                    send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*255);
+                    send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*65535);
                 }
             break;
             case E_ONLY_BLUE:
                 {
                     // Set color to 50% blue.
-                    RgbColor _color_temp(_RGB_Led.getRed(),_RGB_Led.getGreen(),128);
+                    RgbColor16 _color_temp(_RGB_Led.getRed16(),_RGB_Led.getGreen16(),0x8000);
                     _RGB_Led.set(_color_temp);
 
                     // Send Intensity value feedback.
-                    send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*255);
+                    send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*65535);
                 }
             break;
             case E_ALL_OFF:
@@ -989,7 +1099,7 @@ _Comm.encode(A);
                     _RGB_Led.setIntensity(0.5);
 
                     // Send Intensity value feedback.
-                    send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, 128);
+                    send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, 0x8000);
                 }
             break;
             case E_ALL_ON:
@@ -998,7 +1108,7 @@ _Comm.encode(A);
                     _RGB_Led.setIntensity(0.99);
 
                     // Send Intensity value feedback.
-                    send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, 255);
+                    send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, 0xFFFF);
                 }
             break;
             case E_SELECT:
@@ -1006,7 +1116,7 @@ _Comm.encode(A);
             break;
             case E_FORCE_FEEDBACK:
                 // Send Intensity value feedback.
-                send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*255);
+                send_feedback(A.get_current_data(), E_LED_INTENSITY_PWM, _RGB_Led.getIntensity()*65535);
             break;
             case E_ENABLE_STATUS_LED:
                 // Enable the node's status LED.
@@ -1026,21 +1136,415 @@ _Comm.encode(A);
     }
 
 
-    void send_feedback(uint8_t const &address,E_InputEvent const &event, uint8_t const &pwm_value)
+    // Handle the msgs that don't depend on the current state.
+    //  Returns true if the msg was handled.
+    bool process_common(event_element_class &A)
+    {
+        switch(A.get_current_hardware())
+        {
+        case E_TIMER_01:
+            if ((A.get_current_event() == E_TIMER_EXPIRE) &&
+                (A.get_current_data() == timer_class::E_TIMER_CHANNEL_FADE))
+            {
+                // Next step of the color fade
+                if (!_RGB_Led.FadeStep())
+                {
+                    timer_class::getInstance()->Stop(timer_class::E_TIMER_CHANNEL_FADE);
+                }
+            }
+            if ((A.get_current_event() == E_TIMER_EXPIRE) &&
+                (A.get_current_data() == timer_class::E_TIMER_CHANNEL_NACK))
+            {
+                // This node's time slot ... send the missing map.
+                _Comm.encode_nack();
+            }
+            if ((A.get_current_event() == E_TIMER_EXPIRE) &&
+                (A.get_current_data() == timer_class::E_TIMER_CHANNEL_FEEDBACK))
+            {
+                // This node's time slot ... send the feedback.
+                encode_feedback(_FeedbackEvent, _FeedbackValue);
+            }
+            if ((A.get_current_event() == E_TIMER_EXPIRE) &&
+                (A.get_current_data() == timer_class::E_TIMER_CHANNEL_ANNOUNCE))
+            {
+                // Picked time slot ... send the unique ID.
+                _Comm.encode_announce();
+            }
+            if ((A.get_current_event() == E_TIMER_EXPIRE) &&
+                (A.get_current_data() == timer_class::E_TIMER_CHANNEL_STATUS))
+            {
+                // This node's time slot ... send the status if asked for
+                //  or it still differs from the last one sent.
+                if (_StatusForce || status_changed()) encode_status();
+            }
+            if ((A.get_current_event() == E_TIMER_EXPIRE) &&
+                (A.get_current_data() == timer_class::E_TIMER_CHANNEL_STATS))
+            {
+                // This node's time slot ... send the statistics.
+                encode_stats(_StatsPage);
+            }
+#if (COMM_CLASS_RELAY == 2)
+            if ((A.get_current_event() == E_TIMER_EXPIRE) &&
+                (A.get_current_data() == timer_class::E_TIMER_CHANNEL_RELAY))
+            {
+                // Done waiting ... repeat the held msg.
+                _Comm.relayFrame();
+            }
+#endif
+            return true;
+        case E_UART_00:
+            if ((A.get_current_event() == E_UART_RX_FRAME_EVENT) ||
+                (A.get_current_event() == E_UART_FLAG_BYTE_FOUND_EVENT))
+            {
+                // The RX ISR has collected a frame ... decode it here,
+                //  out of the ISR.
+                _Comm.receive();
+                return true;
+            }
+            if (A.get_current_event() == E_UART_RX_FRAME_END)
+            {
+                // The events that follow came in a frame that ended at
+                //  this (low byte of the) time.  Less than 256 ms ago.
+                uint32_t now = timer_class::getInstance()->Millis();
+                _FrameEndMs = now - (uint8_t)((uint8_t)now - A.get_current_data());
+                return true;
+            }
+#if (COMM_CLASS_RELAY == 2)
+            if (A.get_current_event() == E_UART_RELAY_PENDING)
+            {
+                // Relays that heard the same msg wait a random number
+                //  of slots so their copies don't collide.
+                stir_random();
+                start_after_frame(timer_class::E_TIMER_CHANNEL_RELAY,
+                    _Comm.getIdentity().random(RELAY_JITTER_SLOTS) * RELAY_SLOT_MS + RELAY_SLOT_MS);
+                return true;
+            }
+#endif
+        break;
+        case E_RGB_CONTROLLER:
+            switch(A.get_current_event())
+            {
+            case E_SET_RGB_VALUE:
+            case E_SET_HSL_VALUE:
+            case E_SET_RGB_FADE:
+                // Is a msg we should process?
+                if (act_on_this_msg(A.get_current_data()))
+                {
+                    set_absolute_color(A);
+                }
+                return true;
+            case E_TRANSFER_POLL:
+                // Answer in this node's time slot so the NACKs don't collide.
+                start_after_frame(timer_class::E_TIMER_CHANNEL_NACK, _NackSlotMs);
+                return true;
+            case E_TRANSFER_SEGMENT:
+            case E_TRANSFER_COMPLETE:
+                // Nothing on the node takes a transfer yet.
+                return true;
+#if OSCCAL_CALIBRATION
+            case E_OSC_CALIBRATE:
+                if (act_on_this_msg(A.get_current_data()))
+                {
+                    osccal_class::getInstance()->Start();
+                }
+                return true;
+            case E_OSC_SYNC:
+                calibrate(A);
+                return true;
+            case E_OSC_SAVE:
+                if (act_on_this_msg(A.get_current_data()))
+                {
+                    osccal_class::getInstance()->Stop(true);
+                }
+                return true;
+#endif
+            case E_DISCOVER:
+                // No address yet or asked for all (the comm class
+                //  checks) ... answer in a random slot.
+                stir_random();
+                start_after_frame(timer_class::E_TIMER_CHANNEL_ANNOUNCE,
+                    _Comm.getIdentity().random(A.get_current_data()) * ANNOUNCE_SLOT_MS + ANNOUNCE_SLOT_MS);
+                return true;
+            case E_ASSIGN_ADDRESS:
+                // The controller picked an address for this node's unique
+                //  ID.  Save it and confirm.  The DIP switches win over
+                //  the controller: keep the switch address and announce
+                //  it, so the controller sees the assignment was refused.
+                if (!_DipAddress)
+                {
+                    _Comm.getIdentity().saveAssignedAddress(A.get_current_data());
+                    set_node_address(A.get_current_data());
+                }
+                _Comm.encode_announce();
+                return true;
+            case E_STATUS_REQUEST:
+                // Same as feedback ... now for this node's address, in
+                //  this node's time slot for a broadcast or group.
+                if ((A.get_current_data() != 0) && (A.get_current_data() == _NODE_ADDRESS))
+                {
+                    timer_class::getInstance()->Stop(timer_class::E_TIMER_CHANNEL_STATUS);
+                    encode_status();
+                }
+                else if ((_NODE_ADDRESS != 0) && act_on_this_msg(A.get_current_data()))
+                {
+                    _StatusForce = true;
+                    start_after_frame(timer_class::E_TIMER_CHANNEL_STATUS, _StatusSlotMs);
+                }
+                return true;
+            case E_STATS_REQUEST:
+                // Same as E_STATUS_REQUEST.  The optional payload byte is
+                //  the page to send.
+                if ((A.get_current_data() != 0) && (A.get_current_data() == _NODE_ADDRESS))
+                {
+                    encode_stats(stats_page(A));
+                }
+                else if ((_NODE_ADDRESS != 0) && act_on_this_msg(A.get_current_data()))
+                {
+                    _StatsPage = stats_page(A);
+                    start_after_frame(timer_class::E_TIMER_CHANNEL_STATS, _StatsSlotMs);
+                }
+                return true;
+            case E_SET_GROUPS:
+                // Join these groups (no feedback, the msg may be for
+                //  many nodes).
+                if (act_on_this_msg(A.get_current_data()) &&
+                    (A.get_payload_length() >= 1))
+                {
+                    _Comm.getIdentity().setGroupMask(A.get_payload()[0]);
+                }
+                return true;
+            case E_SET_RGB_REALTIME:
+                // Apply the newest realtime color (if not already taken)
+                if (act_on_this_msg(A.get_current_data()))
+                {
+                    uint8_t rgb[3];
+                    if (_Comm.takeRealtimeColor(rgb))
+                    {
+                        timer_class::getInstance()->Stop(timer_class::E_TIMER_CHANNEL_FADE);
+                        RgbColor16 _color_temp(rgb[0] * 257U, rgb[1] * 257U, rgb[2] * 257U);
+                        _RGB_Led.set(_color_temp);
+                    }
+                }
+                return true;
+            default:
+            break;
+            }
+        break;
+        default:
+        break;
+        }
+        return false;
+    }
+
+    /*
+        Absolute color msgs.  The data byte is the node address and
+        the payload carries the color:
+            E_SET_RGB_VALUE  R G B       (3 bytes, 8 bit)
+                             R G B       (6 bytes, 16 bit MSB first)
+            E_SET_HSL_VALUE  H S L       (3 bytes, 8 bit, 0xFF is 1.0)
+                             H S L       (6 bytes, 16 bit MSB first, 0xFFFF is 1.0)
+            E_SET_RGB_FADE   R G B, Fade time in ms (16 bit MSB first)
+                             (5 or 8 bytes)
+        The color is written to the LED with a single set() call.
+    */
+    void set_absolute_color(event_element_class const &A)
+    {
+        uint8_t const *p = A.get_payload();
+        uint8_t len = A.get_payload_length();
+        uint16_t fade_ms = 0;
+
+        if (A.get_current_event() == E_SET_RGB_FADE)
+        {
+            // Fade time is the last 2 bytes
+            if (len < 2) return;
+            len -= 2;
+            fade_ms = (p[len] << 8) | p[len+1];
+        }
+
+        // 8 or 16 bit values?
+        uint16_t v[3];
+        if (len == 3)
+        {
+            for (uint8_t jj=0; jj<3; jj++) v[jj] = p[jj] * 257U;
+        }
+        else if (len == 6)
+        {
+            for (uint8_t jj=0; jj<3; jj++) v[jj] = (p[2*jj] << 8) | p[2*jj+1];
+        }
+        else
+        {
+            // Bad payload ... ignore this msg.
+            return;
+        }
+
+        timer_class::getInstance()->Stop(timer_class::E_TIMER_CHANNEL_FADE);
+
+        if (A.get_current_event() == E_SET_HSL_VALUE)
+        {
+            HslColor _color_temp(v[0]/65535.0, v[1]/65535.0, v[2]/65535.0);
+            _RGB_Led.set(_color_temp);
+        }
+        else if (fade_ms >= FADE_STEP_MS)
+        {
+            RgbColor16 _color_temp(v[0], v[1], v[2]);
+            _RGB_Led.fade(_color_temp, fade_ms / FADE_STEP_MS);
+            timer_class::getInstance()->Start(timer_class::E_TIMER_CHANNEL_FADE, FADE_STEP_MS, true);
+        }
+        else
+        {
+            RgbColor16 _color_temp(v[0], v[1], v[2]);
+            _RGB_Led.set(_color_temp);
+        }
+    }
+
+#if OSCCAL_CALIBRATION
+    // Trim OSCCAL from a sync msg and report the error (in 0.1%,
+    //  before the trim) to the controller.
+    void calibrate(event_element_class const &A)
+    {
+        if (A.get_payload_length() < 3) return;
+
+        uint8_t const *p = A.get_payload();
+        uint16_t ticks = (p[0] << 8) | p[1];
+
+        if (osccal_class::getInstance()->Measure(ticks, p[2]))
+        {
+            event_element_class _temp;
+            _temp.set(E_RGB_NODE, E_OSC_SYNC);
+            _temp.set_data16((uint16_t)osccal_class::getInstance()->getError());
+            _Comm.encode(_temp, comm_class::CONTROLLER_ADDRESS);
+        }
+    }
+#endif
+
+    void send_feedback(uint8_t const &address,E_InputEvent const &event, uint16_t const &pwm_value)
+    {
+        // IF msg address == _NODE_ADDRESS
+        // THEN send a feedback msg now
+        // IF msg address is ZERO or a group of this node
+        // THEN send it in this node's time slot, every node answering at
+        //  once would collide.
+        if ((address != 0) && (address == _NODE_ADDRESS))
+        {
+            encode_feedback(event, pwm_value);
+        }
+        else if ((_NODE_ADDRESS != 0) && act_on_this_msg(address))
+        {
+            // Only the newest feedback is sent, timed from this msg.
+            _FeedbackEvent = event;
+            _FeedbackValue = pwm_value;
+            start_after_frame(timer_class::E_TIMER_CHANNEL_FEEDBACK, _FeedbackSlotMs);
+        }
+    }
+
+    void encode_feedback(E_InputEvent const &event, uint16_t const &pwm_value)
     {
         event_element_class _temp;
 
-        // If msg address is ZERO and _NODE_ADDRESS is ONE
-        // OR IF msg address is NOT ZERO and msg address == _NODE_ADDRESS 
-        // THEN send a deedback msg
-        if (((address == 0) && (_NODE_ADDRESS == 1)) || 
-            ((address != 0) && (address == _NODE_ADDRESS)))
+        // Assemble the msg.  Values are 16 bit (see set_data16())
+        _temp.set(E_RGB_NODE,event);
+        _temp.set_data16(pwm_value);
+        // Send via comm (straight to the controller in XBEE_API_MODE)
+        _Comm.encode(_temp, comm_class::CONTROLLER_ADDRESS);
+    }
+
+    // The current state as its feedback event (E_LED_RED_PWM ...)
+    E_InputEvent state_id()
+    {
+        if (state == (STATE)&rgb_node_state_machine::STATE_ADJ_MODE_RED) return E_LED_RED_PWM;
+        if (state == (STATE)&rgb_node_state_machine::STATE_ADJ_MODE_GREEN) return E_LED_GREEN_PWM;
+        if (state == (STATE)&rgb_node_state_machine::STATE_ADJ_MODE_BLUE) return E_LED_BLUE_PWM;
+        if (state == (STATE)&rgb_node_state_machine::STATE_ADJ_MODE_HUE) return E_LED_HUE_PWM;
+        if (state == (STATE)&rgb_node_state_machine::STATE_ADJ_MODE_SATURATION) return E_LED_SATURATION_PWM;
+        return E_LED_INTENSITY_PWM;
+    }
+
+    // Current color and state as sent in a STATUS msg
+    void current_status(uint16_t *rgb)
+    {
+        rgb[0] = _RGB_Led.getRed16();
+        rgb[1] = _RGB_Led.getGreen16();
+        rgb[2] = _RGB_Led.getBlue16();
+    }
+
+    // Has the state changed, or a color moved more than
+    //  STATUS_HYSTERESIS, since the last STATUS msg?
+    bool status_changed()
+    {
+        if (state_id() != _StatusState) return true;
+
+        uint16_t rgb[3];
+        current_status(rgb);
+        for (uint8_t jj=0; jj<3; jj++)
         {
-            // Assemble the msg
-            _temp.set(E_RGB_NODE,event,pwm_value);
-            // Send via comm
-            _Comm.encode(_temp);
+            uint16_t diff = (rgb[jj] > _StatusRgb[jj]) ? (rgb[jj] - _StatusRgb[jj])
+                                                       : (_StatusRgb[jj] - rgb[jj]);
+            if (diff > STATUS_HYSTERESIS) return true;
         }
+        return false;
+    }
+
+    void mark_status_sent()
+    {
+        _StatusState = state_id();
+        current_status(_StatusRgb);
+        _StatusSentMs = timer_class::getInstance()->Millis();
+        _StatusForce = false;
+    }
+
+    void encode_status()
+    {
+        uint8_t report[node_report_class::STATUS_PAYLOAD_LENGTH];
+
+        mark_status_sent();
+        node_report_class::status(report, _Comm, _StatusState, _StatusRgb,
+                                  _event_queue->HighWaterMark(), _StatusSentMs / 1000);
+        _Comm.encode_status(report);
+    }
+
+    void encode_stats(uint8_t const &page)
+    {
+        uint8_t report[node_report_class::STATS_PAYLOAD_LENGTH];
+
+        node_report_class::stats(report, _Comm, page);
+        _Comm.encode_stats(report);
+    }
+
+    // Use this address (ZERO for none).  The comm class picks this
+    //  node's slot out of universe msgs.
+    void set_node_address(uint8_t const &address)
+    {
+        _NODE_ADDRESS = address;
+        _Comm.setNodeAddress(address);
+        _FeedbackSlotMs = comm_class::reply_slot_ms(address, comm_class::FEEDBACK_MSG_LENGTH);
+        _StatusSlotMs = comm_class::reply_slot_ms(address, comm_class::STATUS_MSG_LENGTH);
+        _StatsSlotMs = comm_class::reply_slot_ms(address, comm_class::STATS_MSG_LENGTH);
+        _NackSlotMs = comm_class::reply_slot_ms(address, comm_class::NACK_MSG_LENGTH);
+    }
+
+    // Start a one shot channel delay_ms after the end of the frame the
+    //  current event came in (see E_UART_RX_FRAME_END), not after the
+    //  time it took to get out of the event queue.
+    void start_after_frame(timer_class::E_TimerChannel const &channel, uint16_t const &delay_ms)
+    {
+        uint32_t elapsed = timer_class::getInstance()->Millis() - _FrameEndMs;
+        uint16_t remaining = (elapsed < delay_ms) ? (delay_ms - elapsed) : 1;
+        timer_class::getInstance()->Start(channel, remaining, false);
+    }
+
+    // Nodes powered up together only differ in their RC oscillators,
+    //  so stir the timers into the random numbers.
+    void stir_random()
+    {
+        _Comm.getIdentity().stirRandom(timer_class::getInstance()->Millis() ^
+                                       ((uint32_t)TCNT2 << 16) ^ ((uint32_t)TCNT0 << 24));
+    }
+
+    // STATS page asked for by an E_STATS_REQUEST (optional payload byte)
+    uint8_t stats_page(event_element_class const &A)
+    {
+        if (A.get_payload_length() < 1) return node_report_class::STATS_PAGE_LINK;
+        return A.get_payload()[0];
     }
 
     void Blink(uint8_t const &address)
@@ -1059,12 +1563,9 @@ _Comm.encode(A);
     {
         // IF this msg address is ZERO 
         // OR IF msg address equals the NODE ADDRESS
+        // OR IF msg address is a group this node is in
         // THEN process it.
-        if ((address == 0) || (address == _NODE_ADDRESS))
-        {
-            return true;
-        }
-        return false;
+        return _Comm.isAddressed(address);
     }
 
     // Comm Class
@@ -1076,11 +1577,16 @@ _Comm.encode(A);
     // Node address is the address read from the DIP switches
     uint8_t _NODE_ADDRESS;
 
-    // Adjust value is the amount to adjust the LED value
-    uint8_t RGB_adjust_value;
-    static const uint8_t RGB_LARGE_ADJUST_VALUE = 10;
-    static const uint8_t RGB_SMALL_ADJUST_VALUE = 1;
-    int16_t RGB_color_adjust_temp;
+    // The DIP switches set the address (not zero) ... the controller
+    //  can't assign one.
+    bool _DipAddress;
+
+    // Adjust value is the amount to adjust the 16 bit LED value.
+    //  The steps are the old 8 bit steps scaled by 257.
+    uint16_t RGB_adjust_value;
+    static const uint16_t RGB_LARGE_ADJUST_VALUE = 10 * 257U;
+    static const uint16_t RGB_SMALL_ADJUST_VALUE = 1 * 257U;
+    int32_t RGB_color_adjust_temp;
 
     double HSL_adjust_value;
     static constexpr double HSL_LARGE_ADJUST_VALUE = 0.04;
@@ -1089,6 +1595,51 @@ _Comm.encode(A);
 
     EventQueue *_event_queue;
 
+    // Feedback waiting for this node's time slot
+    E_InputEvent _FeedbackEvent;
+    uint16_t _FeedbackValue;
+
+    // Last STATUS msg sent (see push_status())
+    uint8_t _StatusState;
+    uint16_t _StatusRgb[3];
+    bool _StatusForce;
+    uint32_t _StatusSentMs;
+
+    // STATS page waiting for this node's time slot
+    uint8_t _StatsPage;
+
+    // Millis() at the end of the frame the current events came in
+    uint32_t _FrameEndMs;
+
+    // Color fades are stepped every FADE_STEP_MS
+    static const uint16_t FADE_STEP_MS = 20;
+
+    // Width of each discovery time slot.  Unassigned nodes answer a
+    //  DISCOVER msg in a random one of its slots.
+    static const uint16_t ANNOUNCE_SLOT_MS = 10;
+
+    // Start of this node's feedback time slot after a broadcast (or
+    //  group) msg, see comm_class::reply_slot_ms().  Worked out once
+    //  per address.  STATUS, STATS and NACK replies differ in length,
+    //  so they have their own slots.
+    uint16_t _FeedbackSlotMs;
+    uint16_t _StatusSlotMs;
+    uint16_t _StatsSlotMs;
+    uint16_t _NackSlotMs;
+
+    // A color must move more than this (of 0xFFFF) to push a STATUS
+    //  msg, fades and encoder turns push at most once per
+    //  STATUS_MIN_INTERVAL_MS.
+    static const uint16_t STATUS_HYSTERESIS = 0x0400;
+    static const uint16_t STATUS_MIN_INTERVAL_MS = 1000;
+
+#if (COMM_CLASS_RELAY == 2)
+    // A relay repeats a msg 1 to RELAY_JITTER_SLOTS slots after it,
+    //  a slot is a little longer than the largest frame at 38400 baud.
+    static const uint16_t RELAY_SLOT_MS = 20;
+    static const uint8_t RELAY_JITTER_SLOTS = 8;
+#endif
+
 };
 
 
@@ -30,6 +30,9 @@
      When         Who                Description of change
     -----------  ----------         ------------------------
     2014 Oct 30 James Stokebrand   Initial creation.
+    2026 Oct 18  James Stokebrand   Full check and high water mark inside
+                                      the atomic block (the main loop
+                                      enqueues too).
 
 *****************************************************/
 
@@ -47,34 +50,37 @@
 
 bool STATIC_QUEUE_EVENT_LISTING::cqueue::Enqueue(event_element_class const &A)
 {
-    if(((rear==STATIC_QUEUE_DEFAULT_SIZE-1)&&(front==0)) || 
-        (front==rear+1))
-    {
-        return false;
-    }
+    bool queued = false;
 
+    // ISRs and the main loop (comm_class::receive()) both enqueue, so
+    //  the full check has to be in the same atomic block as the insert.
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        if(rear==-1)
+        if(!(((rear==STATIC_QUEUE_DEFAULT_SIZE-1)&&(front==0)) ||
+             (front==rear+1)))
         {
-            rear++;
-            front++;
+            if(rear==-1)
+            {
+                rear++;
+                front++;
+            }
+            else if(rear==STATIC_QUEUE_DEFAULT_SIZE-1)
+            {
+                rear=0;
+            }
+            else
+            {
+                rear++;
+            }
+
+            data[rear] = A;
+            count++;
+
+            if (count > HighWaterValue) HighWaterValue = count;
+            queued = true;
         }
-        else if(rear==STATIC_QUEUE_DEFAULT_SIZE-1)
-        {
-            rear=0;
-        }
-        else
-        {
-            rear++;
-        }
-
-        data[rear] = A;
-        count++;
     }
 
-    if (count > HighWaterValue) HighWaterValue = count;
-
-    return true;
+    return queued;
 }
 
 bool STATIC_QUEUE_EVENT_LISTING::cqueue::Dequeue(event_element_class &A)
@@ -88,6 +94,9 @@ bool STATIC_QUEUE_EVENT_LISTING::cqueue::Dequeue(event_element_class &A)
         A = data[front];
         count--;
 
+        // Release this slot's reference to the payload (if any)
+        data[front].clear();
+
         if(front==rear)
         {
             front=-1;rear=-1;
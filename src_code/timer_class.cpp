@@ -0,0 +1,251 @@
+
+/****************************************************
+    Timer Class
+
+    File:   timer_class.cpp
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    timer_class.cpp file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file implements a 1 ms system tick on Timer0 with a few
+     software timers.  An expired timer posts
+     E_TIMER_01/E_TIMER_EXPIRE (data is the timer channel) to the
+     attached observer (the event queue).
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+    2026 Oct 18  James Stokebrand   The 1 ms tick only runs while a channel
+                                      does.
+
+*****************************************************/
+
+#include <util/atomic.h>
+
+#ifndef _TIMER_CLASS_H_
+#include "timer_class.h"
+#endif
+
+#ifndef _MCU_SLEEP_CLASS_H_
+#include "mcu_sleep_class.h"
+#endif
+
+// Timer0 in CTC mode, ck/64 prescaler, one compare match every 1 ms
+#define TICK_FREQ 1000UL
+#define TICK_OCR ((F_CPU/(64UL*TICK_FREQ)) - 1)
+
+#if (TICK_OCR > 255)
+    #error "F_CPU is too fast for the Timer0 1 ms tick"
+#endif
+
+// Microseconds per Timer0 count during the 1 ms tick (ck/64)
+#define TICK_COUNT_US (64UL*1000000UL/F_CPU)
+
+// With no channel running Timer0 counts freely at ck/1024 and only
+//  the overflow interrupt (32.768 ms at 8 MHz) is taken, so an idle
+//  node is not woken up every millisecond.
+#define IDLE_COUNT_US (1024UL*1000000UL/F_CPU)
+#define IDLE_OVERFLOW_US (256UL*IDLE_COUNT_US)
+
+#if ((64UL*1000000UL) % F_CPU) || ((1024UL*1000000UL) % F_CPU)
+    #error "F_CPU must give whole microseconds per Timer0 count"
+#endif
+#if (IDLE_OVERFLOW_US + 1000UL > 0xFFFFUL) || (TICK_OCR * TICK_COUNT_US >= 1000UL)
+    #error "F_CPU is too slow for the Timer0 idle overflow"
+#endif
+
+timer_class* timer_class::m_pInstance = nullptr;
+
+timer_class* timer_class::getInstance()
+{
+    return m_pInstance ? m_pInstance : (m_pInstance = new timer_class);
+}
+
+timer_class::timer_class()
+: _Millis(0)
+, _IdleMicros(0)
+, _Ticking(true)
+{
+    for (uint8_t jj=0; jj<E_TIMER_LAST_CHANNEL; jj++)
+    {
+        _Channels[jj]._Remaining = 0;
+        _Channels[jj]._Period = 0;
+    }
+
+    // Power up Timer0
+    mcu_sleep_class::getInstance()->SetInterfaceUsage(
+            mcu_sleep_class::E_TIMER_ZERO_INTERFACE,
+            mcu_sleep_class::E_POWER_INTERFACE_DISABLE_POWER_SAVINGS);
+
+    // No channel running yet
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        tick_stop();
+    }
+}
+
+void timer_class::tick_start()
+{
+    if (_Ticking) return;
+
+    // Keep the time since the last overflow
+    uint32_t us = idle_micros();
+    _Millis += us / 1000;
+    _IdleMicros = us % 1000;
+
+    TIMSK0 &= ~(1 << TOIE0);
+    TCCR0B = 0;                             /* stop timer */
+    TCCR0A = (1 << WGM01);                  /* CTC mode */
+    OCR0A = TICK_OCR;                       /* 1 ms */
+    TCNT0 = 0;
+    TIFR0 = (1 << OCF0A) | (1 << TOV0);
+    TCCR0B = (1 << CS01) | (1 << CS00);     /* start timer (ck/64 prescalar) */
+    TIMSK0 |= (1 << OCIE0A);
+
+    _Ticking = true;
+}
+
+void timer_class::tick_stop()
+{
+    if (!_Ticking) return;
+
+    TIMSK0 &= ~(1 << OCIE0A);
+    TCCR0B = 0;                             /* stop timer */
+
+    // Keep the part of the current millisecond (plus what was left
+    //  over at tick_start())
+    _IdleMicros += TCNT0 * TICK_COUNT_US;
+    if (_IdleMicros >= 1000)
+    {
+        _Millis++;
+        _IdleMicros -= 1000;
+    }
+
+    TCCR0A = 0;                             /* normal mode */
+    TCNT0 = 0;
+    TIFR0 = (1 << OCF0A) | (1 << TOV0);
+    TCCR0B = (1 << CS02) | (1 << CS00);     /* start timer (ck/1024 prescalar) */
+    TIMSK0 |= (1 << TOIE0);
+
+    _Ticking = false;
+}
+
+bool timer_class::any_running()
+{
+    for (uint8_t jj=0; jj<E_TIMER_LAST_CHANNEL; jj++)
+    {
+        if (_Channels[jj]._Remaining != 0) return true;
+    }
+    return false;
+}
+
+uint32_t timer_class::idle_micros()
+{
+    uint8_t count = TCNT0;
+    uint32_t us = _IdleMicros + count * IDLE_COUNT_US;
+
+    // Overflowed but the interrupt is not handled yet?  (Interrupts
+    //  are off.)  A small count was read after the overflow.
+    if ((TIFR0 & (1 << TOV0)) && (count < 0x80)) us += IDLE_OVERFLOW_US;
+    return us;
+}
+
+void timer_class::Start(E_TimerChannel const &channel, uint16_t const &period_ms, bool const &periodic)
+{
+    if (channel >= E_TIMER_LAST_CHANNEL) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // A zero period would never expire ... make it the shortest.
+        _Channels[channel]._Remaining = period_ms ? period_ms : 1;
+        _Channels[channel]._Period = periodic ? _Channels[channel]._Remaining : 0;
+        tick_start();
+    }
+}
+
+void timer_class::Stop(E_TimerChannel const &channel)
+{
+    if (channel >= E_TIMER_LAST_CHANNEL) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _Channels[channel]._Remaining = 0;
+        if (!any_running()) tick_stop();
+    }
+}
+
+bool timer_class::isRunning(E_TimerChannel const &channel)
+{
+    bool running = false;
+    if (channel >= E_TIMER_LAST_CHANNEL) return running;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        running = (_Channels[channel]._Remaining != 0);
+    }
+    return running;
+}
+
+uint32_t timer_class::Millis()
+{
+    uint32_t ms;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms = _Millis;
+        if (!_Ticking) ms += idle_micros() / 1000;
+    }
+    return ms;
+}
+
+void timer_class::Tick()
+{
+    _Millis++;
+
+    for (uint8_t jj=0; jj<E_TIMER_LAST_CHANNEL; jj++)
+    {
+        if (_Channels[jj]._Remaining == 0) continue;
+
+        if (--_Channels[jj]._Remaining == 0)
+        {
+            // Reload a periodic timer
+            _Channels[jj]._Remaining = _Channels[jj]._Period;
+
+            // Notify listener of this event.
+            event_element_class A(E_TIMER_01,E_TIMER_EXPIRE,jj);
+            Notify(A);
+        }
+    }
+
+    // Last one shot expired ... no need to wake up every millisecond.
+    if (!any_running()) tick_stop();
+}
+
+void timer_class::Overflow()
+{
+    uint16_t us = _IdleMicros + IDLE_OVERFLOW_US;
+    _Millis += us / 1000;
+    _IdleMicros = us % 1000;
+}
+
+ISR(TIMER0_COMPA_vect)
+{
+    timer_class::getInstance()->Tick();
+}
+
+ISR(TIMER0_OVF_vect)
+{
+    timer_class::getInstance()->Overflow();
+}
@@ -0,0 +1,135 @@
+#ifndef _TIMER_CLASS_H_
+#define _TIMER_CLASS_H_
+
+/****************************************************
+    Timer Class
+
+    File:   timer_class.h
+    Author: James Stokebrand
+    jamesstokebrand AT gmail DOT com
+
+    timer_class.h file is part of the RGB LED Controller and Node
+     version 1 hardware project.
+
+    This file implements a 1 ms system tick on Timer0 with a few
+     software timers.  An expired timer posts
+     E_TIMER_01/E_TIMER_EXPIRE (data is the timer channel) to the
+     attached observer (the event queue).
+
+    Copyright (C) 2026 - James Stokebrand - 2026 Oct 18
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Rev History:
+     When         Who                Description of change
+    -----------  ----------         ------------------------
+    2026 Oct 18  James Stokebrand   Initial creation.
+    2026 Oct 18  James Stokebrand   Transfer NACK channel.
+    2026 Oct 18  James Stokebrand   Discovery announce channel.
+    2026 Oct 18  James Stokebrand   Feedback time slot channel.
+    2026 Oct 18  James Stokebrand   Status push channel.
+    2026 Oct 18  James Stokebrand   Link statistics channel.
+    2026 Oct 18  James Stokebrand   Relay delay channel.
+    2026 Oct 18  James Stokebrand   The 1 ms tick only runs while a channel
+                                      does, Millis() is kept by a slow
+                                      Timer0 overflow in between.
+
+*****************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#ifndef _EVENT_LISTING_H_
+#include "event_listing.h"
+#endif
+
+#ifndef _OBSERVER_CLASS_H_
+#include "observer_class.h"
+#endif
+
+class timer_class
+: public EventSubject
+{
+public:
+    // Software timer channels.  The channel is the data byte of
+    //  the E_TIMER_EXPIRE event.
+    typedef enum {
+         E_TIMER_CHANNEL_FADE = 0   // RGB LED color fade steps
+        ,E_TIMER_CHANNEL_NACK       // Transfer NACK time slot
+        ,E_TIMER_CHANNEL_ANNOUNCE   // Discovery ANNOUNCE time slot
+        ,E_TIMER_CHANNEL_FEEDBACK   // Feedback time slot
+        ,E_TIMER_CHANNEL_STATUS     // Status msg time slot (and rate limit)
+        ,E_TIMER_CHANNEL_STATS      // Link statistics msg time slot
+        ,E_TIMER_CHANNEL_RELAY      // Random delay before repeating a msg
+
+        // Must remain the last enum
+        ,E_TIMER_LAST_CHANNEL
+    } E_TimerChannel;
+
+    static timer_class* getInstance();
+
+    // Start (or restart) a channel.  E_TIMER_EXPIRE is posted after
+    //  period_ms and then every period_ms if periodic.
+    void Start(E_TimerChannel const &channel, uint16_t const &period_ms, bool const &periodic);
+    void Stop(E_TimerChannel const &channel);
+    bool isRunning(E_TimerChannel const &channel);
+
+    // Milliseconds since the timer was started (wraps after ~49 days)
+    uint32_t Millis();
+
+    // Called from the Timer0 compare match ISR (1 ms tick)
+    void Tick();
+
+    // Called from the Timer0 overflow ISR (no channel running)
+    void Overflow();
+
+private:
+    // Constructor is private for singleton
+    timer_class();
+
+    // Copy constructor is private for singleton
+    timer_class(timer_class const&);
+
+    // Reference to itself
+    static timer_class* m_pInstance;
+
+    // Destructor is private for singletons
+    virtual ~timer_class() {}
+
+    // Equal operator is private for singletons
+    void operator=(timer_class const&);
+
+    struct timer_channel_struct {
+        uint16_t _Remaining;  // zero when stopped
+        uint16_t _Period;     // zero for a one shot timer
+    };
+
+    // Switch Timer0 between the 1 ms tick (some channel running) and
+    //  the slow overflow that only keeps Millis().  Called with
+    //  interrupts off.
+    void tick_start();
+    void tick_stop();
+    bool any_running();
+
+    // Microseconds since the last overflow (or tick stop) that are
+    //  not in _Millis yet.  Only while the tick is stopped.
+    uint32_t idle_micros();
+
+    volatile timer_channel_struct _Channels[E_TIMER_LAST_CHANNEL];
+    volatile uint32_t _Millis;
+    volatile uint16_t _IdleMicros;  // Part of a ms not in _Millis yet
+    volatile bool _Ticking;
+};
+
+#endif
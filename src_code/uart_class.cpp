@@ -121,6 +121,23 @@ Date        Description
                                       into a class.  The only
                                       advantage this gives is
                                       automatic initialization.
+    2026 Oct 18  James Stokebrand   Added the RX ISR frame assembler.
+    2026 Oct 18  James Stokebrand   Only flag bytes are notified, the comm
+                                      class decodes in place in the RX ring.
+    2026 Oct 18  James Stokebrand   RX ISR frame assembler runs the frame CRC.
+    2026 Oct 18  James Stokebrand   RX ISR frame assembler for XBee API frames.
+    2026 Oct 18  James Stokebrand   Automatic U2X and baud error check.
+    2026 Oct 18  James Stokebrand   RX byte time stamps (OSCCAL_CALIBRATION).
+    2026 Oct 18  James Stokebrand   putc() drops on a full TX ring, added
+                                      reserve()/write() and TX drained
+                                      notifications.
+    2026 Oct 18  James Stokebrand   Multi-processor mode (UART_MPCM).
+    2026 Oct 18  James Stokebrand   RX overrun (DOR) counter.
+    2026 Oct 18  James Stokebrand   Framing, overflow, escape and resync
+                                      counters.
+    2026 Oct 18  James Stokebrand   Frame assembler double buffers frames
+                                      for decoding in the main loop.
+    2026 Oct 18  James Stokebrand   Frames are time stamped at their end.
 
 *****************************************************/
 
@@ -129,12 +146,52 @@ Date        Description
 #endif
 
 // Set to 1 to have this class generate these events
-#define NOTIFY_OF_TX_COMPLETE_EVENTS 0
-#define NOTIFY_OF_RX_EVENTS 1
+//  TX complete is only notified once per notifyWhenTxDrained() call.
+#define NOTIFY_OF_TX_COMPLETE_EVENTS 1
+#if UART_RX_DEFRAMER
+// The RX ISR frame assembler only notifies of complete frames
+//  (E_UART_RX_FRAME_EVENT).
+#define NOTIFY_OF_RX_EVENTS 0
+#define NOTIFY_OF_FLAG_BYTE_EVENTS 0
+#else
+// Frames are decoded in place in the RX ring once the closing
+//  flag byte is received (E_UART_FLAG_BYTE_FOUND_EVENT).
+#define NOTIFY_OF_RX_EVENTS 0
 #define NOTIFY_OF_FLAG_BYTE_EVENTS 1
+#endif
 
 UartBaseClass* UartBaseClass::pUart = 0;
 
+#if UART_RX_DEFRAMER
+/*
+    RX ISR frame assembler.  Each entry holds the next state and the
+    actions for the current state and the class of the received byte.
+
+                   FLAG byte            ESCAPE char        Any other byte
+    HUNT     DATA + reset         HUNT               HUNT
+    DATA     DATA + end + reset   ESCAPE             DATA + store
+    ESCAPE   DATA + reset         HUNT               DATA + thin + store
+
+    A FLAG byte after an ESCAPE char aborts the frame but also starts
+    the next one.  Two ESCAPE chars in a row are not valid, hunt for
+    the next FLAG byte.
+*/
+const uint8_t UartBaseClass::DEFRAME_TABLE[UartBaseClass::E_DEFRAME_LAST_STATE][3] = {
+    // E_DEFRAME_HUNT
+    { E_DEFRAME_DATA   | DEFRAME_ACTION_RESET
+    , E_DEFRAME_HUNT   | DEFRAME_ACTION_RESYNC
+    , E_DEFRAME_HUNT   | DEFRAME_ACTION_RESYNC }
+    // E_DEFRAME_DATA
+   ,{ E_DEFRAME_DATA   | DEFRAME_ACTION_END | DEFRAME_ACTION_RESET
+    , E_DEFRAME_ESCAPE
+    , E_DEFRAME_DATA   | DEFRAME_ACTION_STORE }
+    // E_DEFRAME_ESCAPE
+   ,{ E_DEFRAME_DATA   | DEFRAME_ACTION_RESET | DEFRAME_ACTION_BAD_ESCAPE
+    , E_DEFRAME_HUNT   | DEFRAME_ACTION_BAD_ESCAPE
+    , E_DEFRAME_DATA   | DEFRAME_ACTION_STORE | DEFRAME_ACTION_THIN }
+};
+#endif
+
 UartBaseClass::UartBaseClass(E_InputHardware A)
 : event_element_class(A,E_LAST_INPUT_EVENT)
 {
@@ -146,30 +203,107 @@ UartBaseClass::UartBaseClass(E_InputHardware A)
         mcu_sleep_class::E_POWER_INTERFACE_DISABLE_POWER_SAVINGS);
 
     // Init the UART.
-    //  BAUD and F_CPU are defined in the Makefile
-    init(UART_BAUD_SELECT(BAUD,F_CPU));
+    //  BAUD and F_CPU are defined in the Makefile, UART_BAUD_VALUE
+    //  picks normal or double speed.
+    init(UART_BAUD_VALUE);
 }
 
-void UartBaseClass::init(uint8_t baudrate)
+void UartBaseClass::init(uint16_t baudrate)
 {
     UART_TxHead = 0;
     UART_TxTail = 0;
     UART_RxHead = 0;
     UART_RxTail = 0;
+    UART_TxDropCount = 0;
+    UART_RxOverrunCount = 0;
+    UART_RxFramingErrorCount = 0;
+    UART_RxOverflowCount = 0;
+    UART_RxEscapeErrorCount = 0;
+    UART_RxResyncCount = 0;
+    UART_TxDrainedRequest = false;
+
+#if UART_MPCM
+    for (uint8_t jj=0; jj<sizeof(UART_TxAddressMap); jj++) UART_TxAddressMap[jj] = 0;
+    UART_MpcmAddress = 0;
+#endif
+
+#if OSCCAL_CALIBRATION
+    UART_RxBurstStart = 0;
+    UART_RxLastStamp = 0;
+    UART_RxBurstBytes = 0;
+#endif
+
+#if UART_RX_DEFRAMER
+    UART_RxFill = 0;
+    UART_RxFrameLen = 0;
+    UART_RxFrameCrc = crc_class::INIT;
+    UART_RxFrameState = E_DEFRAME_HUNT;
+    UART_RxReadyLen = 0;
+    UART_RxReadyCrc = crc_class::INIT;
+    UART_RxReadyEndMs = 0;
+#if OSCCAL_CALIBRATION
+    UART_RxReadyBurstTicks = 0;
+    UART_RxReadyBurstBytes = 0;
+#endif
+#if XBEE_API_MODE
+    UART_RxFrameExpected = 0;
+    UART_RxFrameChecksum = 0;
+    UART_RxFrameEscape = false;
+#endif
+#if COMM_CLASS_COBS
+    UART_RxCobsRemaining = 0;
+    UART_RxCobsZero = false;
+#endif
+#else
+    UART_RxFlagMs = 0;
+#endif
+
+    setBaudRate(baudrate);
+
+#if UART_MPCM
+    /* Enable USART receiver and transmitter and receive complete interrupt, 9 data bits */
+    UART0_CONTROL = (1<<RXCIE0)|(1<<RXEN0)|(1<<TXEN0)|(1<<UCSZ02);
+
+    /* Ignore data characters until an address character for this node */
+    UART0_STATUS |= (1<<MPCM0);
+#else
+    /* Enable USART receiver and transmitter and receive complete interrupt */
+    UART0_CONTROL = (1<<RXCIE0)|(1<<RXEN0)|(1<<TXEN0);
+#endif
+
+    /* Set frame format: asynchronous, 8data, no parity, 1stop bit */
+    UCSR0C = (3<<UCSZ00);
+}
+
+void UartBaseClass::setBaudRate(uint16_t baudrate)
+{
+#if UART_MPCM
+    // Keep the multi-processor mode bit
+    uint8_t mpcm = UART0_STATUS & (1<<MPCM0);
+#else
+    uint8_t mpcm = 0;
+#endif
 
     /* Set baud rate */
     if ( baudrate & 0x8000 ) {
-        UART0_STATUS = (1<<U2X0);  //Enable 2x speed
+        UART0_STATUS = (1<<U2X0) | mpcm;  //Enable 2x speed
         baudrate &= ~0x8000;
+    } else {
+        UART0_STATUS = mpcm;
     }
     UBRR0H = (uint8_t)(baudrate>>8);
     UBRR0L = (uint8_t) baudrate;
+}
 
-    /* Enable USART receiver and transmitter and receive complete interrupt */
-    UART0_CONTROL = (1<<RXCIE0)|(1<<RXEN0)|(1<<TXEN0);
-
-    /* Set frame format: asynchronous, 8data, no parity, 1stop bit */
-    UCSR0C = (3<<UCSZ00);
+void UartBaseClass::putc_blocking(uint8_t const data)
+{
+    /* wait for the data register, then for the byte to be shifted out */
+    while (!(UART0_STATUS & (1<<UDRE0)))
+        ;
+    UART0_STATUS |= (1<<TXC0);
+    UART0_DATA = data;
+    while (!(UART0_STATUS & (1<<TXC0)))
+        ;
 }
 
 bool UartBaseClass::isEmpty()
@@ -230,25 +364,82 @@ bool UartBaseClass::peek(uint8_t &error, uint8_t &data)
 }
 #endif
 
-void UartBaseClass::putc(uint8_t const data)
+bool UartBaseClass::putc(uint8_t const data)
 {
-    uint16_t tmphead;
+    uint8_t tmphead;
 
     tmphead  = (UART_TxHead + 1) & UART_TX0_BUFFER_MASK;
 
     if ( tmphead == UART_TxTail ) {
-        // Enable UDRE and Force a TX interrupt
-        UART0_CONTROL |= (1<<UART0_UDRIE);
+        // No room ... drop the byte rather than overwrite unsent data.
+        //  The TX ISR is already running (the ring is not empty).
+        if (UART_TxDropCount < 0xFFFF) UART_TxDropCount++;
+        return false;
+    }
+
+    UART_TxBuf[tmphead] = data;
+#if UART_MPCM
+    UART_TxAddressMap[tmphead >> 3] &= ~(1 << (tmphead & 0x07));
+#endif
+    UART_TxHead = tmphead;
 
-        ;/* wait for free space in buffer */
+    /* enable UDRE interrupt */
+    UART0_CONTROL |= (1<<UART0_UDRIE);
+
+    return true;
+}
+
+#if UART_MPCM
+bool UartBaseClass::putc_address(uint8_t const data)
+{
+    uint8_t tmphead;
+
+    tmphead  = (UART_TxHead + 1) & UART_TX0_BUFFER_MASK;
+
+    if ( tmphead == UART_TxTail ) {
+        if (UART_TxDropCount < 0xFFFF) UART_TxDropCount++;
+        return false;
     }
 
+    // Mark it before the TX ISR can see it
     UART_TxBuf[tmphead] = data;
+    UART_TxAddressMap[tmphead >> 3] |= (1 << (tmphead & 0x07));
     UART_TxHead = tmphead;
 
     /* enable UDRE interrupt */
     UART0_CONTROL |= (1<<UART0_UDRIE);
 
+    return true;
+}
+#endif
+
+bool UartBaseClass::write(uint8_t const *data, uint8_t const &length)
+{
+    if (!reserve(length)) return false;
+
+    uint8_t tmphead = UART_TxHead;
+    for (uint8_t jj=0; jj<length; jj++)
+    {
+        tmphead = (tmphead + 1) & UART_TX0_BUFFER_MASK;
+        UART_TxBuf[tmphead] = data[jj];
+#if UART_MPCM
+        UART_TxAddressMap[tmphead >> 3] &= ~(1 << (tmphead & 0x07));
+#endif
+    }
+    UART_TxHead = tmphead;
+
+    /* enable UDRE interrupt */
+    UART0_CONTROL |= (1<<UART0_UDRIE);
+
+    return true;
+}
+
+void UartBaseClass::notifyWhenTxDrained()
+{
+    UART_TxDrainedRequest = true;
+
+    // Let the TX ISR see an empty ring and notify.
+    UART0_CONTROL |= (1<<UART0_UDRIE);
 }
 
 #if 0
@@ -274,6 +465,98 @@ void UartBaseClass::puts_p(const char *progmem_s)
 
 void UartBaseClass::receive()
 {
+#if OSCCAL_CALIBRATION
+    // Time stamp this byte.  A gap of more than a byte and a half
+    //  starts a new burst.
+    uint16_t stamp = osccal_class::Stamp();
+    if ((uint16_t)(stamp - UART_RxLastStamp) > (osccal_class::TICKS_PER_BYTE + osccal_class::TICKS_PER_BYTE/2))
+    {
+        UART_RxBurstStart = stamp;
+        UART_RxBurstBytes = 0;
+    }
+    else if (UART_RxBurstBytes < 0xFF)
+    {
+        UART_RxBurstBytes++;
+    }
+    UART_RxLastStamp = stamp;
+#endif
+
+#if UART_RX_DEFRAMER
+    uint8_t data;
+    uint8_t usr;
+
+    /* read UART status register and UART data register */
+    usr  = UART0_STATUS;
+#if UART_MPCM
+    /* 9th bit must be read before the data */
+    uint8_t ninth = UART0_CONTROL & (1<<RXB80);
+#endif
+    data = UART0_DATA;
+
+#if UART_MPCM
+    if (ninth)
+    {
+        receive_address(data);
+        return;
+    }
+#endif
+
+    if (usr & (1<<DOR0))
+    {
+        if (UART_RxOverrunCount < 0xFFFF) UART_RxOverrunCount++;
+    }
+    if (usr & (1<<FE0)) count_rx_error(UART_RxFramingErrorCount);
+
+    if (usr & ((1<<FE0)|(1<<DOR0)))
+    {
+        // Framing error or a lost byte ... this frame is bad.
+        UART_LastRxError = (usr & ((1<<FE0)|(1<<DOR0)) );
+        UART_RxFrameState = E_DEFRAME_HUNT;
+        return;
+    }
+
+#if XBEE_API_MODE
+    receive_xbee(data);
+#elif COMM_CLASS_COBS
+    receive_cobs(data);
+#else
+    uint8_t byte_class = DEFRAME_CLASS_OTHER;
+    if (data == COMM_CLASS_FLAG_BYTE) byte_class = DEFRAME_CLASS_FLAG;
+    else if (data == COMM_CLASS_ESCAPE_CHAR_START) byte_class = DEFRAME_CLASS_ESCAPE;
+
+    uint8_t entry = DEFRAME_TABLE[UART_RxFrameState][byte_class];
+    UART_RxFrameState = entry & DEFRAME_STATE_MASK;
+
+    if (entry & DEFRAME_ACTION_RESYNC) count_rx_error(UART_RxResyncCount);
+    if (entry & DEFRAME_ACTION_BAD_ESCAPE) count_rx_error(UART_RxEscapeErrorCount);
+
+    if (entry & DEFRAME_ACTION_STORE)
+    {
+        if (UART_RxFrameLen >= UART_RX_FRAME_SIZE)
+        {
+            // Frame is too large ... drop it and hunt for the next FLAG byte.
+            count_rx_error(UART_RxOverflowCount);
+            UART_RxFrameState = E_DEFRAME_HUNT;
+            return;
+        }
+        if (entry & DEFRAME_ACTION_THIN) data ^= COMM_CLASS_BYTE_STUFF_XOR_VALUE;
+        UART_RxFrame[UART_RxFill][UART_RxFrameLen++] = data;
+        UART_RxFrameCrc = crc_class::update(UART_RxFrameCrc, data);
+    }
+
+    if ((entry & DEFRAME_ACTION_END) && (UART_RxFrameLen > 0))
+    {
+        // Complete frame.  Hand it over to the main loop.
+        frame_ready();
+    }
+
+    if (entry & DEFRAME_ACTION_RESET)
+    {
+        UART_RxFrameLen = 0;
+        UART_RxFrameCrc = crc_class::INIT;
+    }
+#endif
+#else
     uint16_t tmphead;
     uint8_t data;
     uint8_t usr;
@@ -281,10 +564,24 @@ void UartBaseClass::receive()
 
     /* read UART status register and UART data register */
     usr  = UART0_STATUS;
+#if UART_MPCM
+    /* 9th bit must be read before the data */
+    uint8_t ninth = UART0_CONTROL & (1<<RXB80);
+#endif
     data = UART0_DATA;
 
+#if UART_MPCM
+    if (ninth)
+    {
+        receive_address(data);
+        return;
+    }
+#endif
+
     /* */
     lastRxError = (usr & ((1<<FE0)|(1<<DOR0)) );
+    if ((usr & (1<<DOR0)) && (UART_RxOverrunCount < 0xFFFF)) UART_RxOverrunCount++;
+    if (usr & (1<<FE0)) count_rx_error(UART_RxFramingErrorCount);
 
     /* calculate buffer index */
     tmphead = ( UART_RxHead + 1) & UART_RX0_BUFFER_MASK;
@@ -292,6 +589,7 @@ void UartBaseClass::receive()
     if ( tmphead == UART_RxTail ) {
         /* error: receive buffer overflow */
         lastRxError = UART_BUFFER_OVERFLOW >> 8;
+        count_rx_error(UART_RxOverflowCount);
     } else {
         /* store new index */
         UART_RxHead = tmphead;
@@ -304,6 +602,8 @@ void UartBaseClass::receive()
     // Notify listener of this event.
     if (data == COMM_CLASS_FLAG_BYTE)
     {
+        UART_RxFlagMs = timer_class::getInstance()->Millis();
+
         event_element_class A;
         A.set(get_current_hardware(),E_InputEvent::E_UART_FLAG_BYTE_FOUND_EVENT);
         Notify(A);
@@ -315,8 +615,193 @@ void UartBaseClass::receive()
     A.set(get_current_hardware(),E_InputEvent::E_UART_RX_EVENT);
     Notify(A);
 #endif
+#endif
 }
 
+#if UART_MPCM
+void UartBaseClass::receive_address(uint8_t const &address)
+{
+    if ((address == UART_MpcmAddress) || (address == MPCM_BROADCAST))
+    {
+        // Frame for this node ... take the data characters that follow.
+        UART0_STATUS &= ~(1<<MPCM0);
+#if UART_RX_DEFRAMER
+        UART_RxFrameState = E_DEFRAME_HUNT;
+#endif
+    }
+    else
+    {
+        // Some other node's frame ... sleep through it.
+        UART0_STATUS |= (1<<MPCM0);
+    }
+}
+#endif
+
+#if UART_RX_DEFRAMER
+void UartBaseClass::frame_ready()
+{
+    if (UART_RxReadyLen == 0)
+    {
+        // Hand this buffer over and collect the next frame in the other.
+        UART_RxReadyLen = UART_RxFrameLen;
+        UART_RxReadyCrc = UART_RxFrameCrc;
+        UART_RxReadyEndMs = timer_class::getInstance()->Millis();
+#if OSCCAL_CALIBRATION
+        UART_RxReadyBurstTicks = UART_RxLastStamp - UART_RxBurstStart;
+        UART_RxReadyBurstBytes = UART_RxBurstBytes;
+#endif
+        UART_RxFill ^= 1;
+    }
+    else
+    {
+        // The main loop still holds the last frame ... drop this one.
+        count_rx_error(UART_RxOverflowCount);
+    }
+
+    // Notify the listener either way.  If the notification for the held
+    //  frame was lost (full event queue) this one gets it decoded.
+    event_element_class A(get_current_hardware(),E_InputEvent::E_UART_RX_FRAME_EVENT);
+    Notify(A);
+}
+#endif
+
+#if COMM_CLASS_COBS
+void UartBaseClass::receive_cobs(uint8_t data)
+{
+    if (data == COMM_CLASS_COBS_DELIMITER)
+    {
+        // End of frame.  Complete if the last block is complete (its
+        //  trailing zero is the delimiter).
+        if ((UART_RxFrameState == E_DEFRAME_DATA) &&
+            (UART_RxCobsRemaining == 0) &&
+            (UART_RxFrameLen > 0))
+        {
+            // Complete frame.  Hand it over to the main loop.
+            frame_ready();
+        }
+        else if ((UART_RxFrameState == E_DEFRAME_DATA) &&
+                 (UART_RxCobsRemaining != 0))
+        {
+            // Block cut short by the delimiter
+            count_rx_error(UART_RxEscapeErrorCount);
+        }
+
+        // Start a new frame
+        UART_RxFrameState = E_DEFRAME_DATA;
+        UART_RxFrameLen = 0;
+        UART_RxFrameCrc = crc_class::INIT;
+        UART_RxCobsRemaining = 0;
+        UART_RxCobsZero = false;
+        return;
+    }
+
+    if (UART_RxFrameState == E_DEFRAME_HUNT)
+    {
+        count_rx_error(UART_RxResyncCount);
+        return;
+    }
+
+    if (UART_RxCobsRemaining == 0)
+    {
+        // Code byte.  code - 1 data bytes follow.  The zero ending the
+        //  last block (if any) is stored in its place.
+        bool zero = UART_RxCobsZero;
+        UART_RxCobsRemaining = data - 1;
+        UART_RxCobsZero = (data != COMM_CLASS_COBS_MAX_CODE);
+
+        if (!zero) return;
+        data = 0;
+    }
+    else
+    {
+        UART_RxCobsRemaining--;
+    }
+
+    if (UART_RxFrameLen >= UART_RX_FRAME_SIZE)
+    {
+        // Frame is too large ... drop it and hunt for the next delimiter.
+        count_rx_error(UART_RxOverflowCount);
+        UART_RxFrameState = E_DEFRAME_HUNT;
+        return;
+    }
+    UART_RxFrame[UART_RxFill][UART_RxFrameLen++] = data;
+    UART_RxFrameCrc = crc_class::update(UART_RxFrameCrc, data);
+}
+#endif
+
+#if XBEE_API_MODE
+void UartBaseClass::receive_xbee(uint8_t data)
+{
+    // The start delimiter is always escaped inside a frame.
+    if (data == COMM_CLASS_FLAG_BYTE)
+    {
+        UART_RxFrameState = E_XBEE_LENGTH_MSB;
+        UART_RxFrameLen = 0;
+        UART_RxFrameChecksum = 0;
+        UART_RxFrameEscape = false;
+        return;
+    }
+
+    if (UART_RxFrameState == E_XBEE_HUNT)
+    {
+        count_rx_error(UART_RxResyncCount);
+        return;
+    }
+
+    if (data == COMM_CLASS_ESCAPE_CHAR_START)
+    {
+        // Escape char found ... next byte should be byte thinned.
+        UART_RxFrameEscape = true;
+        return;
+    }
+
+    if (UART_RxFrameEscape)
+    {
+        data ^= COMM_CLASS_BYTE_STUFF_XOR_VALUE;
+        UART_RxFrameEscape = false;
+    }
+
+    switch (UART_RxFrameState)
+    {
+    case E_XBEE_LENGTH_MSB:
+        // Frames longer than the frame buffer are dropped
+        UART_RxFrameState = data ? E_XBEE_HUNT : E_XBEE_LENGTH_LSB;
+        if (data) count_rx_error(UART_RxOverflowCount);
+    break;
+    case E_XBEE_LENGTH_LSB:
+        UART_RxFrameExpected = data;
+        if ((data == 0) || (data > UART_RX_FRAME_SIZE))
+        {
+            if (data) count_rx_error(UART_RxOverflowCount);
+            UART_RxFrameState = E_XBEE_HUNT;
+        }
+        else
+        {
+            UART_RxFrameState = E_XBEE_DATA;
+        }
+    break;
+    case E_XBEE_DATA:
+        UART_RxFrame[UART_RxFill][UART_RxFrameLen++] = data;
+        UART_RxFrameChecksum += data;
+        if (UART_RxFrameLen == UART_RxFrameExpected) UART_RxFrameState = E_XBEE_CHECKSUM;
+    break;
+    case E_XBEE_CHECKSUM:
+        UART_RxFrameState = E_XBEE_HUNT;
+
+        // Frame data plus checksum adds up to 0xFF
+        if ((uint8_t)(UART_RxFrameChecksum + data) == 0xFF)
+        {
+            // Complete frame.  Hand it over to the main loop.
+            frame_ready();
+        }
+    break;
+    default:
+        UART_RxFrameState = E_XBEE_HUNT;
+    break;
+    }
+}
+#endif
+
 void UartBaseClass::transmit()
 {
     uint16_t tmptail;
@@ -325,6 +810,13 @@ void UartBaseClass::transmit()
         /* calculate and store new buffer index */
         tmptail = (UART_TxTail + 1) & UART_TX0_BUFFER_MASK;
         UART_TxTail = tmptail;
+#if UART_MPCM
+        /* 9th bit first, it is latched with the data */
+        if (UART_TxAddressMap[tmptail >> 3] & (1 << (tmptail & 0x07)))
+            UART0_CONTROL |= (1<<TXB80);
+        else
+            UART0_CONTROL &= ~(1<<TXB80);
+#endif
         /* get one byte from buffer and write it to UART */
         UART0_DATA = UART_TxBuf[tmptail];  /* start transmission */
     } else {
@@ -332,9 +824,13 @@ void UartBaseClass::transmit()
         UART0_CONTROL &= ~(1<<UART0_UDRIE);
 
 #if NOTIFY_OF_TX_COMPLETE_EVENTS
-        // Notify listener of this event.
-        event_element_class A(get_current_hardware(),E_InputEvent::E_UART_TX_COMPLETE);
-        Notify(A);
+        // Notify listener of this event (if asked for).
+        if (UART_TxDrainedRequest)
+        {
+            UART_TxDrainedRequest = false;
+            event_element_class A(get_current_hardware(),E_InputEvent::E_UART_TX_COMPLETE);
+            Notify(A);
+        }
 #endif
     }
 }
@@ -125,6 +125,22 @@ Date        Description
                                       into a class.  The only
                                       advantage this gives is
                                       automatic initialization.
+    2026 Oct 18  James Stokebrand   Added the RX ISR frame assembler.
+    2026 Oct 18  James Stokebrand   Added in place access to the RX ring.
+    2026 Oct 18  James Stokebrand   RX ISR frame assembler runs the frame CRC.
+    2026 Oct 18  James Stokebrand   RX ISR frame assembler for XBee API frames.
+    2026 Oct 18  James Stokebrand   RX ISR frame assembler for COBS frames.
+    2026 Oct 18  James Stokebrand   Automatic U2X and baud error check.
+    2026 Oct 18  James Stokebrand   RX byte time stamps (OSCCAL_CALIBRATION).
+    2026 Oct 18  James Stokebrand   putc() drops on a full TX ring, added
+                                      reserve()/write() and TX drained
+                                      notifications.
+    2026 Oct 18  James Stokebrand   Multi-processor mode (UART_MPCM).
+    2026 Oct 18  James Stokebrand   RX overrun (DOR) counter.
+    2026 Oct 18  James Stokebrand   Frame assembler double buffers frames
+                                      for decoding in the main loop.
+    2026 Oct 18  James Stokebrand   Frame end time stamps (Millis()).
+    2026 Oct 18  James Stokebrand   Relay header holds a 16 bit sequence.
 
 *****************************************************/
 
@@ -144,6 +160,18 @@ Date        Description
 #include "mcu_sleep_class.h"
 #endif
 
+#ifndef _CRC_CLASS_H_
+#include "crc_class.h"
+#endif
+
+#ifndef _OSCCAL_CLASS_H_
+#include "osccal_class.h"
+#endif
+
+#ifndef _TIMER_CLASS_H_
+#include "timer_class.h"
+#endif
+
 #define UART_RX0_BUFFER_MASK ( UART_RX0_BUFFER_SIZE - 1)
 #define UART_TX0_BUFFER_MASK ( UART_TX0_BUFFER_SIZE - 1)
 
@@ -165,6 +193,103 @@ Date        Description
     #error "Buffer too large, maximum allowed is 65536 bytes"
 #endif
 
+/*
+** Set UART_RX_DEFRAMER to 1 to de-frame (and byte thin) comm class
+** frames inside the RX ISR.  Only complete frames are passed on
+** to the comm class.  Set to 0 to pass every byte through the RX
+** ring buffer, the comm class then decodes frames in place in the ring.
+*/
+#ifndef UART_RX_DEFRAMER
+    #define UART_RX_DEFRAMER 1
+#endif
+
+/*
+** Set XBEE_API_MODE to 1 when the XBee radio runs in escaped API mode
+** (ATAP 2) instead of transparent mode.  Comm class msgs are then sent
+** in TX requests and received in RX packets, so the radio does the
+** address filtering and link layer ACKs.  Needs UART_RX_DEFRAMER.
+*/
+#ifndef XBEE_API_MODE
+    #define XBEE_API_MODE 0
+#endif
+
+#if XBEE_API_MODE && !UART_RX_DEFRAMER
+    #error "XBEE_API_MODE needs UART_RX_DEFRAMER"
+#endif
+
+/*
+** Set COMM_CLASS_COBS to 1 to frame comm class msgs with Consistent
+** Overhead Byte Stuffing instead of 0x7E/0x7D byte stuffing.  Frames
+** are delimited by 0x00 and grow by one byte (per 254) whatever the
+** data.  Needs UART_RX_DEFRAMER, not with XBEE_API_MODE.
+*/
+#ifndef COMM_CLASS_COBS
+    #define COMM_CLASS_COBS 0
+#endif
+
+#if COMM_CLASS_COBS && (!UART_RX_DEFRAMER || XBEE_API_MODE)
+    #error "COMM_CLASS_COBS needs UART_RX_DEFRAMER and not XBEE_API_MODE"
+#endif
+
+/*
+** Set UART_MPCM to 1 on a wired multidrop bus (RS-485) to use the
+** USART's multi-processor communication mode.  Characters are 9 bits,
+** each frame starts with an address character (9th bit set) that
+** holds the 8 bit node address (MPCM_BROADCAST for every node).  The
+** receiver ignores data characters until an address character for
+** this node arrives, so frames for other nodes cost no RX interrupts.
+** The radio only carries 8 bit characters, so not with XBEE_API_MODE.
+*/
+#ifndef UART_MPCM
+    #define UART_MPCM 0
+#endif
+
+#if UART_MPCM && XBEE_API_MODE
+    #error "UART_MPCM is for a wired bus, not with XBEE_API_MODE"
+#endif
+
+#if OSCCAL_CALIBRATION && !UART_RX_DEFRAMER
+    #error "OSCCAL_CALIBRATION needs UART_RX_DEFRAMER (it keeps the burst of each frame)"
+#endif
+
+#if UART_MPCM && OSCCAL_CALIBRATION
+    #error "OSCCAL_CALIBRATION times 10 bit characters, not with UART_MPCM"
+#endif
+
+/*
+** Set COMM_CLASS_RELAY to 1 (on the controller and every node) when
+** some nodes are out of the controller's radio range.  Every comm
+** class msg then starts with a relay header (source, sequence number
+** and hops left) and copies already seen are dropped.  Set it to 2 on
+** the nodes that also repeat msgs for their neighbours.  A wired bus
+** needs no relays, so not with UART_MPCM.
+*/
+#ifndef COMM_CLASS_RELAY
+    #define COMM_CLASS_RELAY 0
+#endif
+
+#if COMM_CLASS_RELAY && UART_MPCM
+    #error "COMM_CLASS_RELAY is for radio links, not with UART_MPCM"
+#endif
+
+// Bytes the relay header adds to every comm class msg
+#if COMM_CLASS_RELAY
+    #define COMM_CLASS_RELAY_HEADER 5
+#else
+    #define COMM_CLASS_RELAY_HEADER 0
+#endif
+
+// Largest frame (after byte thinning) the RX ISR frame assembler will hold.
+//  Must hold a comm class realtime msg (checked in comm_class.cpp).
+#ifndef UART_RX_FRAME_SIZE
+    #if XBEE_API_MODE
+        // Plus the largest RX packet header
+        #define UART_RX_FRAME_SIZE (62 + COMM_CLASS_RELAY_HEADER)
+    #else
+        #define UART_RX_FRAME_SIZE (51 + COMM_CLASS_RELAY_HEADER)
+    #endif
+#endif
+
 /** @brief  UART Baudrate Expression
  *  @param  xtalCpu  system clock in Mhz, e.g. 4000000L for 4Mhz          
  *  @param  baudRate baudrate in bps, e.g. 1200, 2400, 9600     
@@ -177,6 +302,39 @@ Date        Description
  */
 #define UART_BAUD_SELECT_DOUBLE_SPEED(baudRate,xtalCpu) ((((xtalCpu)+4UL*(baudRate))/(8UL*(baudRate))-1)|0x8000)
 
+/** @brief  Baud rate error (in 0.1%) of a UBRR value
+ *  @param  ubrr     UBRR value (without the double speed flag)
+ *  @param  divisor  16 for normal speed, 8 for double speed
+ */
+#define UART_BAUD_ACTUAL(ubrr,divisor,xtalCpu) ((xtalCpu)/((divisor)*((ubrr)+1UL)))
+#define UART_BAUD_ERROR(ubrr,divisor,baudRate,xtalCpu) \
+    (((UART_BAUD_ACTUAL(ubrr,divisor,xtalCpu) > (baudRate)) \
+        ? (UART_BAUD_ACTUAL(ubrr,divisor,xtalCpu) - (baudRate)) \
+        : ((baudRate) - UART_BAUD_ACTUAL(ubrr,divisor,xtalCpu))) * 1000UL / (baudRate))
+
+/*
+** BAUD and F_CPU are defined in the Makefile.  Double speed (U2X) is
+** used when it gets closer to BAUD.  The receiver tolerates about 2%
+** so anything worse is refused here rather than dropping bytes.
+**  F_CPU = 8000000:  38400, 76800, 250000 are fine.  115200 is not (3.5%).
+*/
+#define UART_BAUD_ERROR_NORMAL \
+    UART_BAUD_ERROR(UART_BAUD_SELECT(BAUD,F_CPU),16UL,BAUD,F_CPU)
+#define UART_BAUD_ERROR_DOUBLE \
+    UART_BAUD_ERROR((UART_BAUD_SELECT_DOUBLE_SPEED(BAUD,F_CPU) & 0x7FFFUL),8UL,BAUD,F_CPU)
+
+#if (UART_BAUD_ERROR_DOUBLE < UART_BAUD_ERROR_NORMAL)
+    #define UART_BAUD_VALUE UART_BAUD_SELECT_DOUBLE_SPEED(BAUD,F_CPU)
+    #if (UART_BAUD_ERROR_DOUBLE > 20)
+        #error "BAUD is more than 2% off at this F_CPU"
+    #endif
+#else
+    #define UART_BAUD_VALUE UART_BAUD_SELECT(BAUD,F_CPU)
+    #if (UART_BAUD_ERROR_NORMAL > 20)
+        #error "BAUD is more than 2% off at this F_CPU"
+    #endif
+#endif
+
 #if ( (UART_RX0_BUFFER_SIZE+UART_TX0_BUFFER_SIZE) >= (RAMEND-0x60 ) )
 #error "size of UART_RX0_BUFFER_SIZE + UART_TX0_BUFFER_SIZE larger than size of SRAM"
 #endif
@@ -210,7 +368,70 @@ public:
     void flush();
 
     bool getc(uint8_t &error, uint8_t &data);
-    void putc(uint8_t const data);
+
+    // Queue a byte for the TX ISR.  Never waits, if the TX ring is full
+    //  the byte is dropped (counted by getTxDropCount()) and false is
+    //  returned.  Use reserve() first to send a frame as a whole.
+    bool putc(uint8_t const data);
+
+    // Free bytes in the TX ring.  Only the main loop adds to the ring,
+    //  the TX ISR only frees space, so once reserve(count) returns true
+    //  the next count putc() calls will not drop.
+    uint8_t txFree() { return (UART_TxTail - UART_TxHead - 1) & UART_TX0_BUFFER_MASK; }
+    bool reserve(uint8_t const &count) { return (txFree() >= count); }
+
+    // Queue all of data or none of it.  Returns false (and queues
+    //  nothing) if the TX ring can not hold length bytes.
+    bool write(uint8_t const *data, uint8_t const &length);
+
+    // Have the TX ISR notify E_UART_TX_COMPLETE once, the next time the
+    //  TX ring runs empty (straight away if it is already empty).
+    void notifyWhenTxDrained();
+
+    // Bytes dropped by putc() because the TX ring was full
+    uint16_t getTxDropCount() { return UART_TxDropCount; }
+
+    // Bytes lost because the RX ISR was late (data overrun, DOR0)
+    uint16_t getRxOverrunCount() { return UART_RxOverrunCount; }
+
+    // Link statistics counted in the RX ISR (saturate at 0xFFFF)
+    //  Framing  - Bytes with a framing error (FE0)
+    //  Overflow - Bytes dropped on a full RX ring (or frame buffer)
+    //  Escape   - Frames with a bad escape sequence (COBS: a block
+    //              cut short by the delimiter)
+    //  Resync   - Bytes dropped while hunting for the start of a frame
+    //  Escape and Resync are only counted by the RX ISR frame assembler,
+    //   see comm_class for the in place decode.
+    uint16_t getRxFramingErrorCount() { return UART_RxFramingErrorCount; }
+    uint16_t getRxOverflowCount() { return UART_RxOverflowCount; }
+    uint16_t getRxEscapeErrorCount() { return UART_RxEscapeErrorCount; }
+    uint16_t getRxResyncCount() { return UART_RxResyncCount; }
+
+#if UART_MPCM
+    // Queue an address character (9th bit set), same as putc().
+    bool putc_address(uint8_t const data);
+
+    // Address characters this receiver wakes up for (besides
+    //  MPCM_BROADCAST).
+    void setMpcmAddress(uint8_t const &address) { UART_MpcmAddress = address; }
+#endif
+
+#if OSCCAL_CALIBRATION
+    // Current burst of back to back RXed bytes (see osccal_class).
+    //  Timer1 ticks from the first to the last byte, and the number
+    //  of byte times in between.
+    uint16_t getBurstTicks() { return UART_RxLastStamp - UART_RxBurstStart; }
+    uint8_t getBurstBytes() { return UART_RxBurstBytes; }
+#endif
+
+    // Change the baud rate.  baudrate is a UART_BAUD_SELECT() or
+    //  UART_BAUD_SELECT_DOUBLE_SPEED() value.
+    void setBaudRate(uint16_t baudrate);
+
+    // Send data straight to the UART (bypassing the TX buffer) and
+    //  wait until it is on the wire.  For use before interrupts are
+    //  enabled.
+    void putc_blocking(uint8_t const data);
 
 #if 0
     // Not using these ... commented out for space
@@ -223,6 +444,59 @@ public:
     void receive();
     void transmit();
 
+#if UART_RX_DEFRAMER
+    // Frame collected by the RX ISR frame assembler.  The RX ISR hands
+    //  a complete frame over (E_UART_RX_FRAME_EVENT) and collects the
+    //  next one in the other buffer, so the frame stays valid until
+    //  releaseFrame().  getFrameLength() is 0 while no frame is held.
+    uint8_t const *getFrame() { return UART_RxFrame[UART_RxFill ^ 1]; }
+    uint8_t getFrameLength() { return UART_RxReadyLen; }
+    // CRC of every byte in the frame (zero if the CRC trailer matches)
+    crc_class::crc_t getFrameCrc() { return UART_RxReadyCrc; }
+    void releaseFrame() { UART_RxReadyLen = 0; }
+    // Low 16 bits of timer_class::Millis() when the held frame's last
+    //  byte came in.  Reply time slots are timed from it.
+    uint16_t getFrameEndMs() { return UART_RxReadyEndMs; }
+#if OSCCAL_CALIBRATION
+    // Burst (see getBurstTicks()) the held frame ended.
+    uint16_t getFrameBurstTicks() { return UART_RxReadyBurstTicks; }
+    uint8_t getFrameBurstBytes() { return UART_RxReadyBurstBytes; }
+#endif
+#else
+    /*
+        In place access to the RX ring.  Offset 0 is the oldest unread
+        byte.  The bytes between the tail and the head belong to the
+        reader (the RX ISR only writes past the head) so the reader may
+        rewrite them in place before consuming them.
+    */
+    static const uint8_t RX_RING_MASK = UART_RX0_BUFFER_MASK;
+
+    uint8_t rxIndex(uint8_t const &offset)
+    {
+        return (UART_RxTail + 1 + offset) & RX_RING_MASK;
+    }
+    uint8_t rxPeek(uint8_t const &offset)
+    {
+        return UART_RxBuf[rxIndex(offset)];
+    }
+    void rxPoke(uint8_t const &offset, uint8_t const &data)
+    {
+        UART_RxBuf[rxIndex(offset)] = data;
+    }
+    void rxConsume(uint8_t const &count)
+    {
+        UART_RxTail = (UART_RxTail + count) & RX_RING_MASK;
+    }
+    uint8_t const *getRxRing()
+    {
+        // Safe to drop the volatile, see above.
+        return (uint8_t const *)UART_RxBuf;
+    }
+    // Low 16 bits of timer_class::Millis() when the last flag byte
+    //  came in (the end of the newest frame in the ring).
+    uint16_t getFrameEndMs() { return UART_RxFlagMs; }
+#endif
+
     static UartBaseClass* pUart;
 
     // 0x7E is a flag byte for Start/Stop of a frame.
@@ -233,8 +507,26 @@ public:
     static const uint8_t COMM_CLASS_ESCAPE_CHAR_START = 0x7D;
     static const uint8_t COMM_CLASS_BYTE_STUFF_XOR_VALUE = 0x20;
 
+#if COMM_CLASS_COBS
+    // COBS frames are delimited by 0x00.  A COBS code byte of 0xFF is
+    //  a block of 254 data bytes without a trailing zero.
+    static const uint8_t COMM_CLASS_COBS_DELIMITER = 0x00;
+    static const uint8_t COMM_CLASS_COBS_MAX_CODE = 0xFF;
+#endif
+
+#if UART_MPCM
+    // Address character for every node
+    static const uint8_t MPCM_BROADCAST = 0xFF;
+#endif
+
+#if XBEE_API_MODE
+    //  XBee API mode also escapes the XON/XOFF chars
+    static const uint8_t XBEE_XON_CHAR = 0x11;
+    static const uint8_t XBEE_XOFF_CHAR = 0x13;
+#endif
+
 private:
-    void init(uint8_t baudrate);
+    void init(uint16_t baudrate);
 
     volatile uint8_t UART_TxBuf[UART_TX0_BUFFER_SIZE];
     volatile uint8_t UART_RxBuf[UART_RX0_BUFFER_SIZE];
@@ -244,6 +536,122 @@ private:
     volatile uint8_t UART_RxHead;
     volatile uint8_t UART_RxTail;
     volatile uint8_t UART_LastRxError;
+#if !UART_RX_DEFRAMER
+    volatile uint16_t UART_RxFlagMs;
+#endif
+
+    // Only written from the RX ISR
+    volatile uint16_t UART_RxOverrunCount;
+    volatile uint16_t UART_RxFramingErrorCount;
+    volatile uint16_t UART_RxOverflowCount;
+    volatile uint16_t UART_RxEscapeErrorCount;
+    volatile uint16_t UART_RxResyncCount;
+
+    // Saturating counter, only called from the RX ISR
+    static void count_rx_error(volatile uint16_t &counter)
+    {
+        if (counter < 0xFFFF) counter++;
+    }
+
+    // Only written from the main loop
+    uint16_t UART_TxDropCount;
+    // Set by notifyWhenTxDrained(), cleared by the TX ISR
+    volatile bool UART_TxDrainedRequest;
+
+#if UART_MPCM
+    // Called from receive() for an address character.
+    void receive_address(uint8_t const &address);
+
+    // One bit per TX ring entry, set for address characters
+    volatile uint8_t UART_TxAddressMap[(UART_TX0_BUFFER_SIZE + 7) / 8];
+    uint8_t UART_MpcmAddress;
+#endif
+
+#if OSCCAL_CALIBRATION
+    // Only accessed from the RX ISR
+    uint16_t UART_RxBurstStart;
+    uint16_t UART_RxLastStamp;
+    uint8_t  UART_RxBurstBytes;
+#endif
+
+#if UART_RX_DEFRAMER
+    // Frame assembler state and actions.  These are packed into
+    //  the DEFRAME_TABLE entries.
+    typedef enum {
+         E_DEFRAME_HUNT = 0   // Looking for a flag byte
+        ,E_DEFRAME_DATA       // Collecting the frame
+        ,E_DEFRAME_ESCAPE     // Escape char found, thin the next byte
+
+        ,E_DEFRAME_LAST_STATE
+    } E_DeframeState;
+
+    static const uint8_t DEFRAME_STATE_MASK = 0x03;
+    static const uint8_t DEFRAME_ACTION_BAD_ESCAPE = 0x04; // Count an escape error
+    static const uint8_t DEFRAME_ACTION_RESYNC = 0x08; // Count a dropped byte
+    static const uint8_t DEFRAME_ACTION_STORE = 0x10; // Store the byte
+    static const uint8_t DEFRAME_ACTION_THIN  = 0x20; // XOR the byte before storing
+    static const uint8_t DEFRAME_ACTION_END   = 0x40; // End of frame (if not empty)
+    static const uint8_t DEFRAME_ACTION_RESET = 0x80; // Start a new frame
+
+    // Byte classes (column of the DEFRAME_TABLE)
+    static const uint8_t DEFRAME_CLASS_FLAG = 0;
+    static const uint8_t DEFRAME_CLASS_ESCAPE = 1;
+    static const uint8_t DEFRAME_CLASS_OTHER = 2;
+
+    static const uint8_t DEFRAME_TABLE[E_DEFRAME_LAST_STATE][3];
+
+#if XBEE_API_MODE
+    // XBee API frame assembler states.  API frames are length
+    //  delimited:  0x7E, Length (2 bytes), Frame data, Checksum
+    typedef enum {
+         E_XBEE_HUNT = 0      // Looking for the start delimiter
+        ,E_XBEE_LENGTH_MSB
+        ,E_XBEE_LENGTH_LSB
+        ,E_XBEE_DATA          // Collecting the frame data
+        ,E_XBEE_CHECKSUM
+    } E_XBeeDeframeState;
+
+    // Called from receive() in XBee API mode
+    void receive_xbee(uint8_t data);
+
+    uint8_t UART_RxFrameExpected;
+    uint8_t UART_RxFrameChecksum;
+    bool    UART_RxFrameEscape;
+#endif
+
+#if COMM_CLASS_COBS
+    // Called from receive() with COBS framing
+    void receive_cobs(uint8_t data);
+
+    // Data bytes left in the current COBS block, and whether a zero
+    //  follows the block.
+    uint8_t UART_RxCobsRemaining;
+    bool    UART_RxCobsZero;
+#endif
+
+    // Called from the RX ISR with a complete frame
+    void frame_ready();
+
+    // Two frame buffers.  The RX ISR collects into UART_RxFrame[UART_RxFill]
+    //  while the main loop decodes the other one.
+    uint8_t UART_RxFrame[2][UART_RX_FRAME_SIZE];
+    volatile uint8_t UART_RxFill;
+
+    // Only accessed from the RX ISR
+    uint8_t UART_RxFrameLen;
+    crc_class::crc_t UART_RxFrameCrc;
+    uint8_t UART_RxFrameState;
+
+    // Frame handed over to the main loop.  Written by the RX ISR only
+    //  while UART_RxReadyLen is 0, cleared by releaseFrame().
+    volatile uint8_t UART_RxReadyLen;
+    crc_class::crc_t UART_RxReadyCrc;
+    uint16_t UART_RxReadyEndMs;
+#if OSCCAL_CALIBRATION
+    uint16_t UART_RxReadyBurstTicks;
+    uint8_t  UART_RxReadyBurstBytes;
+#endif
+#endif
 
 };
 